@@ -45,11 +45,14 @@ public:
 
     [[gnu::hot]] void registerEventType(EventStratege stratege, const QString &space, const QString &topic);
     [[gnu::hot]] EventType eventType(const QString &space, const QString &topic);
+    [[gnu::hot]] EventType eventType(EventTopicId id);
+    void registerActivator(const QString &space, const std::function<void()> &activator);
 
     QStringList pluginTopics(const QString &space);
     QStringList pluginTopics(const QString &space, EventStratege stratege);
 
 private:
+    EventType activate(const QString &space, const QString &topic);
     Event();
     ~Event() = default;
 
@@ -58,6 +58,14 @@ public:
         return asyncSend(ret);
     }
 
+    template<class... Args>
+    inline QVariant sendTyped(const Args &... args)
+    {
+        if (typedConn.accepts<Args...>())
+            return typedConn.invoke(args...);
+        return send(QVariantList { QVariant::fromValue(args)... });
+    }
+
     template<class T, class Func>
     inline void setReceiver(T *obj, Func method)
     {
@@ -69,10 +77,12 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args);
         };
+        typedConn = TypedEventHelper<decltype(method)>::make(obj, method);
     }
 
 private:
     Connector conn;
+    TypedInvoker typedConn;
     QMutex receiverMutex;
 };
 
@@ -131,6 +141,18 @@ public:
         return QVariant();
     }
 
+    template<class... Args>
+    [[gnu::hot]] inline QVariant push(const SlotHandle<Args...> &handle, const EventArg<Args> &... args)
+    {
+        const EventType type { handle.type() };
+        QReadLocker guard(&rwLock);
+        auto channel = channelMap.value(type);
+        guard.unlock();
+        if (Q_LIKELY(channel))
+            return channel->template sendTyped<Args...>(args...);
+        return QVariant();
+    }
+
     inline QVariant push(const QString &space, const QString &topic)
     {
         Q_ASSERT(topic.startsWith(kSlotStrategePrefix));
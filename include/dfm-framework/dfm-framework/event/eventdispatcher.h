@@ -43,6 +43,33 @@ public:
         return asyncDispatch(ret);
     }
 
+    // the arguments are boxed into QVariant only for the handlers that take other types
+    template<class... Args>
+    inline bool dispatchTyped(const Args &... args)
+    {
+        QVariantList params;
+        bool boxed { false };
+        auto call = [&](const EventHandler<Listener> &h) -> QVariant {
+            if (h.typedHandler.template accepts<Args...>())
+                return h.typedHandler.invoke(args...);
+            if (!boxed) {
+                params = QVariantList { QVariant::fromValue(args)... };
+                boxed = true;
+            }
+            return h.handler(params);
+        };
+
+        for (const auto &filter : filterList) {
+            if (call(filter).toBool())
+                return false;
+        }
+
+        for (const auto &handler : handlerList)
+            call(handler);
+
+        return true;
+    }
+
     template<class T, class Func>
     inline void append(T *obj, Func method)
     {
@@ -54,7 +81,8 @@ public:
             return helper.invoke(args);
         };
 
-        handlerList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+        handlerList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func,
+                                                       TypedEventHelper<decltype(method)>::make(obj, method) });
     }
 
     template<class T, class Func>
@@ -90,7 +118,8 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        filterList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+        filterList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func,
+                                                      TypedEventHelper<decltype(method)>::make(obj, method) });
     }
 
     template<class T, class Func>
@@ -203,6 +232,21 @@ public:
         return false;
     }
 
+    template<class... Args>
+    [[gnu::hot]] inline bool publish(const SignalHandle<Args...> &handle, const EventArg<Args> &... args)
+    {
+        const EventType type { handle.type() };
+        if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList { QVariant::fromValue(args)... }))
+            return false;
+
+        QReadLocker lk(&rwLock);
+        auto dispatcher = dispatcherMap.value(type);
+        lk.unlock();
+        if (Q_LIKELY(dispatcher))
+            return dispatcher->template dispatchTyped<Args...>(args...);
+        return false;
+    }
+
     inline bool publish(const QString &space, const QString &topic)
     {
         Q_ASSERT(topic.startsWith(kSignalStrategePrefix));
@@ -13,6 +13,9 @@
 #include <QUrl>
 
 #include <mutex>
+#include <atomic>
+#include <typeinfo>
+#include <utility>
 
 DPF_BEGIN_NAMESPACE
 
@@ -54,10 +57,34 @@ inline bool isValidEventType(EventType type)
     return type > EventTypeScope::kInValid && type <= EventTypeScope::kCustomTop;
 }
 
+/*
+ * Compile-time id of an event, the FNV-1a hash of "space:topic"
+ */
+using EventTopicId = quint64;
+using EventIdConverterFunc = std::function<EventType(EventTopicId)>;
+
+inline constexpr EventTopicId kEventTopicIdBasis { 14695981039346656037ULL };
+inline constexpr EventTopicId kEventTopicIdPrime { 1099511628211ULL };
+
+constexpr EventTopicId eventTopicIdHash(const char *str, EventTopicId hash = kEventTopicIdBasis)
+{
+    for (; *str; ++str) {
+        hash ^= static_cast<unsigned char>(*str);
+        hash *= kEventTopicIdPrime;
+    }
+    return hash;
+}
+
+constexpr EventTopicId eventTopicId(const char *space, const char *topic)
+{
+    return eventTopicIdHash(topic, eventTopicIdHash(":", eventTopicIdHash(space)));
+}
+
 class EventConverter
 {
 public:
     static inline EventConverterFunc convertFunc {};
+    static inline EventIdConverterFunc idConvertFunc {};
     static void registerConverter(const EventConverterFunc &func)
     {
         static std::once_flag flag;
@@ -65,14 +92,89 @@ public:
             convertFunc = func;
         });
     }
+    static void registerIdConverter(const EventIdConverterFunc &func)
+    {
+        static std::once_flag flag;
+        std::call_once(flag, [&func]() {
+            idConvertFunc = func;
+        });
+    }
     static EventType convert(const QString &space, const QString &topic)
     {
         if (convertFunc)
             return convertFunc(space, topic);
         return EventTypeScope::kInValid;
     }
+    static EventType convert(EventTopicId id)
+    {
+        if (idConvertFunc)
+            return idConvertFunc(id);
+        return EventTypeScope::kInValid;
+    }
 };
 
+/*
+ * Typed handle of an event, coexists with the string api:
+ *     static const SlotHandle<QUrl> kTabClose { "dfmplugin_workspace", "slot_Tab_Close" };
+ *     dpfSlotChannel->push(kTabClose, url);
+ * The id is hashed at compile time and the event type is resolved once, the arguments are
+ * passed to the receivers without QVariant boxing when the receiver takes the same types.
+ */
+template<EventStratege stratege, class... Args>
+class EventHandle
+{
+    Q_DISABLE_COPY(EventHandle)
+
+public:
+    // the space and topic should be string literals, they are kept to activate an unloaded plugin
+    constexpr EventHandle(const char *space, const char *topic)
+        : topicId(eventTopicId(space, topic)), topicSpace(space), topicName(topic)
+    {
+    }
+
+    constexpr EventTopicId id() const
+    {
+        return topicId;
+    }
+
+    inline EventType type() const
+    {
+        EventType cached { resolvedType.load(std::memory_order_relaxed) };
+        if (Q_LIKELY(cached != EventTypeScope::kInValid))
+            return cached;
+
+        // events are never unregistered, the type can be kept once the event is registered
+        cached = EventConverter::convert(topicId);
+        if (!isValidEventType(cached))
+            cached = EventConverter::convert(QString(topicSpace), QString(topicName));
+        if (isValidEventType(cached))
+            resolvedType.store(cached, std::memory_order_relaxed);
+        return cached;
+    }
+
+private:
+    EventTopicId topicId;
+    const char *topicSpace;
+    const char *topicName;
+    mutable std::atomic<EventType> resolvedType { EventTypeScope::kInValid };
+};
+
+template<class... Args>
+using SignalHandle = EventHandle<EventStratege::kSignal, Args...>;
+template<class... Args>
+using SlotHandle = EventHandle<EventStratege::kSlot, Args...>;
+template<class... Args>
+using HookHandle = EventHandle<EventStratege::kHook, Args...>;
+
+// the arguments of a handle are not deduced from the call, so they can be converted like a function call
+template<class T>
+struct EventArgHelper
+{
+    using type = T;
+};
+template<class T>
+using EventArg = typename EventArgHelper<T>::type;
+
 /*
  * Check return value type
  */
@@ -475,6 +577,67 @@ protected:
     Func f;
 };
 
+/*
+ * call a handler with the typed arguments of an EventHandle
+ */
+struct TypedInvoker
+{
+    using Func = std::function<QVariant(void **)>;
+
+    const std::type_info *signature { nullptr };
+    Func func;
+
+    template<class... Args>
+    inline bool accepts() const
+    {
+        return func && *signature == typeid(void(Args...));
+    }
+
+    template<class... Args>
+    inline QVariant invoke(const Args &... args) const
+    {
+        void *argv[] { const_cast<void *>(static_cast<const void *>(&args))..., nullptr };
+        return func(argv);
+    }
+};
+
+template<class Handler>
+struct TypedEventHelper;
+
+template<class Result, class T, class... Args>
+struct TypedEventHelper<Result (T::*)(Args...)>
+{
+    using Func = Result (T::*)(Args...);
+    // the receivers that modify their arguments still get copies from QVariant
+    static constexpr bool kEnabled { ((!std::is_rvalue_reference<Args>::value
+                                       && (!std::is_lvalue_reference<Args>::value
+                                           || std::is_const<typename std::remove_reference<Args>::type>::value))
+                                      && ...) };
+
+    static TypedInvoker make(T *self, Func func)
+    {
+        TypedInvoker invoker;
+        if constexpr (kEnabled) {
+            invoker.signature = &typeid(void(REMOVE_CONST_REF(Args)...));
+            invoker.func = [self, func](void **argv) -> QVariant {
+                return invoke(self, func, argv, std::index_sequence_for<Args...> {});
+            };
+        }
+        return invoker;
+    }
+
+private:
+    template<std::size_t... I>
+    static QVariant invoke(T *self, Func func, void **argv, std::index_sequence<I...>)
+    {
+        Q_UNUSED(argv)
+        QVariant ret = resultGenerator<Result>();
+        if (self)
+            emit(self->*func)(*static_cast<REMOVE_CONST_REF(Args) *>(argv[I])...), ApplyReturnValue<Result>(ret.data());
+        return ret;
+    }
+};
+
 /*
  * cast member function to void *
  */
@@ -612,11 +775,13 @@ struct EventHandler
     // See: https://stackoverflow.com/questions/1307278/casting-between-void-and-a-pointer-to-member-function
     void *funcIndex;
     Method handler;
+    TypedInvoker typedHandler;
 
-    inline EventHandler(QObject *obj, void *func, Method method)
+    inline EventHandler(QObject *obj, void *func, Method method, TypedInvoker typed = {})
         : objectIndex(obj),
           funcIndex(func),
-          handler(method)
+          handler(method),
+          typedHandler(typed)
     {
     }
 
@@ -33,6 +33,29 @@ public:
         return traversal(ret);
     }
 
+    // the arguments are boxed into QVariant only for the handlers that take other types
+    template<class... Args>
+    inline bool traversalTyped(const Args &... args)
+    {
+        QVariantList params;
+        bool boxed { false };
+        for (auto seq : list) {
+            if (seq.typedHandler.template accepts<Args...>()) {
+                if (seq.typedHandler.invoke(args...).toBool())
+                    return true;
+                continue;
+            }
+
+            if (!boxed) {
+                params = QVariantList { QVariant::fromValue(args)... };
+                boxed = true;
+            }
+            if (seq.handler(params))
+                return true;
+        }
+        return false;
+    }
+
     template<class T, class Func>
     inline void append(T *obj, Func method)
     {
@@ -49,7 +72,8 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        list.push_back(EventHandler<Sequence> { obj, memberFunctionVoidCast(method), func });
+        list.push_back(EventHandler<Sequence> { obj, memberFunctionVoidCast(method), func,
+                                                TypedEventHelper<decltype(method)>::make(obj, method) });
     }
 
     template<class T, class Func>
@@ -155,6 +179,18 @@ public:
         return false;
     }
 
+    template<class... Args>
+    inline bool run(const HookHandle<Args...> &handle, const EventArg<Args> &... args)
+    {
+        const EventType type { handle.type() };
+        QReadLocker lk(&rwLock);
+        auto sequence = sequenceMap.value(type);
+        lk.unlock();
+        if (Q_LIKELY(sequence))
+            return sequence->template traversalTyped<Args...>(args...);
+        return false;
+    }
+
     inline bool run(const QString &space, const QString &topic)
     {
         Q_ASSERT(topic.startsWith(kHookStrategePrefix));
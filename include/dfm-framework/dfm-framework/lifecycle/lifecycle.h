@@ -20,6 +20,8 @@ void initialize(const QStringList &IIDs, const QStringList &paths);
 void initialize(const QStringList &IIDs, const QStringList &paths, const QStringList &blackNames);
 void initialize(const QStringList &IIDs, const QStringList &paths, const QStringList &blackNames,
                 const QStringList &lazyNames);
+void initialize(const QStringList &IIDs, const QStringList &paths, const QStringList &blackNames,
+                const QStringList &lazyNames, const QStringList &onDemandNames);
 
 bool isAllPluginsInitialized();
 bool isAllPluginsStarted();
@@ -27,6 +29,7 @@ QStringList pluginIIDs();
 QStringList pluginPaths();
 QStringList blackList();
 QStringList lazyLoadList();
+QStringList onDemandList();
 PluginMetaObjectPointer pluginMetaObj(const QString &pluginName,
                                       const QString version = "");
 
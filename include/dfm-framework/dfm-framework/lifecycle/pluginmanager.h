@@ -33,9 +33,11 @@ public:
     QStringList pluginPaths() const;
     QStringList blackList() const;
     QStringList lazyLoadList() const;
+    QStringList onDemandList() const;
     void addPluginIID(const QString &pluginIIDs);
     void addBlackPluginName(const QString &name);
     void addLazyLoadPluginName(const QString &name);
+    void addOnDemandPluginName(const QString &name);
     void setPluginPaths(const QStringList &pluginPaths);
 
     bool readPlugins();
@@ -7,6 +7,8 @@
 
 #include <dfm-framework/dfm_framework_global.h>
 
+#include <QString>
+
 #ifndef DPF_NO_CHECK_TIME   //make use
 
 #    include <QMessageLogContext>
@@ -20,11 +22,21 @@
 #    define dpfCheckTimeBegin() dpf::CodeCheckTime::begin(CodeCheckLogContext)
 // 检查点End的宏定义，可在任意执行代码块中使用
 #    define dpfCheckTimeEnd() dpf::CodeCheckTime::end(CodeCheckLogContext)
+// 带标签的检查点，只记录到启动时间线，不写入文件
+#    define dpfCheckTimeBeginTag(tag) dpf::CodeCheckTime::begin(CodeCheckLogContext, tag)
+#    define dpfCheckTimeEndTag(tag) dpf::CodeCheckTime::end(CodeCheckLogContext, tag)
+// 获取启动时间线报告，获取后停止记录
+#    define dpfCheckTimeline() dpf::CodeCheckTime::timeline()
 #else   // define DPF_NO_CHECK_TIME
 // 检查点Begin的宏定义，可在任意执行代码块中使用
 #    define dpfCheckTimeBegin()
 // 检查点End的宏定义，可在任意执行代码块中使用
 #    define dpfCheckTimeEnd()
+// 带标签的检查点，只记录到启动时间线，不写入文件
+#    define dpfCheckTimeBeginTag(tag)
+#    define dpfCheckTimeEndTag(tag)
+// 获取启动时间线报告，获取后停止记录
+#    define dpfCheckTimeline() QString()
 #endif   // DPF_NO_CHECK_TIME
 
 DPF_BEGIN_NAMESPACE
@@ -37,6 +49,9 @@ public:
     static uint logCacheDayCount();
     static void begin(const QMessageLogContext &context);
     static void end(const QMessageLogContext &context);
+    static void begin(const QMessageLogContext &context, const QString &tag);
+    static void end(const QMessageLogContext &context, const QString &tag);
+    static QString timeline();
 };
 
 DPF_END_NAMESPACE
@@ -12,6 +12,7 @@
 #include "dfm-base/utils/universalutils.h"
 #include "dfm-base/utils/networkutils.h"
 #include "dfm-base/base/device/deviceproxymanager.h"
+#include "dfm-base/base/device/mounttable.h"
 #include "dfm-base/dbusservice/global_server_defines.h"
 
 #include <QVector>
@@ -43,6 +44,14 @@ QString DeviceUtils::getBlockDeviceId(const QString &deviceDesc)
  */
 QString DeviceUtils::getMountInfo(const QString &in, bool lookForMpt)
 {
+    const MountTable &mountTable = MountTable::instance();
+    if (mountTable.isValid()) {
+        const QString &out = lookForMpt ? mountTable.findMountPoint(in) : mountTable.findSource(in);
+        // libmount also resolves the tags and the canonical paths, the misses are left to it
+        if (!out.isEmpty())
+            return out;
+    }
+
     libmnt_table *tab { mnt_new_table() };
     if (!tab)
         return {};
@@ -0,0 +1,370 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mounttable.h"
+
+#include "dfm-base/dfm_global_defines.h"
+
+#include <QSet>
+#include <QDebug>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+using namespace dfmbase;
+
+namespace {
+constexpr char kMountInfoPath[] { "/proc/self/mountinfo" };
+constexpr char kGvfsFsType[] { "fuse.gvfsd-fuse" };
+
+const QSet<QString> &remoteFsTypes()
+{
+    static const QSet<QString> types { "nfs", "nfs4", "cifs", "smb3", "smbfs", "ncpfs", "afs", "ceph",
+                                       "glusterfs", "9p", "davfs", "fuse.sshfs", "fuse.curlftpfs",
+                                       "fuse.davfs2", "fuse.s3fs", "fuse.rclone" };
+    return types;
+}
+
+const QSet<QString> &lowSpeedSchemes()
+{
+    static const QSet<QString> schemes { Global::Scheme::kMtp, Global::Scheme::kGPhoto, Global::Scheme::kGPhoto2,
+                                         Global::Scheme::kSmb, Global::Scheme::kSmbShare,
+                                         Global::Scheme::kFtp, Global::Scheme::kSFtp };
+    return schemes;
+}
+
+const QSet<QString> &remoteSchemes()
+{
+    static const QSet<QString> schemes { Global::Scheme::kSmb, Global::Scheme::kSmbShare,
+                                         Global::Scheme::kFtp, Global::Scheme::kSFtp,
+                                         "dav", "davs", "nfs", "afp" };
+    return schemes;
+}
+
+// the fields of mountinfo escape the space, the tab, the newline and the backslash in octal
+QString unescape(const QByteArray &field)
+{
+    if (!field.contains('\\'))
+        return QString::fromLocal8Bit(field);
+
+    QByteArray out;
+    out.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field.at(i) == '\\' && i + 3 < field.size() && field.at(i + 1) >= '0' && field.at(i + 1) <= '3') {
+            bool ok = false;
+            const int c = field.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok) {
+                out.append(static_cast<char>(c));
+                i += 3;
+                continue;
+            }
+        }
+        out.append(field.at(i));
+    }
+    return QString::fromLocal8Bit(out);
+}
+}   // namespace
+
+MountTable &MountTable::instance()
+{
+    static MountTable table;
+    return table;
+}
+
+MountTable::MountTable()
+{
+    current = std::make_shared<const Table>();
+
+    mountInfoFd = ::open(kMountInfoPath, O_RDONLY | O_CLOEXEC);
+    if (mountInfoFd < 0) {
+        qWarning() << "open mountinfo failed:" << strerror(errno);
+        return;
+    }
+    reload();
+
+    stopFd = eventfd(0, EFD_CLOEXEC);
+    if (stopFd < 0) {
+        qWarning() << "create eventfd failed, the mount table is not refreshed:" << strerror(errno);
+        return;
+    }
+    watcher = std::thread([this]() { watch(); });
+}
+
+MountTable::~MountTable()
+{
+    if (watcher.joinable()) {
+        const quint64 value { 1 };
+        if (write(stopFd, &value, sizeof(value)) != sizeof(value)) {
+            // the watcher is still polling the fds, leave them to the exit of the process
+            watcher.detach();
+            return;
+        }
+        watcher.join();
+    }
+
+    if (stopFd >= 0)
+        ::close(stopFd);
+    if (mountInfoFd >= 0)
+        ::close(mountInfoFd);
+}
+
+/*!
+ * \brief MountTable::table The table of the current thread, it is replaced only after the mounts changed.
+ */
+MountTable::TablePointer MountTable::table() const
+{
+    thread_local TablePointer cached;
+    thread_local quint64 cachedGeneration { 0 };
+
+    const quint64 gen = generation.load(std::memory_order_acquire);
+    if (!cached || gen != cachedGeneration) {
+        cached = std::atomic_load(&current);
+        cachedGeneration = gen;
+    }
+    return cached;
+}
+
+bool MountTable::isValid() const
+{
+    return table()->count() > 0;
+}
+
+bool MountTable::isLowSpeed(const QString &path) const
+{
+    return table()->classify(path).speed == kLowSpeed;
+}
+
+bool MountTable::isRemote(const QString &path) const
+{
+    return table()->classify(path).isRemote;
+}
+
+/*!
+ * \brief MountTable::isGvfs The path is in a location of a gvfs mount, like /run/user/1000/gvfs/smb-share:server=...
+ */
+bool MountTable::isGvfs(const QString &path) const
+{
+    return !table()->classify(path).gvfsScheme.isEmpty();
+}
+
+QString MountTable::fsType(const QString &path) const
+{
+    const TablePointer &tab = table();
+    const Mount *mount = tab->find(path);
+    return mount ? mount->fsType : QString();
+}
+
+QString MountTable::mountPoint(const QString &path) const
+{
+    const TablePointer &tab = table();
+    const Mount *mount = tab->find(path);
+    return mount ? mount->mountPoint : QString();
+}
+
+QString MountTable::findMountPoint(const QString &source) const
+{
+    const TablePointer &tab = table();
+    const Mount *mount = tab->findBySource(source);
+    return mount ? mount->mountPoint : QString();
+}
+
+QString MountTable::findSource(const QString &mountPoint) const
+{
+    const TablePointer &tab = table();
+    const Mount *mount = tab->findByMountPoint(mountPoint);
+    return mount ? mount->source : QString();
+}
+
+/*!
+ * \brief MountTable::watch The kernel raises POLLPRI on mountinfo after the mounts changed,
+ * the event is cleared by reading the file again.
+ */
+void MountTable::watch()
+{
+    pollfd fds[2] { { mountInfoFd, POLLPRI, 0 }, { stopFd, POLLIN, 0 } };
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            qWarning() << "poll mountinfo failed:" << strerror(errno);
+            break;
+        }
+
+        if (fds[1].revents)
+            break;
+        if (fds[0].revents & (POLLPRI | POLLERR))
+            reload();
+    }
+}
+
+void MountTable::reload()
+{
+    QByteArray content;
+    char buf[16 * 1024];
+    if (lseek(mountInfoFd, 0, SEEK_SET) < 0)
+        return;
+
+    while (true) {
+        const ssize_t size = read(mountInfoFd, buf, sizeof(buf));
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            break;
+        content.append(buf, static_cast<int>(size));
+    }
+
+    std::atomic_store(&current, Table::parse(content));
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+MountTable::TablePointer MountTable::Table::parse(const QByteArray &mountInfo)
+{
+    auto table = std::make_shared<Table>();
+    table->nodes.append(TrieNode());   // the root
+
+    // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    for (const QByteArray &line : mountInfo.split('\n')) {
+        const QList<QByteArray> &fields = line.split(' ');
+        const int separator = fields.indexOf("-", 6);
+        if (separator < 6 || fields.size() < separator + 3)
+            continue;
+
+        Mount mount;
+        mount.mountPoint = unescape(fields.at(4));
+        mount.fsType = unescape(fields.at(separator + 1));
+        mount.source = unescape(fields.at(separator + 2));
+        mount.isGvfs = mount.fsType == kGvfsFsType;
+        mount.isRemote = remoteFsTypes().contains(mount.fsType);
+        if (!mount.mountPoint.startsWith('/'))
+            continue;
+
+        table->mounts.append(mount);
+        table->insert(table->mounts.size() - 1);
+    }
+
+    return table;
+}
+
+MountTable::PathClass MountTable::Table::classify(const QString &path) const
+{
+    PathClass result;
+    result.mount = find(path);
+    if (!result.mount)
+        return result;
+
+    result.isRemote = result.mount->isRemote;
+    if (result.mount->isGvfs) {
+        // the first directory of gvfs is the location, like smb-share:server=host,share=dir
+        const QString &mountPoint = result.mount->mountPoint;
+        const int start = mountPoint.size() + (mountPoint.endsWith('/') ? 0 : 1);
+        const int end = path.indexOf('/', start);
+        const QStringRef &location = path.midRef(start, end < 0 ? -1 : end - start);
+        const int colon = location.indexOf(':');
+        if (colon > 0) {
+            result.gvfsScheme = location.left(colon).toString();
+            result.isRemote = remoteSchemes().contains(result.gvfsScheme);
+            if (lowSpeedSchemes().contains(result.gvfsScheme))
+                result.speed = kLowSpeed;
+        }
+    }
+
+    return result;
+}
+
+/*!
+ * \brief MountTable::Table::find The mount that the path is in, the path must be absolute.
+ */
+const MountTable::Mount *MountTable::Table::find(const QString &path) const
+{
+    if (nodes.isEmpty() || !path.startsWith('/'))
+        return nullptr;
+
+    int node = 0;
+    const Mount *found = nodes.at(0).mount >= 0 ? &mounts.at(nodes.at(0).mount) : nullptr;
+    int pos = 1;
+    while (pos < path.size()) {
+        int next = path.indexOf('/', pos);
+        if (next < 0)
+            next = path.size();
+
+        if (next > pos) {
+            const QStringRef &name = path.midRef(pos, next - pos);
+            const uint hash = qHash(name);
+            int child = -1;
+            for (auto it = nodes.at(node).children.constFind(hash); it != nodes.at(node).children.constEnd() && it.key() == hash; ++it) {
+                if (nodes.at(it.value()).name == name) {
+                    child = it.value();
+                    break;
+                }
+            }
+            if (child < 0)
+                break;
+
+            node = child;
+            if (nodes.at(node).mount >= 0)
+                found = &mounts.at(nodes.at(node).mount);
+        }
+        pos = next + 1;
+    }
+
+    return found;
+}
+
+const MountTable::Mount *MountTable::Table::findBySource(const QString &source) const
+{
+    for (int i = mounts.size() - 1; i >= 0; --i) {
+        if (mounts.at(i).source == source)
+            return &mounts.at(i);
+    }
+    return nullptr;
+}
+
+const MountTable::Mount *MountTable::Table::findByMountPoint(const QString &mountPoint) const
+{
+    for (int i = mounts.size() - 1; i >= 0; --i) {
+        if (mounts.at(i).mountPoint == mountPoint)
+            return &mounts.at(i);
+    }
+    return nullptr;
+}
+
+void MountTable::Table::insert(int mountIndex)
+{
+    const QString &path = mounts.at(mountIndex).mountPoint;
+    int node = 0;
+    int pos = 1;
+    while (pos < path.size()) {
+        int next = path.indexOf('/', pos);
+        if (next < 0)
+            next = path.size();
+
+        if (next > pos) {
+            const QStringRef &name = path.midRef(pos, next - pos);
+            const uint hash = qHash(name);
+            int child = -1;
+            for (auto it = nodes.at(node).children.constFind(hash); it != nodes.at(node).children.constEnd() && it.key() == hash; ++it) {
+                if (nodes.at(it.value()).name == name) {
+                    child = it.value();
+                    break;
+                }
+            }
+            if (child < 0) {
+                TrieNode trieNode;
+                trieNode.name = name.toString();
+                nodes.append(trieNode);
+                child = nodes.size() - 1;
+                nodes[node].children.insert(hash, child);
+            }
+            node = child;
+        }
+        pos = next + 1;
+    }
+
+    // a later mount on the same path covers the earlier one
+    nodes[node].mount = mountIndex;
+}
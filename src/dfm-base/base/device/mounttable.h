@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MOUNTTABLE_H
+#define MOUNTTABLE_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QString>
+#include <QVector>
+#include <QMultiHash>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace dfmbase {
+
+/*!
+ * \class MountTable
+ * \brief The mounts of the process, parsed from /proc/self/mountinfo once and again when it changes.
+ * A table is never changed after it is published, a reader keeps the table of its thread and only takes
+ * the new one when the generation changed, so classifying a path takes no lock.
+ * The mount of a path is found by walking the components of the path in a trie of the mount points.
+ */
+class MountTable
+{
+    Q_DISABLE_COPY(MountTable)
+
+public:
+    enum SpeedClass : uint8_t {
+        kNormalSpeed,
+        kLowSpeed,   // the gvfs mounts of the devices and the network shares that are listed by the names
+    };
+
+    struct Mount
+    {
+        QString mountPoint;
+        QString source;
+        QString fsType;
+        bool isRemote { false };
+        bool isGvfs { false };
+    };
+
+    struct PathClass
+    {
+        const Mount *mount { nullptr };   // valid while the table of the result is held
+        QString gvfsScheme;   // the scheme of the gvfs mount, like smb-share of smb-share:server=...
+        SpeedClass speed { kNormalSpeed };
+        bool isRemote { false };
+    };
+
+    class Table;
+    using TablePointer = std::shared_ptr<const Table>;
+
+    static MountTable &instance();
+
+    TablePointer table() const;
+    bool isValid() const;
+
+    bool isLowSpeed(const QString &path) const;
+    bool isRemote(const QString &path) const;
+    bool isGvfs(const QString &path) const;
+    QString fsType(const QString &path) const;
+    QString mountPoint(const QString &path) const;
+
+    // like DeviceUtils::getMountInfo, empty if not found
+    QString findMountPoint(const QString &source) const;
+    QString findSource(const QString &mountPoint) const;
+
+private:
+    MountTable();
+    ~MountTable();
+
+    void watch();
+    void reload();
+
+private:
+    int mountInfoFd { -1 };
+    int stopFd { -1 };
+    std::thread watcher;
+
+    TablePointer current;   // accessed by std::atomic_load and std::atomic_store
+    std::atomic<quint64> generation { 0 };
+};
+
+/*!
+ * \brief An immutable snapshot of the mounts.
+ */
+class MountTable::Table
+{
+public:
+    static TablePointer parse(const QByteArray &mountInfo);
+
+    int count() const { return mounts.count(); }
+    const Mount &at(int i) const { return mounts.at(i); }
+    PathClass classify(const QString &path) const;
+    const Mount *find(const QString &path) const;
+    const Mount *findBySource(const QString &source) const;
+    const Mount *findByMountPoint(const QString &mountPoint) const;
+
+private:
+    struct TrieNode
+    {
+        QString name;
+        int mount { -1 };   // the last mount on this path
+        QMultiHash<uint, int> children;   // the hash of the name -> node
+    };
+
+    void insert(int mountIndex);
+
+    QVector<Mount> mounts;
+    QVector<TrieNode> nodes;
+};
+
+}
+
+#endif   // MOUNTTABLE_H
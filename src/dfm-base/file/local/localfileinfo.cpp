@@ -610,6 +610,47 @@ void LocalFileInfo::setExtendedAttributes(const FileExtendedInfoType &key, const
     }
 }
 
+/*!
+ * \brief memoryCost 估算本地文件info占用的内存
+ * 包括dfm-io的info、缓存的属性和缩略图，默认图标由图标提供者共享，不计算在内
+ */
+qint64 LocalFileInfo::memoryCost() const
+{
+    // the GFileInfo of dfm-io with the attributes queried by default
+    static constexpr qint64 kDFileInfoCost = 1024;
+    // a node of the maps with its key
+    static constexpr qint64 kAttributeCost = sizeof(QVariant) + 4 * sizeof(void *);
+    auto variantCost = [](const QVariant &value) -> qint64 {
+        if (value.type() == QVariant::String)
+            return kAttributeCost + value.toString().size() * 2;
+        if (value.type() == QVariant::ByteArray)
+            return kAttributeCost + value.toByteArray().size();
+        return kAttributeCost;
+    };
+
+    qint64 cost = AbstractFileInfo::memoryCost() + sizeof(LocalFileInfoPrivate) - sizeof(AbstractFileInfoPrivate);
+    {
+        QReadLocker locker(&d->lock);
+        if (d->dfmFileInfo)
+            cost += kDFileInfoCost;
+        for (const auto &value : d->cacheAttributes)
+            cost += variantCost(value);
+        for (const auto &value : d->attributesExtend)
+            cost += variantCost(value);
+        for (const auto &value : d->extraProperties)
+            cost += variantCost(value);
+        for (const auto &value : d->extendOtherCache)
+            cost += variantCost(value);
+    }
+    {
+        QReadLocker locker(&d->iconLock);
+        const QIcon &thumb = d->icons.value(LocalFileInfoPrivate::kThumbIcon);
+        for (const QSize &size : thumb.availableSizes())
+            cost += size.width() * size.height() * 4;
+    }
+    return cost;
+}
+
 void LocalFileInfo::init(const QUrl &url, QSharedPointer<DFMIO::DFileInfo> dfileInfo)
 {
     d->mimeTypeMode = QMimeDatabase::MatchDefault;
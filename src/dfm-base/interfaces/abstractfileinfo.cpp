@@ -490,6 +490,19 @@ void DFMBASE_NAMESPACE::AbstractFileInfo::setExtendedAttributes(const ExtInfoTyp
     CALL_PROXY(setExtendedAttributes(key, value));
     dptr->extendOtherCache.insert(key, value);
 }
+/*!
+  * \brief memoryCost 估算info占用的内存，用于文件信息缓存的内存预算
+  * 包括info和私有数据本身、url和代理的info，子类加上自己的私有数据和缓存的属性
+  * return 字节数
+  */
+qint64 DFMBASE_NAMESPACE::AbstractFileInfo::memoryCost() const
+{
+    // QUrl keeps the path in utf-16
+    qint64 cost = sizeof(AbstractFileInfo) + sizeof(AbstractFileInfoPrivate) + dptr->url.path().size() * 2;
+    if (dptr->proxy)
+        cost += dptr->proxy->memoryCost();
+    return cost;
+}
 /*!
  * \brief DFMBASE_NAMESPACE::AbstractFileInfo::fileIcon
  * \return
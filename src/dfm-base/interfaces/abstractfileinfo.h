@@ -257,6 +257,7 @@ public:
     virtual QVariant customAttribute(const char *key, const DFMIO::DFileInfo::DFileAttributeType type);
     virtual QMap<DFMIO::DFileInfo::AttributeExtendID, QVariant> mediaInfoAttributes(DFMIO::DFileInfo::MediaType type, QList<DFMIO::DFileInfo::AttributeExtendID> ids) const;
     virtual void setExtendedAttributes(const FileExtendedInfoType &key, const QVariant &value);
+    virtual qint64 memoryCost() const;
 
 protected:
     explicit AbstractFileInfo(const QUrl &url);
@@ -136,6 +136,7 @@ public:
         kCompleteCustomInfosKey = 17,
         kJobHandlePointer = 18,
         kWorkerPointer = 19,
+        kVerifySpeedKey = 20,   // 完整性校验速度
     };
     Q_ENUM(NotifyInfoKey)
     enum class NotifyType : uint8_t {
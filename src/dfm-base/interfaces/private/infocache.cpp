@@ -11,14 +11,163 @@
 
 #include <QtConcurrent>
 
-// cache file total count
-static constexpr int kCacheFileinfoCount = 20000;
+// memory budget of all cached file infos, counted by AbstractFileInfo::memoryCost
+static constexpr qint64 kCacheMemoryBudget = (128 * 1024 * 1024);
 // rotation training time
 static constexpr int kRotationTrainingTime = (60 * 1000);
 // remove cache time limit
 static constexpr int kCacheRemoveTime = (60 * (60 * 1000));
 
 namespace dfmbase {
+InfoCacheShard::~InfoCacheShard()
+{
+    QMutexLocker lk(&mutex);
+    while (head)
+        removeNode(head);
+}
+
+/*!
+ * \brief value 获取缓存并移动到lru链表头
+ */
+AbstractFileInfoPointer InfoCacheShard::value(const QUrl &url, const qint64 now)
+{
+    QMutexLocker lk(&mutex);
+    InfoCacheNode *node = nodes.value(url);
+    if (!node)
+        return nullptr;
+
+    node->lastAccess = now;
+    if (node != head) {
+        unlink(node);
+        pushFront(node);
+    }
+    return node->info;
+}
+
+void InfoCacheShard::insert(const QUrl &url, const AbstractFileInfoPointer &info, const qint64 cost, const qint64 now)
+{
+    QMutexLocker lk(&mutex);
+    InfoCacheNode *node = nodes.value(url);
+    if (node) {
+        unlink(node);
+        totalCost -= node->cost;
+    } else {
+        node = new InfoCacheNode;
+        node->url = url;
+        nodes.insert(url, node);
+    }
+    node->info = info;
+    node->cost = cost;
+    node->lastAccess = now;
+    totalCost += cost;
+    pushFront(node);
+}
+
+AbstractFileInfoPointer InfoCacheShard::take(const QUrl &url)
+{
+    QMutexLocker lk(&mutex);
+    InfoCacheNode *node = nodes.value(url);
+    if (!node)
+        return nullptr;
+
+    AbstractFileInfoPointer info = node->info;
+    removeNode(node);
+    return info;
+}
+
+/*!
+ * \brief setCost 更新缓存的内存占用，info加载属性和缩略图后占用会增加
+ */
+void InfoCacheShard::setCost(const QUrl &url, const AbstractFileInfoPointer &info, const qint64 cost)
+{
+    QMutexLocker lk(&mutex);
+    InfoCacheNode *node = nodes.value(url);
+    // replaced or removed in the time
+    if (!node || node->info != info)
+        return;
+
+    totalCost += cost - node->cost;
+    node->cost = cost;
+}
+
+/*!
+ * \brief takeOverBudget 从lru链表尾移除，直到内存占用不超过预算
+ */
+void InfoCacheShard::takeOverBudget(const qint64 budget, QMap<QUrl, AbstractFileInfoPointer> *evicted)
+{
+    QMutexLocker lk(&mutex);
+    while (tail && totalCost > budget) {
+        evicted->insert(tail->url, tail->info);
+        removeNode(tail);
+    }
+}
+
+/*!
+ * \brief takeExpired 移除最近访问时间早于deadline的缓存
+ */
+void InfoCacheShard::takeExpired(const qint64 deadline, QMap<QUrl, AbstractFileInfoPointer> *expired)
+{
+    QMutexLocker lk(&mutex);
+    while (tail && tail->lastAccess < deadline) {
+        expired->insert(tail->url, tail->info);
+        removeNode(tail);
+    }
+}
+
+int InfoCacheShard::count()
+{
+    QMutexLocker lk(&mutex);
+    return nodes.size();
+}
+
+qint64 InfoCacheShard::cost()
+{
+    QMutexLocker lk(&mutex);
+    return totalCost;
+}
+
+QMap<QUrl, AbstractFileInfoPointer> InfoCacheShard::infos()
+{
+    QMutexLocker lk(&mutex);
+    QMap<QUrl, AbstractFileInfoPointer> all;
+    for (auto it = nodes.cbegin(); it != nodes.cend(); ++it)
+        all.insert(it.key(), it.value()->info);
+    return all;
+}
+
+void InfoCacheShard::unlink(InfoCacheNode *node)
+{
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        head = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+void InfoCacheShard::pushFront(InfoCacheNode *node)
+{
+    node->prev = nullptr;
+    node->next = head;
+    if (head)
+        head->prev = node;
+    head = node;
+    if (!tail)
+        tail = node;
+}
+
+void InfoCacheShard::removeNode(InfoCacheNode *node)
+{
+    unlink(node);
+    nodes.remove(node->url);
+    totalCost -= node->cost;
+    delete node;
+}
+
 InfoCachePrivate::InfoCachePrivate(InfoCache *qq)
     : q(qq)
 {
@@ -29,6 +178,17 @@ InfoCachePrivate::~InfoCachePrivate()
     cacheWorkerStoped = true;
 }
 
+InfoCacheShard &InfoCachePrivate::shardOf(const QUrl &url)
+{
+    return shards[qHash(url) % kShardCount];
+}
+
+qint64 InfoCachePrivate::costOf(const QUrl &url, const AbstractFileInfoPointer &info)
+{
+    // the node and the hash keep a copy of the url
+    return sizeof(InfoCacheNode) + url.path().size() * 2 + (info ? info->memoryCost() : 0);
+}
+
 InfoCache::InfoCache(QObject *parent)
     : QObject(parent), d(new InfoCachePrivate(this))
 {
@@ -143,40 +303,20 @@ void InfoCache::cacheInfo(const QUrl url, const AbstractFileInfoPointer info)
         }
     }
 
-    // 插入到主和副的所有缓存中
-    d->status = kCacheCopy;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        d->mainCache.insert(url, info);
-    }
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        d->copyCache.insert(url, info);
-    }
-    // 使用线程处理加入时间序列问题
-    emit cacheUpdateInfoTime(url);
-}
-/*!
- * \brief insertSortTime 处理当前文件的移除时间
- *
- * \param qint64 文件info的当前时间
- *
- * \param QString 文件的url
- *
- * \return
- */
-void InfoCache::updateSortTimeWorker(const QUrl url)
-{
-    Q_D(InfoCache);
-    if (d->cacheWorkerStoped)
-        return;
-    auto time = QDateTime::currentMSecsSinceEpoch();
-    auto key = QString::number(time) + QString("-") + url.toString();
-    if (d->urlTimeSortMap.contains(url))
-        d->timeToUrlMap.remove(d->urlTimeSortMap.value(url));
-    d->timeToUrlMap.insert(key, url);
-    d->urlTimeSortMap.insert(url, key);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    InfoCacheShard &shard = d->shardOf(url);
+    // 被替换的info也增加过监视器的连接计数
+    const AbstractFileInfoPointer &oldInfo = shard.take(url);
+    shard.insert(url, info, InfoCachePrivate::costOf(url, info), now);
+
+    // 超出内存预算，移除最久未访问的缓存
+    QMap<QUrl, AbstractFileInfoPointer> evicted;
+    shard.takeOverBudget(kCacheMemoryBudget / InfoCachePrivate::kShardCount, &evicted);
+    d->evictionCount += evicted.size();
+    if (oldInfo)
+        evicted.insert(url, oldInfo);
+    if (!evicted.isEmpty())
+        emit cacheDisconnectWatcher(evicted);
 }
 
 void InfoCache::stop()
@@ -199,33 +339,17 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
     if (d->cacheWorkerStoped || urls.size() <= 0)
         return;
 
-    // 读取主缓存，插入到
-    d->status = kCacheCopy;
     QMap<QUrl, AbstractFileInfoPointer> infos;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        for (const auto &url : urls) {
-            auto info = d->mainCache.take(url);
-            if (info)
-                infos.insert(url, d->mainCache.take(url));
-        }
+    for (const auto &url : urls) {
+        auto info = d->shardOf(url).take(url);
+        if (info)
+            infos.insert(url, info);
     }
     if (d->cacheWorkerStoped)
         return;
     // 断开监视器监视
     if (infos.size() > 0)
         emit cacheDisconnectWatcher(infos);
-    // 移除时间队列
-    emit cacheRemoveInfosTime(urls);
-
-    // 设置读取主缓存和插入到主缓存中
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        for (const auto &url : urls) {
-            d->copyCache.remove(url);
-        }
-    }
 }
 /*!
  * \brief getCacheInfo 获取文件
@@ -237,20 +361,12 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
 AbstractFileInfoPointer InfoCache::getCacheInfo(const QUrl &url)
 {
     Q_D(InfoCache);
-    // 要异步线程重置计时器 todo 开辟一个可控制的线程来处理时间排序的问题
-    // 读取副缓存和临时缓存返回
-    AbstractFileInfoPointer info(nullptr);
-    if (d->status == kCacheMain) {   // 可以读取主缓存返回
-        QReadLocker wlk(&d->mianLock);
-        info = d->mainCache.value(url);
-    } else {
-        QReadLocker wlk(&d->copyLock);
-        info = d->copyCache.value(url);
-    }
-    // 异步线程或者信号更新时间
-    // 使用线程处理加入时间序列问题
+    // 命中时在分片内移动到lru链表头，不需要再异步更新时间
+    AbstractFileInfoPointer info = d->shardOf(url).value(url, QDateTime::currentMSecsSinceEpoch());
     if (info)
-        emit cacheUpdateInfoTime(url);
+        d->hitCount++;
+    else
+        d->missCount++;
 
     return info;
 }
@@ -269,42 +385,47 @@ void InfoCache::refreshFileInfo(const QUrl &url)
 }
 /*!
  * \brief timeRemoveCache 定时检查哪些fileinfo要移除
+ * 移除超时的缓存，重新估算其余缓存的内存占用，并移除超出内存预算的缓存
  *
  * \return
  */
 void InfoCache::timeRemoveCache()
 {
     Q_D(InfoCache);
-    // 取出哪些url的时间超出了u
-    qint64 delCount = d->urlTimeSortMap.size() < kCacheFileinfoCount ? 0 : d->urlTimeSortMap.size() - kCacheFileinfoCount;
-    QList<QUrl> delList;
-    foreach (const auto time, d->timeToUrlMap.uniqueKeys()) {
+    const qint64 deadline = QDateTime::currentMSecsSinceEpoch() - kCacheRemoveTime;
+    QMap<QUrl, AbstractFileInfoPointer> expired;
+    for (auto &shard : d->shards) {
         if (d->cacheWorkerStoped)
             return;
+        shard.takeExpired(deadline, &expired);
 
-        if (time < QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch() - kCacheRemoveTime)) {
-            delList.append(d->timeToUrlMap.values(time));
-            continue;
-        }
-
-        if (delList.size() >= delCount) {
-            break;
-        }
-
-        delList.append(d->timeToUrlMap.values(time));
+        // the infos are costed out of the shard lock, they take their own locks
+        const QMap<QUrl, AbstractFileInfoPointer> &infos = shard.infos();
+        for (auto it = infos.cbegin(); it != infos.cend(); ++it)
+            shard.setCost(it.key(), it.value(), InfoCachePrivate::costOf(it.key(), it.value()));
+        shard.takeOverBudget(kCacheMemoryBudget / InfoCachePrivate::kShardCount, &expired);
     }
-    // 发送异步消息 告诉移除线程创建移除线程移除，考虑是否是使用线程一直还是使用临时线程（使用临时线程）
-    if (delList.size() > 0 && !d->cacheWorkerStoped)
-        emit cacheRemoveCaches(delList);
+    d->evictionCount += expired.size();
+    if (expired.size() > 0 && !d->cacheWorkerStoped)
+        emit cacheDisconnectWatcher(expired);
 }
 
-void InfoCache::removeInfosTimeWorker(const QList<QUrl> urls)
-{
-    for (auto url : urls) {
-        if (d->urlTimeSortMap.contains(url)) {
-            d->timeToUrlMap.remove(d->urlTimeSortMap.take(url));
-        }
+/*!
+ * \brief statistics 缓存的命中、未命中、移除次数和当前的数量、内存占用
+ *
+ * \return 统计信息
+ */
+InfoCacheStatistics InfoCache::statistics() const
+{
+    InfoCacheStatistics stat;
+    stat.hitCount = d->hitCount;
+    stat.missCount = d->missCount;
+    stat.evictionCount = d->evictionCount;
+    for (auto &shard : d->shards) {
+        stat.count += shard.count();
+        stat.cost += shard.cost();
     }
+    return stat;
 }
 
 void InfoCache::fileAttributeChanged(const QUrl url)
@@ -334,24 +455,12 @@ void CacheWorker::removeCaches(const QList<QUrl> urls)
     InfoCache::instance().removeCaches(urls);
 }
 
-void CacheWorker::updateInfoTime(const QUrl url)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().updateSortTimeWorker(url);
-}
-
 void CacheWorker::dealRemoveInfo()
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
     InfoCache::instance().timeRemoveCache();
 }
 
-void CacheWorker::removeInfosTime(const QList<QUrl> urls)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().removeInfosTimeWorker(urls);
-}
-
 void CacheWorker::disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos)
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
@@ -387,6 +496,11 @@ AbstractFileInfoPointer InfoCacheController::getCacheInfo(const QUrl &url)
     return InfoCache::instance().getCacheInfo(url);
 }
 
+InfoCacheStatistics InfoCacheController::cacheStatistics() const
+{
+    return InfoCache::instance().statistics();
+}
+
 InfoCacheController::InfoCacheController(QObject *parent)
     : QObject(parent), thread(new QThread), worker(new CacheWorker), removeTimer(new QTimer)
 {
@@ -399,7 +513,6 @@ void InfoCacheController::init()
     connect(removeTimer.data(), &QTimer::timeout, worker.data(), &CacheWorker::dealRemoveInfo, Qt::QueuedConnection);
     connect(this, &InfoCacheController::cacheFileInfo, worker.data(), &CacheWorker::cacheInfo, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheRemoveCaches, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
-    connect(&InfoCache::instance(), &InfoCache::cacheRemoveInfosTime, worker.data(), &CacheWorker::removeInfosTime, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheDisconnectWatcher, worker.data(), &CacheWorker::disconnectWatcher, Qt::QueuedConnection);
 
     worker->moveToThread(thread.data());
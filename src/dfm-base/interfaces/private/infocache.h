@@ -19,6 +19,16 @@ namespace dfmbase {
 class InfoCachePrivate;
 class InfoCache;
 
+// 缓存的统计信息，用于诊断
+struct InfoCacheStatistics
+{
+    qint64 hitCount { 0 };
+    qint64 missCount { 0 };
+    qint64 evictionCount { 0 };   // 超出内存预算或超时被移除的数量
+    int count { 0 };
+    qint64 cost { 0 };   // 估算的内存占用
+};
+
 // 异步缓存和移除
 class CacheWorker : public QObject
 {
@@ -30,9 +40,7 @@ public:
 public Q_SLOTS:
     void cacheInfo(const QUrl url, const AbstractFileInfoPointer info);
     void removeCaches(const QList<QUrl> urls);
-    void updateInfoTime(const QUrl url);
     void dealRemoveInfo();
-    void removeInfosTime(const QList<QUrl> urls);
     void disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
 
 private:
@@ -55,8 +63,6 @@ public:
 Q_SIGNALS:
     void cacheRemoveCaches(const QList<QUrl> &key);
     void cacheDisconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
-    void cacheUpdateInfoTime(const QUrl url);
-    void cacheRemoveInfosTime(const QList<QUrl> urls);
 
 private:
     explicit InfoCache(QObject *parent = nullptr);
@@ -68,9 +74,8 @@ private:
     void cacheInfo(const QUrl url, const AbstractFileInfoPointer info);
     void disconnectWatcher(const QMap<QUrl, AbstractFileInfoPointer> infos);
     void removeCaches(const QList<QUrl> urls);
-    void updateSortTimeWorker(const QUrl url);
     void timeRemoveCache();
-    void removeInfosTimeWorker(const QList<QUrl> urls);
+    InfoCacheStatistics statistics() const;
 
 private Q_SLOTS:
     void fileAttributeChanged(const QUrl url);
@@ -91,6 +96,7 @@ public:
     bool cacheDisable(const QString &scheme);
     void setCacheDisbale(const QString &scheme, bool disable = true);
     AbstractFileInfoPointer getCacheInfo(const QUrl &url);
+    InfoCacheStatistics cacheStatistics() const;
 Q_SIGNALS:
     void cacheFileInfo(const QUrl url, const AbstractFileInfoPointer info);
 
@@ -7,16 +7,53 @@
 
 #include "infocache.h"
 
-#include <QReadWriteLock>
 #include <QMutex>
 #include <QTimer>
-#include <QMap>
+#include <QHash>
+
+#include <array>
 
 namespace dfmbase {
-enum CacheInfoStatus : uint8_t {
-    kCacheMain = 0,   // 1.正常状态 插入(同时插入主和副缓存hash)， 读取主缓存hash， 删除主缓存hash
-    kCacheCopy,
+// 缓存节点，同时在hash和lru链表中，链表头是最近访问的
+struct InfoCacheNode
+{
+    QUrl url;
+    AbstractFileInfoPointer info { nullptr };
+    qint64 cost { 0 };   // 估算的内存占用
+    qint64 lastAccess { 0 };   // 最近访问时间(ms)
+    InfoCacheNode *prev { nullptr };
+    InfoCacheNode *next { nullptr };
+};
+
+// 缓存分片，每个分片独立加锁，按url的hash分配
+class InfoCacheShard
+{
+public:
+    ~InfoCacheShard();
+
+    AbstractFileInfoPointer value(const QUrl &url, const qint64 now);
+    void insert(const QUrl &url, const AbstractFileInfoPointer &info, const qint64 cost, const qint64 now);
+    AbstractFileInfoPointer take(const QUrl &url);
+    void setCost(const QUrl &url, const AbstractFileInfoPointer &info, const qint64 cost);
+    void takeOverBudget(const qint64 budget, QMap<QUrl, AbstractFileInfoPointer> *evicted);
+    void takeExpired(const qint64 deadline, QMap<QUrl, AbstractFileInfoPointer> *expired);
+    int count();
+    qint64 cost();
+    QMap<QUrl, AbstractFileInfoPointer> infos();
+
+private:
+    void unlink(InfoCacheNode *node);
+    void pushFront(InfoCacheNode *node);
+    void removeNode(InfoCacheNode *node);
+
+private:
+    QMutex mutex;
+    QHash<QUrl, InfoCacheNode *> nodes;
+    InfoCacheNode *head { nullptr };   // most recently used
+    InfoCacheNode *tail { nullptr };   // least recently used
+    qint64 totalCost { 0 };
 };
+
 class InfoCachePrivate
 {
     friend class InfoCache;
@@ -24,21 +61,20 @@ class InfoCachePrivate
     InfoCache *const q;
     DThreadList<QString> disableCahceSchemes;
 
-    QAtomicInt status { kCacheMain };   // 当前状态缓存的状态
-    QHash<QUrl, AbstractFileInfoPointer> mainCache;   // 主信息缓存
-    QHash<QUrl, AbstractFileInfoPointer> copyCache;   // 副信息缓存
-    QReadWriteLock mianLock;
-    QReadWriteLock copyLock;
-
-    // 时间排序url,利用map的有序性，来处理时间到了要移除的url
-    QMap<QUrl, QString> urlTimeSortMap;
-    QMap<QString, QUrl> timeToUrlMap;
+    static constexpr int kShardCount { 16 };
+    std::array<InfoCacheShard, kShardCount> shards;
 
     std::atomic_bool cacheWorkerStoped { false };
+    std::atomic_int64_t hitCount { 0 };
+    std::atomic_int64_t missCount { 0 };
+    std::atomic_int64_t evictionCount { 0 };
 
 public:
     explicit InfoCachePrivate(InfoCache *qq);
     virtual ~InfoCachePrivate();
+
+    InfoCacheShard &shardOf(const QUrl &url);
+    static qint64 costOf(const QUrl &url, const AbstractFileInfoPointer &info);
 };
 }
 
@@ -6,6 +6,7 @@
 
 #include "dfm-base/utils/fileutils.h"
 #include "dfm-base/base/schemefactory.h"
+#include "dfm-base/base/device/mounttable.h"
 
 #include <QUrl>
 #include <QFileInfo>
@@ -21,6 +22,21 @@ static QStringList officeSuffixList {
 };
 static const QStringList blackList { "/sys/kernel/security/apparmor/revision", "/sys/kernel/security/apparmor/policy/revision", "/sys/power/wakeup_count", "/proc/kmsg" };
 
+// the path is in a location of the gvfs mounts, like /run/user/1000/gvfs/smb-share:server=...
+static bool isGvfsLocation(const QString &path)
+{
+    const MountTable &mountTable = MountTable::instance();
+    if (mountTable.isValid())
+        return mountTable.isGvfs(path);
+
+    static const QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
+                                           QRegularExpression::DotMatchesEverythingOption
+                                                   | QRegularExpression::DontCaptureOption);
+    return regExp.match(path, 0, QRegularExpression::NormalMatch,
+                        QRegularExpression::DontCheckSubjectStringMatchOption)
+            .hasMatch();
+}
+
 DMimeDatabase::DMimeDatabase()
 {
 }
@@ -45,15 +61,7 @@ QMimeType DMimeDatabase::mimeTypeForFile(const AbstractFileInfoPointer &fileInfo
         //fix bug 35448 【文件管理器】【5.1.2.2-1】【sp2】预览ftp路径下某个文件夹后，文管卡死,访问特殊系统文件卡死
         if (fileInfo->nameOf(NameInfoType::kFileName).endsWith(".pid") || path.endsWith("msg.lock")
             || fileInfo->nameOf(NameInfoType::kFileName).endsWith(".lock") || fileInfo->nameOf(NameInfoType::kFileName).endsWith("lockfile")) {
-            QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
-                                      QRegularExpression::DotMatchesEverythingOption
-                                              | QRegularExpression::DontCaptureOption
-                                              | QRegularExpression::OptimizeOnFirstUsageOption);
-
-            const QRegularExpressionMatch &match = regExp.match(path, 0, QRegularExpression::NormalMatch,
-                                                                QRegularExpression::DontCheckSubjectStringMatchOption);
-
-            isMatchExtension = match.hasMatch();
+            isMatchExtension = isGvfsLocation(path);
         } else {
             // filemanger will be blocked when blacklist contais the filepath.
             QString filePath = fileInfo->pathOf(PathInfoType::kAbsoluteFilePath);
@@ -89,9 +97,10 @@ QMimeType DMimeDatabase::mimeTypeForFile(const AbstractFileInfoPointer &fileInfo
 
 QMimeType DMimeDatabase::mimeTypeForFile(const QString &fileName, QMimeDatabase::MatchMode mode, const QString &inod, const bool isGvfs) const
 {
-    if (!inod.isEmpty() && inodMimetypeCache.contains(inod)) {
-        return inodMimetypeCache.value(inod);
-    }
+    bool found = false;
+    const QMimeType &cached = cachedMimeType(inod, &found);
+    if (found)
+        return cached;
     return mimeTypeForFile(QFileInfo(fileName), mode, inod, isGvfs);
 }
 
@@ -100,9 +109,10 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
     Q_UNUSED(isGvfs)
     // 如果是低速设备，则先从扩展名去获取mime信息；对于本地文件，保持默认的获取策略
     bool canCache = !inod.isEmpty();
-    if (!inod.isEmpty() && inodMimetypeCache.contains(inod)) {
-        return inodMimetypeCache.value(inod);
-    }
+    bool found = false;
+    const QMimeType &cached = cachedMimeType(inod, &found);
+    if (found)
+        return cached;
     if (fileInfo.isDir()) {
         return QMimeDatabase::mimeTypeForFile(QFileInfo("/home"), mode);
     }
@@ -115,15 +125,7 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
     if (!isMatchExtension) {
         if (fileInfo.fileName().endsWith(".pid") || path.endsWith("msg.lock")
             || fileInfo.fileName().endsWith(".lock") || fileInfo.fileName().endsWith("lockfile")) {
-            QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
-                                      QRegularExpression::DotMatchesEverythingOption
-                                              | QRegularExpression::DontCaptureOption
-                                              | QRegularExpression::OptimizeOnFirstUsageOption);
-
-            const QRegularExpressionMatch &match = regExp.match(path, 0, QRegularExpression::NormalMatch,
-                                                                QRegularExpression::DontCheckSubjectStringMatchOption);
-
-            isMatchExtension = match.hasMatch();
+            isMatchExtension = isGvfsLocation(path);
         } else {
             // filemanger will be blocked when blacklist contais the filepath.
             // fix task #29124, bug #108805
@@ -151,17 +153,38 @@ QMimeType DMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, QMimeDatabas
         QList<QMimeType> results = QMimeDatabase::mimeTypesForFileName(fileInfo.fileName());
         if (!results.isEmpty()) {
             if (canCache) {
-                const_cast<DMimeDatabase *>(this)->inodMimetypeCache.insert(inod, results.first());
+                cacheMimeType(inod, results.first());
             }
             return results.first();
         }
     }
     if (canCache) {
-        const_cast<DMimeDatabase *>(this)->inodMimetypeCache.insert(inod, result);
+        cacheMimeType(inod, result);
     }
     return result;
 }
 
+QMimeType DMimeDatabase::cachedMimeType(const QString &inod, bool *found) const
+{
+    *found = false;
+    if (inod.isEmpty())
+        return QMimeType();
+
+    QReadLocker lk(&cacheLock);
+    auto it = inodMimetypeCache.constFind(inod);
+    if (it == inodMimetypeCache.constEnd())
+        return QMimeType();
+
+    *found = true;
+    return it.value();
+}
+
+void DMimeDatabase::cacheMimeType(const QString &inod, const QMimeType &type) const
+{
+    QWriteLocker lk(&cacheLock);
+    inodMimetypeCache.insert(inod, type);
+}
+
 QMimeType DMimeDatabase::mimeTypeForUrl(const QUrl &url) const
 {
     if (dfmbase::FileUtils::isLocalFile(url))
@@ -10,6 +10,7 @@
 #include "dfm-base/interfaces/abstractfileinfo.h"
 
 #include <QMimeDatabase>
+#include <QReadWriteLock>
 
 namespace dfmbase {
 
@@ -28,10 +29,13 @@ public:
     QMimeType mimeTypeForUrl(const QUrl &url) const;
 private:
     QMimeType mimeTypeForFile(const QFileInfo &fileInfo, MatchMode mode, const QString &inod, const bool isGvfs = false) const;
-
+    QMimeType cachedMimeType(const QString &inod, bool *found) const;
+    void cacheMimeType(const QString &inod, const QMimeType &type) const;
 
 private:
-    QHash<QString, QMimeType> inodMimetypeCache;
+    // the database is shared by the threads of FileInfoHelper
+    mutable QReadWriteLock cacheLock;
+    mutable QHash<QString, QMimeType> inodMimetypeCache;
 };
 
 }
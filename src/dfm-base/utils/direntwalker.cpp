@@ -0,0 +1,268 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "direntwalker.h"
+
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSet>
+#include <QThread>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace dfmbase {
+
+namespace {
+constexpr int kMaxWalkThreads { 8 };
+constexpr int kDirentBufferSize { 32 * 1024 };
+constexpr int kInodeShardCount { 16 };
+constexpr unsigned long kIdleWaitTime { 2 };   // ms
+
+struct LinuxDirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+struct WalkQueue
+{
+    QMutex mutex;
+    QList<DirentWalker::Directory> dirs;
+};
+
+struct InodeShard
+{
+    QMutex mutex;
+    QSet<QPair<quint64, quint64>> inodes;
+};
+}   // namespace
+
+class DirentWalkerPrivate
+{
+public:
+    explicit DirentWalkerPrivate(int count);
+
+    void run(const int index);
+    bool takeDir(const int index, DirentWalker::Directory *dir);
+    void pushDirs(const int index, const std::vector<DirentWalker::Directory> &dirs);
+    void finishDir();
+    void readDirectory(const int index, const DirentWalker::Directory &dir, std::vector<DirentWalker::Directory> *subDirs);
+
+    const int threadCount;
+    DirentWalker::EntryFunc entryFunc;
+    DirentWalker::DirectoryFunc directoryFunc;
+    std::function<bool()> stateCheck;
+    std::atomic_bool stopped { false };
+
+    std::vector<std::unique_ptr<WalkQueue>> queues;
+    std::atomic_int pendingDirs { 0 };
+    QMutex idleMutex;
+    QWaitCondition idleCondition;
+
+    std::array<InodeShard, kInodeShardCount> inodeShards;
+};
+
+DirentWalkerPrivate::DirentWalkerPrivate(int count)
+    : threadCount(count > 0 ? count : qBound(1, QThread::idealThreadCount(), kMaxWalkThreads))
+{
+    for (int i = 0; i < threadCount; ++i)
+        queues.emplace_back(new WalkQueue);
+}
+
+void DirentWalkerPrivate::run(const int index)
+{
+    DirentWalker::Directory dir;
+    while (takeDir(index, &dir)) {
+        std::vector<DirentWalker::Directory> subDirs;
+        if (stateCheck && !stateCheck())
+            stopped = true;
+        else
+            readDirectory(index, dir, &subDirs);
+
+        pushDirs(index, subDirs);
+        finishDir();
+    }
+}
+
+bool DirentWalkerPrivate::takeDir(const int index, DirentWalker::Directory *dir)
+{
+    while (!stopped) {
+        {
+            // the own queue is used as a stack, so a thread stays deep in one subtree
+            WalkQueue &own = *queues.at(static_cast<size_t>(index));
+            QMutexLocker lk(&own.mutex);
+            if (!own.dirs.isEmpty()) {
+                *dir = own.dirs.takeLast();
+                return true;
+            }
+        }
+
+        // steal the oldest directory of the others, it is usually the largest subtree
+        for (int i = 1; i < threadCount; ++i) {
+            WalkQueue &other = *queues.at(static_cast<size_t>((index + i) % threadCount));
+            QMutexLocker lk(&other.mutex);
+            if (!other.dirs.isEmpty()) {
+                *dir = other.dirs.takeFirst();
+                return true;
+            }
+        }
+
+        QMutexLocker lk(&idleMutex);
+        if (pendingDirs.load() == 0)
+            return false;
+        idleCondition.wait(&idleMutex, kIdleWaitTime);
+    }
+
+    return false;
+}
+
+void DirentWalkerPrivate::pushDirs(const int index, const std::vector<DirentWalker::Directory> &dirs)
+{
+    if (dirs.empty())
+        return;
+
+    pendingDirs.fetch_add(static_cast<int>(dirs.size()));
+    {
+        WalkQueue &own = *queues.at(static_cast<size_t>(index));
+        QMutexLocker lk(&own.mutex);
+        for (const DirentWalker::Directory &dir : dirs)
+            own.dirs.append(dir);
+    }
+
+    if (dirs.size() > 1)
+        idleCondition.wakeAll();
+}
+
+void DirentWalkerPrivate::finishDir()
+{
+    if (pendingDirs.fetch_sub(1) == 1) {
+        QMutexLocker lk(&idleMutex);
+        idleCondition.wakeAll();
+    }
+}
+
+void DirentWalkerPrivate::readDirectory(const int index, const DirentWalker::Directory &dir,
+                                        std::vector<DirentWalker::Directory> *subDirs)
+{
+    const int fd = open(dir.path.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    QByteArray prefix = dir.path;
+    if (!prefix.endsWith('/'))
+        prefix.append('/');
+
+    alignas(LinuxDirent64) char buffer[kDirentBufferSize];
+    while (!stopped) {
+        const long count = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (count <= 0)
+            break;
+
+        for (long offset = 0; offset < count;) {
+            const auto *dirent = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+            offset += dirent->d_reclen;
+
+            const char *name = dirent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+
+            if (entryFunc)
+                entryFunc(index, dir, prefix, DirentWalker::Entry { fd, name, dirent->d_type }, subDirs);
+        }
+    }
+    close(fd);
+
+    if (directoryFunc)
+        directoryFunc(index, dir);
+}
+
+DirentWalker::DirentWalker(int threadCount)
+    : d(new DirentWalkerPrivate(threadCount))
+{
+}
+
+DirentWalker::~DirentWalker()
+{
+}
+
+int DirentWalker::threadCount() const
+{
+    return d->threadCount;
+}
+
+void DirentWalker::setEntryFunc(const EntryFunc &func)
+{
+    d->entryFunc = func;
+}
+
+void DirentWalker::setDirectoryFunc(const DirectoryFunc &func)
+{
+    d->directoryFunc = func;
+}
+
+void DirentWalker::setStateCheck(const std::function<bool()> &check)
+{
+    d->stateCheck = check;
+}
+
+/*!
+ * \brief DirentWalker::walk Walk the roots and everything in them, blocks until the walk is finished
+ * The calling thread is the walking thread 0.
+ * \return false if the walk is stopped
+ */
+bool DirentWalker::walk(const std::vector<Directory> &roots)
+{
+    if (roots.empty())
+        return !d->stopped;
+
+    d->pushDirs(0, roots);
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < d->threadCount; ++i)
+        threads.emplace_back(&DirentWalkerPrivate::run, d.data(), i);
+
+    d->run(0);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    return !d->stopped;
+}
+
+void DirentWalker::stop()
+{
+    d->stopped = true;
+    d->idleCondition.wakeAll();
+}
+
+bool DirentWalker::isStopped() const
+{
+    return d->stopped;
+}
+
+/*!
+ * \brief DirentWalker::markVisited Mark the file visited, for the hard links and the directories
+ * reached again through links or bind mounts. Called by the walking threads too.
+ * \return false if it is visited before
+ */
+bool DirentWalker::markVisited(quint64 dev, quint64 ino)
+{
+    InodeShard &shard = d->inodeShards[ino % kInodeShardCount];
+    QMutexLocker lk(&shard.mutex);
+    const int oldCount = shard.inodes.count();
+    shard.inodes.insert(qMakePair(dev, ino));
+    return shard.inodes.count() != oldCount;
+}
+
+}
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRENTWALKER_H
+#define DIRENTWALKER_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QByteArray>
+#include <QScopedPointer>
+
+#include <functional>
+#include <vector>
+
+namespace dfmbase {
+
+class DirentWalkerPrivate;
+/*!
+ * \class DirentWalker
+ * \brief Walk local file trees with several threads and hand every dirent to a callback.
+ * Every thread owns a stack of directories and steals the oldest directory of the others when it runs out,
+ * the directories are read by getdents64. The callbacks are called by the walking threads, with the index
+ * of the thread, so the callers can keep the state of a directory per thread without locking.
+ */
+class DirentWalker
+{
+    Q_DISABLE_COPY(DirentWalker)
+    QScopedPointer<DirentWalkerPrivate> d;
+
+public:
+    struct Directory
+    {
+        QByteArray path;
+        quint64 dev { 0 };
+        int flags { 0 };   // defined by the caller, usually inherited by the subdirectories
+    };
+
+    struct Entry
+    {
+        int dirFd { -1 };   // the fd of the directory, for the *at calls
+        const char *name { nullptr };
+        unsigned char type { 0 };   // the d_type, DT_UNKNOWN if the file system does not fill it
+    };
+
+    // called for every entry but . and .., the directories to walk are appended to subDirs
+    using EntryFunc = std::function<void(int thread, const Directory &dir, const QByteArray &prefix,
+                                         const Entry &entry, std::vector<Directory> *subDirs)>;
+    // called after a directory is read, before its subdirectories are queued
+    using DirectoryFunc = std::function<void(int thread, const Directory &dir)>;
+
+    explicit DirentWalker(int threadCount = 0);
+    ~DirentWalker();
+
+    int threadCount() const;
+    void setEntryFunc(const EntryFunc &func);
+    void setDirectoryFunc(const DirectoryFunc &func);
+    // called by the walking threads before every directory, return false to stop the walk
+    void setStateCheck(const std::function<bool()> &check);
+
+    bool walk(const std::vector<Directory> &roots);
+    void stop();
+    bool isStopped() const;
+
+    bool markVisited(quint64 dev, quint64 ino);
+};
+
+}
+
+#endif   // DIRENTWALKER_H
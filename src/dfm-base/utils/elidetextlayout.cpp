@@ -10,17 +10,41 @@
 #include <QTextDocument>
 #include <QTextLayout>
 #include <QTextBlock>
+#include <QGlyphRun>
+#include <QGuiApplication>
+#include <QThread>
+#include <QCache>
 #include <QDebug>
 
 using namespace dfmbase;
 
-ElideTextLayout::ElideTextLayout(const QString &text)
-    : document(new QTextDocument)
+namespace {
+constexpr int kMaxCachedLines { 4096 };
+
+struct CachedLine
 {
-    document->setPlainText(text);
+    QRectF rect;   // relative to the top left of the layout rect
+    QString text;
+    QList<QGlyphRun> glyphRuns;
+};
+using CachedLines = QVector<CachedLine>;
+
+// only used in the gui thread, the font engines of the glyph runs belong to the thread.
+// it is never deleted, the glyph runs must not outlive the application.
+QCache<QString, CachedLines> &layoutCache()
+{
+    static auto *cache = new QCache<QString, CachedLines>(kMaxCachedLines);
+    return *cache;
+}
+}   // namespace
 
-    attributes.insert(kFont, document->defaultFont());
-    attributes.insert(kLineHeight, QFontMetrics(document->defaultFont()).height());
+ElideTextLayout::ElideTextLayout(const QString &text)
+    : plainText(text)
+{
+    // the document is created only when it is needed, the default font is the one of QTextDocument
+    const QFont font;
+    attributes.insert(kFont, font);
+    attributes.insert(kLineHeight, QFontMetrics(font).height());
     attributes.insert(kBackgroundRadius, 0);
     attributes.insert(kAlignment, Qt::AlignCenter);
     attributes.insert(kWrapMode, (uint)QTextOption::WrapAtWordBoundaryOrAnywhere);
@@ -35,15 +59,36 @@ ElideTextLayout::~ElideTextLayout()
 
 void ElideTextLayout::setText(const QString &text)
 {
-    document->setPlainText(text);
+    plainText = text;
+    if (document)
+        document->setPlainText(text);
 }
 
 QString ElideTextLayout::text() const
 {
-    return document->toPlainText();
+    return document ? document->toPlainText() : plainText;
+}
+
+QTextDocument *ElideTextLayout::documentHandle()
+{
+    // the caller may change the document, so it is laid out without the cache from now on
+    if (!document) {
+        document = new QTextDocument;
+        document->setPlainText(plainText);
+    }
+    return document;
 }
 
 QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    if (!document && qApp && QThread::currentThread() == qApp->thread())
+        return layoutCached(rect, elideMode, painter, background, textLines);
+
+    documentHandle();
+    return layoutDocument(rect, elideMode, painter, background, textLines);
+}
+
+QList<QRectF> ElideTextLayout::layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
 {
     QList<QRectF> ret;
     QTextLayout *lay = document->firstBlock().layout();
@@ -142,6 +187,114 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
     return ret;
 }
 
+/*!
+ * \brief ElideTextLayout::layoutCached The same lines as layoutDocument, the lines of a text are
+ * broken only once for the same attributes and size, then they are drawn by their glyph runs.
+ * A renamed file or a changed font makes a new key.
+ */
+QList<QRectF> ElideTextLayout::layoutCached(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    const int textLineHeight = attribute<int>(kLineHeight);
+    const QStringList keys { attribute<QFont>(kFont).key(),
+                             QString::number(textLineHeight),
+                             QString::number(attribute<uint>(kAlignment)),
+                             QString::number(attribute<uint>(kWrapMode)),
+                             QString::number(static_cast<int>(attribute<Qt::LayoutDirection>(kTextDirection))),
+                             QString::number(elideMode),
+                             QString::number(rect.width()),
+                             QString::number(rect.height()),
+                             plainText };
+    const QString &key = keys.join(QChar(0x1f));
+
+    CachedLines lines;
+    if (CachedLines *cached = layoutCache().object(key)) {
+        lines = *cached;
+    } else {
+        // the document only lays out its first block
+        const int blockEnd = plainText.indexOf('\n');
+        QTextLayout lay(blockEnd < 0 ? plainText : plainText.left(blockEnd));
+        initLayoutOption(&lay);
+
+        const QSizeF size = rect.size();
+        QPointF offset(0, 0);
+        qreal curHeight = 0;
+        QString elideText;
+
+        auto appendLine = [&lines, textLineHeight](const QTextLine &line, const QString &text) {
+            QRectF lRect = line.naturalTextRect();
+            lRect.setHeight(textLineHeight);
+            lines.append(CachedLine { lRect, text.mid(line.textStart(), line.textLength()), line.glyphRuns() });
+        };
+
+        lay.beginLayout();
+        QTextLine line = lay.createLine();
+        while (line.isValid()) {
+            curHeight += textLineHeight;
+            line.setLineWidth(size.width());
+            line.setPosition(offset);
+
+            // check next line is out or not.
+            if (curHeight + textLineHeight > size.height()) {
+                auto nextLine = lay.createLine();
+                if (nextLine.isValid()) {
+                    QFontMetrics fm(lay.font());
+                    elideText = fm.elidedText(plainText.mid(line.textStart()), elideMode, qRound(size.width()));
+                    break;
+                }
+            }
+
+            appendLine(line, plainText);
+            line = lay.createLine();
+            offset.setY(offset.y() + textLineHeight);
+        }
+        lay.endLayout();
+
+        // process last elided line.
+        if (!elideText.isEmpty()) {
+            QTextLayout newlay;
+            newlay.setFont(lay.font());
+            {
+                auto oldWrap = (QTextOption::WrapMode)attribute<uint>(kWrapMode);
+                setAttribute(kWrapMode, (uint)QTextOption::NoWrap);
+                initLayoutOption(&newlay);
+
+                // restore
+                setAttribute(kWrapMode, oldWrap);
+            }
+
+            newlay.setText(elideText);
+            newlay.beginLayout();
+            auto elideLine = newlay.createLine();
+            elideLine.setLineWidth(size.width() - 1);
+            elideLine.setPosition(offset);
+            appendLine(elideLine, elideText);
+            newlay.endLayout();
+        }
+
+        layoutCache().insert(key, new CachedLines(lines), lines.size() + 1);
+    }
+
+    QList<QRectF> ret;
+    QRectF lastLineRect;
+    const QPointF topLeft = rect.topLeft();
+    for (const CachedLine &line : lines) {
+        const QRectF &lRect = line.rect.translated(topLeft);
+        ret.append(lRect);
+        if (textLines)
+            textLines->append(line.text);
+
+        if (painter) {
+            if (background.style() != Qt::NoBrush)
+                lastLineRect = drawLineBackground(painter, lRect, lastLineRect, background);
+
+            for (const QGlyphRun &run : line.glyphRuns)
+                painter->drawGlyphRun(topLeft, run);
+        }
+    }
+
+    return ret;
+}
+
 QRectF ElideTextLayout::drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const
 {
     const qreal backgroundRadius = attribute<qreal>(kBackgroundRadius);
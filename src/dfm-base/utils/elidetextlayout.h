@@ -14,7 +14,13 @@ class QTextDocument;
 class QTextLayout;
 
 namespace dfmbase {
-
+/*!
+ * \class ElideTextLayout
+ * \brief Lay out a file name in lines and elide the last line.
+ * The lines and their glyph runs are cached by the text and the layout attributes, so painting
+ * and measuring the same name again does not break it into lines again. The layout that has
+ * its document changed by documentHandle() is not cached.
+ */
 class ElideTextLayout
 {
 public:
@@ -33,9 +39,7 @@ public:
     QString text() const;
     QList<QRectF> layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter = nullptr, const QBrush &background = Qt::NoBrush, QStringList *textLines = nullptr);
 public:
-    inline QTextDocument *documentHandle() {
-        return document;
-    }
+    QTextDocument *documentHandle();
 
     inline void setAttribute(Attribute attr, const QVariant &value) {
         attributes.insert(attr, value);
@@ -49,8 +53,11 @@ public:
 protected:
     QRectF drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const;
     virtual void initLayoutOption(QTextLayout *lay);
+    QList<QRectF> layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines);
+    QList<QRectF> layoutCached(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines);
 protected:
     QTextDocument *document = nullptr;
+    QString plainText;   // the text before the document is created
     QMap<Attribute, QVariant> attributes;
 };
 }
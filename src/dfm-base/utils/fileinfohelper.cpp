@@ -5,13 +5,37 @@
 #include "fileinfohelper.h"
 
 #include <QGuiApplication>
+#include <QRunnable>
+#include <QThread>
 #include <QTimer>
+#include <QSet>
+
+#include <algorithm>
 
 Q_DECLARE_METATYPE(QSharedPointer<dfmio::DFileInfo>);
 
 DFMBASE_USE_NAMESPACE
+
+namespace {
+class LaneRunnable : public QRunnable
+{
+public:
+    explicit LaneRunnable(const std::function<void()> &func)
+        : func(func) {}
+    void run() override { func(); }
+
+private:
+    std::function<void()> func;
+};
+
+inline QString thumbTaskKey(const QUrl &url, ThumbnailProvider::Size size)
+{
+    return QString("thumb:%1:%2").arg(size).arg(url.toString());
+}
+}   // namespace
+
 FileInfoHelper::FileInfoHelper(QObject *parent)
-    : QObject(parent), thread(new QThread), worker(new FileInfoAsycWorker)
+    : QObject(parent), worker(new FileInfoAsycWorker)
 {
     init();
 }
@@ -20,40 +44,42 @@ void FileInfoHelper::init()
 {
     // connect quit app to stop
     connect(qApp, &QGuiApplication::aboutToQuit, this, &FileInfoHelper::aboutToQuit);
-    // connect thumb
 
     // connect file info async worker
-    connect(this, &FileInfoHelper::fileCount, worker.data(), &FileInfoAsycWorker::fileConutAsync, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::fileConutAsyncFinish, this, &FileInfoHelper::fileCountFinished, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileMimeType, worker.data(), &FileInfoAsycWorker::fileMimeType, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileInfoRefresh, worker.data(), &FileInfoAsycWorker::fileRefresh, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::fileMimeTypeFinished, this, &FileInfoHelper::fileMimeTypeFinished, Qt::QueuedConnection);
-    connect(this, &FileInfoHelper::fileThumb, worker.data(), &FileInfoAsycWorker::fileThumb, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::createThumbnailFinished,
             this, &FileInfoHelper::createThumbnailFinished, Qt::QueuedConnection);
     connect(worker.data(), &FileInfoAsycWorker::createThumbnailFailed,
             this, &FileInfoHelper::createThumbnailFailed, Qt::QueuedConnection);
 
-    worker->moveToThread(thread.data());
-    thread->start();
+    pools[kMetadataLane].setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+    // ThumbnailProvider keeps the error string and the mime types in the instance, it is not thread safe
+    pools[kThumbnailLane].setMaxThreadCount(1);
 }
 
 QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileCountAsync(QUrl &url)
 {
     if (stoped)
         return nullptr;
-    QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
-    emit fileCount(url, data);
-    return data;
+
+    const QUrl countUrl(url);
+    return addTask(kMetadataLane, "count:" + countUrl.toString(),
+                   [this, countUrl](const QSharedPointer<FileInfoHelperUeserData> &data) {
+                       worker->fileConutAsync(countUrl, data);
+                   });
 }
 
 QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileMimeTypeAsync(const QUrl &url, const QMimeDatabase::MatchMode mode, const QString &inod, const bool isGvfs)
 {
     if (stoped)
         return nullptr;
-    QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
-    emit fileMimeType(url, mode, inod, isGvfs, data);
-    return data;
+
+    const QString &key = QString("mime:%1:%2:%3:%4").arg(mode).arg(isGvfs).arg(inod, url.toString());
+    return addTask(kMetadataLane, key,
+                   [this, url, mode, inod, isGvfs](const QSharedPointer<FileInfoHelperUeserData> &data) {
+                       worker->fileMimeType(url, mode, inod, isGvfs, data);
+                   });
 }
 
 QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileThumbAsync(const QUrl &url, ThumbnailProvider::Size size)
@@ -61,12 +87,18 @@ QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::fileThumbAsync(const QUr
     if (stoped)
         return nullptr;
     static constexpr uint16_t kRequestThumbnailDealy { 500 };
-    QSharedPointer<FileInfoHelperUeserData> data(new FileInfoHelperUeserData);
-    QUrl thumbUrl(url);
-    QTimer::singleShot(kRequestThumbnailDealy, [thumbUrl, size, data]() {
-        if (FileInfoHelper::instance().stoped)
+
+    // the thumbnail waits a moment before queued, the item may be scrolled out of the view in the time
+    const QString &key = thumbTaskKey(url, size);
+    auto data = addTask(kThumbnailLane, key,
+                        [this, url, size](const QSharedPointer<FileInfoHelperUeserData> &data) {
+                            worker->fileThumb(url, size, data);
+                        },
+                        false);
+    QTimer::singleShot(kRequestThumbnailDealy, this, [this, key]() {
+        if (stoped)
             return;
-        emit FileInfoHelper::instance().fileThumb(thumbUrl, size, data);
+        queueTask(key);
     });
 
     return data;
@@ -77,7 +109,104 @@ void FileInfoHelper::fileRefreshAsync(const QUrl &url, const QSharedPointer<dfmi
     if (stoped)
         return;
 
-    emit fileInfoRefresh(url, dfileInfo);
+    // a refresh of another DFileInfo of the url is not the same request
+    const QString &key = QString("refresh:%1:%2").arg(reinterpret_cast<quintptr>(dfileInfo.data()), 0, 16).arg(url.toString());
+    addTask(kMetadataLane, key,
+            [this, url, dfileInfo](const QSharedPointer<FileInfoHelperUeserData> &) {
+                worker->fileRefresh(url, dfileInfo);
+            });
+}
+
+/*!
+ * \brief FileInfoHelper::holdThumbAsync Hold the thumbnail requests of the url which are not started,
+ * the views share the requests of the same url, so a request is only canceled by its last holder.
+ * \return true if a request is held, the holder must give it back by cancelThumbAsync
+ */
+bool FileInfoHelper::holdThumbAsync(const QUrl &url)
+{
+    QMutexLocker lk(&taskMutex);
+    if (tasks.isEmpty())
+        return false;
+
+    bool held = false;
+    for (auto size : { ThumbnailProvider::kSmall, ThumbnailProvider::kNormal, ThumbnailProvider::kLarge }) {
+        auto it = tasks.find(thumbTaskKey(url, size));
+        if (it == tasks.end() || it->isRunning)
+            continue;
+
+        ++it->holders;
+        held = true;
+    }
+
+    return held;
+}
+
+/*!
+ * \brief FileInfoHelper::cancelThumbAsync Give back the thumbnail requests of the url held by holdThumbAsync,
+ * the requests which are not started are dropped when no one holds them.
+ * The result of a dropped request is finished and empty, so the item requests again when it is shown.
+ * \return true if a request is dropped
+ */
+bool FileInfoHelper::cancelThumbAsync(const QUrl &url)
+{
+    QMutexLocker lk(&taskMutex);
+    if (tasks.isEmpty())
+        return false;
+
+    bool canceled = false;
+    for (auto size : { ThumbnailProvider::kSmall, ThumbnailProvider::kNormal, ThumbnailProvider::kLarge }) {
+        auto it = tasks.find(thumbTaskKey(url, size));
+        // not held, or requested again after the held one finished
+        if (it == tasks.end() || it->holders <= 0)
+            continue;
+
+        if (--it->holders > 0 || it->isRunning)
+            continue;
+
+        // the key left in the queue is skipped by runTask
+        it->data->data = QString();
+        it->data->finish = true;
+        tasks.erase(it);
+        canceled = true;
+    }
+
+    return canceled;
+}
+
+/*!
+ * \brief FileInfoHelper::raiseThumbAsync Run the thumbnail requests of the urls before the others,
+ * the last url first. The requests still waiting for the delay are queued at once.
+ */
+void FileInfoHelper::raiseThumbAsync(const QList<QUrl> &urls)
+{
+    QMutexLocker lk(&taskMutex);
+    if (tasks.isEmpty())
+        return;
+
+    QStringList keys;
+    for (const QUrl &url : urls) {
+        for (auto size : { ThumbnailProvider::kSmall, ThumbnailProvider::kNormal, ThumbnailProvider::kLarge }) {
+            const QString &key = thumbTaskKey(url, size);
+            auto it = tasks.constFind(key);
+            if (it != tasks.constEnd() && !it->isRunning)
+                keys.append(key);
+        }
+    }
+    if (keys.isEmpty())
+        return;
+
+    // a runnable takes whatever key is on the top, so removing keys from the queue is safe
+    const QSet<QString> raised(keys.begin(), keys.end());
+    QList<QString> &queue = laneQueues[kThumbnailLane];
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+                               [&raised](const QString &key) { return raised.contains(key); }),
+                queue.end());
+    for (const QString &key : keys) {
+        if (tasks.constFind(key)->isQueued)
+            queue.append(key);
+        else
+            queueTaskLocked(key);
+    }
 }
 
 FileInfoHelper::~FileInfoHelper()
@@ -91,10 +220,88 @@ FileInfoHelper &FileInfoHelper::instance()
     return helper;
 }
 
+/*!
+ * \brief FileInfoHelper::addTask Add a request to the lane, an identical request which is not started
+ * is shared instead. A started one may have read the file before it changed, so it is replaced by the new
+ * request and only finishes its own requesters. The request is not started before queueTask if queued is false.
+ */
+QSharedPointer<FileInfoHelperUeserData> FileInfoHelper::addTask(AsyncLane lane, const QString &key,
+                                                                const TaskFunc &run, bool queued)
+{
+    QMutexLocker lk(&taskMutex);
+    auto it = tasks.constFind(key);
+    if (it != tasks.constEnd() && !it->isRunning)
+        return it->data;
+
+    AsyncTask task;
+    task.lane = lane;
+    task.data.reset(new FileInfoHelperUeserData);
+    task.run = run;
+    tasks.insert(key, task);
+    if (queued)
+        queueTaskLocked(key);
+
+    return task.data;
+}
+
+void FileInfoHelper::queueTask(const QString &key)
+{
+    QMutexLocker lk(&taskMutex);
+    queueTaskLocked(key);
+}
+
+void FileInfoHelper::queueTaskLocked(const QString &key)
+{
+    auto it = tasks.find(key);
+    if (it == tasks.end() || it->isQueued)
+        return;
+
+    it->isQueued = true;
+    const AsyncLane lane = it->lane;
+    laneQueues[lane].append(key);
+    // one runnable for one key, it takes the key by the order of the lane rather than its own
+    pools[lane].start(new LaneRunnable([this, lane]() { runTask(lane); }));
+}
+
+void FileInfoHelper::runTask(AsyncLane lane)
+{
+    QString key;
+    AsyncTask task;
+    {
+        QMutexLocker lk(&taskMutex);
+        if (laneQueues[lane].isEmpty())
+            return;
+
+        key = lane == kThumbnailLane ? laneQueues[lane].takeLast() : laneQueues[lane].takeFirst();
+        auto it = tasks.find(key);
+        // canceled, or the same key queued again after canceled and taken by another runnable
+        if (it == tasks.end() || it->isRunning)
+            return;
+        it->isRunning = true;
+        task = it.value();
+    }
+
+    if (!stoped)
+        task.run(task.data);
+
+    QMutexLocker lk(&taskMutex);
+    // the key may be taken by a request added while running
+    auto it = tasks.find(key);
+    if (it != tasks.end() && it->data == task.data)
+        tasks.erase(it);
+}
+
 void FileInfoHelper::aboutToQuit()
 {
     stoped = true;
-    thread->quit();
     worker->stopWorker();
-    thread->wait();
+    {
+        QMutexLocker lk(&taskMutex);
+        for (auto &queue : laneQueues)
+            queue.clear();
+    }
+    for (auto &pool : pools) {
+        pool.clear();
+        pool.waitForDone();
+    }
 }
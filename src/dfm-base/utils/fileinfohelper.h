@@ -12,11 +12,24 @@
 #include <dfm-io/dfileinfo.h>
 
 #include <QObject>
-#include <QThread>
+#include <QThreadPool>
 #include <QVariant>
 #include <QMimeDatabase>
+#include <QMutex>
+#include <QHash>
+
+#include <functional>
 
 namespace dfmbase {
+/*!
+ * \class FileInfoHelper
+ * \brief Run the slow file info requests out of the main thread.
+ * The requests go into two lanes with their own threads, so the thumbnails never block the mime types
+ * and the counts: the metadata lane runs the oldest request first, the thumbnail lane runs the newest
+ * first because it is the item just scrolled into the view. An identical request that is not finished
+ * shares the result of the first one, and a thumbnail that is not started can be canceled when all the
+ * requesters holding it let it go.
+ */
 class FileInfoHelper : public QObject
 {
     Q_OBJECT
@@ -28,10 +41,35 @@ public:
                                                               const QString &inod, const bool isGvfs);
     QSharedPointer<FileInfoHelperUeserData> fileThumbAsync(const QUrl &url, ThumbnailProvider::Size size);
     void fileRefreshAsync(const QUrl &url, const QSharedPointer<dfmio::DFileInfo> dfileInfo);
+    bool holdThumbAsync(const QUrl &url);
+    bool cancelThumbAsync(const QUrl &url);
+    void raiseThumbAsync(const QList<QUrl> &urls);
 
 private:
+    enum AsyncLane {
+        kMetadataLane,
+        kThumbnailLane,
+        kLaneCount
+    };
+
+    using TaskFunc = std::function<void(const QSharedPointer<FileInfoHelperUeserData> &)>;
+    struct AsyncTask
+    {
+        AsyncLane lane { kMetadataLane };
+        QSharedPointer<FileInfoHelperUeserData> data;
+        TaskFunc run;
+        bool isQueued { false };
+        bool isRunning { false };
+        int holders { 0 };   // the requesters which may cancel it
+    };
+
     explicit FileInfoHelper(QObject *parent = nullptr);
     void init();
+    QSharedPointer<FileInfoHelperUeserData> addTask(AsyncLane lane, const QString &key, const TaskFunc &run,
+                                                    bool queued = true);
+    void queueTask(const QString &key);
+    void queueTaskLocked(const QString &key);
+    void runTask(AsyncLane lane);
 
 private:
     // send for other
@@ -41,19 +79,17 @@ Q_SIGNALS:
     void mediaDataFinished(const QUrl &sourceFile, QMap<dfmio::DFileInfo::AttributeExtendID, QVariant> properties);
     void fileCountFinished(const QUrl &url, const int fileCount);
     void fileMimeTypeFinished(const QUrl &url, const QMimeType &type);
-    // shend to fileinfoasyncworker for async get attribute
-    void fileCount(const QUrl &url, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileMimeType(const QUrl &url, const QMimeDatabase::MatchMode mode, const QString &inod,
-                      const bool isGvfs, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileThumb(const QUrl &url, ThumbnailProvider::Size size, const QSharedPointer<FileInfoHelperUeserData> data);
-    void fileInfoRefresh(const QUrl &url, QSharedPointer<dfmio::DFileInfo> dfileInfo);
 private Q_SLOTS:
     void aboutToQuit();
 
 private:
-    QSharedPointer<QThread> thread { nullptr };
     QSharedPointer<FileInfoAsycWorker> worker { nullptr };
     std::atomic_bool stoped { false };
+
+    QThreadPool pools[kLaneCount];
+    QMutex taskMutex;
+    QHash<QString, AsyncTask> tasks;   // the requests not finished, by the key of the request
+    QList<QString> laneQueues[kLaneCount];
 };
 }
 
@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filesizewalker.h"
+#include "direntwalker.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QStorageInfo>
+
+#include <atomic>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/sysmacros.h>
+
+namespace dfmbase {
+
+namespace {
+constexpr long kProcSuperMagic { 0x9fa0 };
+constexpr long kFuseSuperMagic { 0x65735546 };
+// the flags of a walked directory
+constexpr int kInProc { 0x1 };   // the sizes of proc are not real
+
+struct EntryStat
+{
+    quint32 mode { 0 };
+    quint64 dev { 0 };
+    quint64 ino { 0 };
+    quint32 nlink { 0 };
+    qint64 size { 0 };
+};
+
+// statx only asks for the fields used here, fstatat is the fallback of the old kernels
+bool statEntry(const int dirFd, const char *name, const bool follow, EntryStat *st)
+{
+    static std::atomic_bool statxSupported { true };
+    const int flags = AT_NO_AUTOMOUNT | (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+
+    if (statxSupported.load(std::memory_order_relaxed)) {
+        struct statx stx;
+        if (statx(dirFd, name, flags, STATX_TYPE | STATX_INO | STATX_NLINK | STATX_SIZE, &stx) == 0) {
+            st->mode = stx.stx_mode;
+            st->dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+            st->ino = stx.stx_ino;
+            st->nlink = stx.stx_nlink;
+            st->size = static_cast<qint64>(stx.stx_size);
+            return true;
+        }
+        if (errno != ENOSYS)
+            return false;
+        statxSupported.store(false, std::memory_order_relaxed);
+    }
+
+    struct stat statInfo;
+    if (fstatat(dirFd, name, &statInfo, flags) != 0)
+        return false;
+
+    st->mode = statInfo.st_mode;
+    st->dev = statInfo.st_dev;
+    st->ino = statInfo.st_ino;
+    st->nlink = static_cast<quint32>(statInfo.st_nlink);
+    st->size = statInfo.st_size;
+    return true;
+}
+
+// the counts of one directory, published after the whole directory is read
+struct WalkCounters
+{
+    qint64 size { 0 };
+    qint64 progressSize { 0 };
+    int files { 0 };
+    int directories { 0 };
+    QList<QUrl> urls;
+};
+}   // namespace
+
+class FileSizeWalkerPrivate
+{
+public:
+    FileSizeWalkerPrivate(FileSizeWalker::WalkFlags walkFlags, int count);
+
+    void countEntry(const int dirFd, const char *name, const QByteArray &path, const DirentWalker::Directory *parent,
+                    WalkCounters *counters, std::vector<DirentWalker::Directory> *children);
+    bool isSkippedMount(DirentWalker::Directory *dir) const;
+    bool isSkippedType(const quint32 mode) const;
+    void publish(WalkCounters *counters);
+
+    const FileSizeWalker::WalkFlags flags;
+    const qint64 pageSize;
+    DirentWalker walker;
+    // the counts of the directory being read by every walking thread
+    std::vector<WalkCounters> threadCounters;
+
+    std::atomic<qint64> totalSize { 0 };
+    std::atomic<qint64> totalProgressSize { 0 };
+    std::atomic_int filesCount { 0 };
+    std::atomic_int directoriesCount { 0 };
+
+    mutable QMutex urlsMutex;
+    QList<QUrl> urls;
+};
+
+FileSizeWalkerPrivate::FileSizeWalkerPrivate(FileSizeWalker::WalkFlags walkFlags, int count)
+    : flags(walkFlags),
+      pageSize(getpagesize()),
+      walker(count),
+      threadCounters(static_cast<size_t>(walker.threadCount()))
+{
+    walker.setEntryFunc([this](int thread, const DirentWalker::Directory &dir, const QByteArray &prefix,
+                               const DirentWalker::Entry &entry, std::vector<DirentWalker::Directory> *subDirs) {
+        countEntry(entry.dirFd, entry.name, prefix + entry.name, &dir, &threadCounters[static_cast<size_t>(thread)], subDirs);
+    });
+    // the urls of a directory are published before its children are queued,
+    // so a directory is always recorded before anything in it
+    walker.setDirectoryFunc([this](int thread, const DirentWalker::Directory &) {
+        publish(&threadCounters[static_cast<size_t>(thread)]);
+    });
+}
+
+/*!
+ * \brief FileSizeWalkerPrivate::countEntry Count one entry, and queue it if it is a directory
+ * \param dirFd the fd of the parent directory, AT_FDCWD for the roots
+ * \param name the name in the parent directory, or the path of a root
+ * \param parent the parent directory, nullptr for the roots
+ */
+void FileSizeWalkerPrivate::countEntry(const int dirFd, const char *name, const QByteArray &path, const DirentWalker::Directory *parent,
+                                       WalkCounters *counters, std::vector<DirentWalker::Directory> *children)
+{
+    EntryStat st;
+    if (!statEntry(dirFd, name, false, &st))
+        return;
+
+    bool throughLink = false;
+    if (S_ISLNK(st.mode) && flags.testFlag(FileSizeWalker::kFollowSymlink)) {
+        EntryStat target;
+        if (statEntry(dirFd, name, true, &target)) {
+            st = target;
+            throughLink = true;
+        }
+    }
+
+    const bool counted = parent || !flags.testFlag(FileSizeWalker::kExcludeRoots);
+    if (S_ISDIR(st.mode)) {
+        // a followed link may point to a walked directory or to an ancestor
+        if (flags.testFlag(FileSizeWalker::kFollowSymlink) && !walker.markVisited(st.dev, st.ino))
+            return;
+
+        if (counted) {
+            ++counters->directories;
+            counters->progressSize += pageSize;
+            if (flags.testFlag(FileSizeWalker::kRecordUrls))
+                counters->urls.append(QUrl::fromLocalFile(QFile::decodeName(path)));
+        }
+
+        DirentWalker::Directory child { path, st.dev, parent ? parent->flags : 0 };
+        if (!parent || st.dev != parent->dev) {
+            // the roots are always walked, whatever they are mounted by
+            if (isSkippedMount(&child) && parent)
+                return;
+        }
+
+        children->push_back(child);
+        return;
+    }
+
+    if (!counted)
+        return;
+
+    if (flags.testFlag(FileSizeWalker::kDeduplicateHardLinks) && (throughLink || st.nlink > 1) && !walker.markVisited(st.dev, st.ino))
+        return;
+
+    ++counters->files;
+    if (flags.testFlag(FileSizeWalker::kRecordUrls))
+        counters->urls.append(QUrl::fromLocalFile(QFile::decodeName(path)));
+
+    // the link itself, not followed or broken
+    if (S_ISLNK(st.mode)) {
+        counters->progressSize += pageSize;
+        return;
+    }
+
+    if (isSkippedType(st.mode))
+        return;
+
+    const qint64 size = (S_ISREG(st.mode) && !(parent && (parent->flags & kInProc))) ? st.size : 0;
+    counters->size += size;
+    counters->progressSize += (size <= 0 || throughLink) ? pageSize : size;
+}
+
+// only called for the mount points, the file system type is checked once for every mount
+bool FileSizeWalkerPrivate::isSkippedMount(DirentWalker::Directory *dir) const
+{
+    struct statfs fsInfo;
+    if (statfs(dir->path.constData(), &fsInfo) != 0)
+        return false;
+
+    if (fsInfo.f_type == kProcSuperMagic) {
+        dir->flags |= kInProc;
+        return flags.testFlag(FileSizeWalker::kSkipPROCStorage);
+    }
+    dir->flags &= ~kInProc;
+
+    // all fuse mounts have the same type, avfsd is told by the device
+    if (fsInfo.f_type == kFuseSuperMagic && flags.testFlag(FileSizeWalker::kSkipAVFSDStorage))
+        return QStorageInfo(QFile::decodeName(dir->path)).device() == "avfsd";
+
+    return false;
+}
+
+bool FileSizeWalkerPrivate::isSkippedType(const quint32 mode) const
+{
+    if (S_ISCHR(mode))
+        return flags.testFlag(FileSizeWalker::kSkipCharDevice);
+    if (S_ISBLK(mode))
+        return flags.testFlag(FileSizeWalker::kSkipBlockDevice);
+    if (S_ISFIFO(mode))
+        return flags.testFlag(FileSizeWalker::kSkipFIFOFile);
+    if (S_ISSOCK(mode))
+        return flags.testFlag(FileSizeWalker::kSkipSocketFile);
+    return false;
+}
+
+void FileSizeWalkerPrivate::publish(WalkCounters *counters)
+{
+    totalSize.fetch_add(counters->size, std::memory_order_relaxed);
+    totalProgressSize.fetch_add(counters->progressSize, std::memory_order_relaxed);
+    filesCount.fetch_add(counters->files, std::memory_order_relaxed);
+    directoriesCount.fetch_add(counters->directories, std::memory_order_relaxed);
+
+    if (!counters->urls.isEmpty()) {
+        QMutexLocker lk(&urlsMutex);
+        urls.append(counters->urls);
+    }
+    *counters = WalkCounters();
+}
+
+FileSizeWalker::FileSizeWalker(WalkFlags flags, int threadCount)
+    : d(new FileSizeWalkerPrivate(flags, threadCount))
+{
+}
+
+FileSizeWalker::~FileSizeWalker()
+{
+}
+
+void FileSizeWalker::setStateCheck(const std::function<bool()> &check)
+{
+    d->walker.setStateCheck(check);
+}
+
+/*!
+ * \brief FileSizeWalker::walk Count the roots and everything in them, blocks until the walk is finished
+ * The calling thread is one of the walking threads.
+ * \return false if the walk is stopped
+ */
+bool FileSizeWalker::walk(const QList<QUrl> &roots)
+{
+    WalkCounters counters;
+    std::vector<DirentWalker::Directory> dirs;
+    for (const QUrl &url : roots) {
+        const QByteArray &path = QFile::encodeName(url.path());
+        d->countEntry(AT_FDCWD, path.constData(), path, nullptr, &counters, &dirs);
+    }
+    d->publish(&counters);
+
+    return d->walker.walk(dirs);
+}
+
+void FileSizeWalker::stop()
+{
+    d->walker.stop();
+}
+
+bool FileSizeWalker::isStopped() const
+{
+    return d->walker.isStopped();
+}
+
+qint64 FileSizeWalker::totalSize() const
+{
+    return d->totalSize.load(std::memory_order_relaxed);
+}
+
+// every directory, link and empty file is counted as one memory page
+qint64 FileSizeWalker::totalProgressSize() const
+{
+    return d->totalProgressSize.load(std::memory_order_relaxed);
+}
+
+int FileSizeWalker::filesCount() const
+{
+    return d->filesCount.load(std::memory_order_relaxed);
+}
+
+int FileSizeWalker::directoriesCount() const
+{
+    return d->directoriesCount.load(std::memory_order_relaxed);
+}
+
+QList<QUrl> FileSizeWalker::recordedUrls() const
+{
+    QMutexLocker lk(&d->urlsMutex);
+    return d->urls;
+}
+
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILESIZEWALKER_H
+#define FILESIZEWALKER_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QUrl>
+#include <QList>
+#include <QScopedPointer>
+
+#include <functional>
+
+namespace dfmbase {
+
+class FileSizeWalkerPrivate;
+/*!
+ * \class FileSizeWalker
+ * \brief Count the size of local file trees with several threads.
+ * The trees are walked by DirentWalker, and the entries are stated by statx relative to the directory fd.
+ * The totals are updated after every directory, so they can be read while walking.
+ */
+class FileSizeWalker
+{
+    Q_DISABLE_COPY(FileSizeWalker)
+    QScopedPointer<FileSizeWalkerPrivate> d;
+
+public:
+    enum WalkFlag {
+        kNoFlag = 0x0000,
+        kFollowSymlink = 0x0001,
+        kDeduplicateHardLinks = 0x0002,   // count a file with several links only once, like du
+        kRecordUrls = 0x0004,   // a directory is always recorded before its children
+        kExcludeRoots = 0x0008,   // only count the children of the roots
+
+        kSkipCharDevice = 0x0010,
+        kSkipBlockDevice = 0x0020,
+        kSkipFIFOFile = 0x0040,
+        kSkipSocketFile = 0x0080,
+        kSkipPROCStorage = 0x0100,   // do not enter proc mounts below the roots
+        kSkipAVFSDStorage = 0x0200,   // do not enter avfsd mounts below the roots
+    };
+    Q_DECLARE_FLAGS(WalkFlags, WalkFlag)
+
+    explicit FileSizeWalker(WalkFlags flags = kNoFlag, int threadCount = 0);
+    ~FileSizeWalker();
+
+    // called by the walking threads before every directory, return false to stop the walk
+    void setStateCheck(const std::function<bool()> &check);
+
+    bool walk(const QList<QUrl> &roots);
+    void stop();
+    bool isStopped() const;
+
+    qint64 totalSize() const;
+    qint64 totalProgressSize() const;
+    int filesCount() const;
+    int directoriesCount() const;
+    QList<QUrl> recordedUrls() const;
+};
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(DFMBASE_NAMESPACE::FileSizeWalker::WalkFlags)
+
+#endif   // FILESIZEWALKER_H
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "filestatisticsjob.h"
+#include "filesizewalker.h"
 #include "interfaces/abstractfileinfo.h"
 #include "base/schemefactory.h"
 #include "interfaces/abstractdiriterator.h"
@@ -23,6 +24,8 @@
 #include <sys/stat.h>
 #include <dirent.h>
 
+#include <algorithm>
+
 namespace dfmbase {
 
 static constexpr uint16_t kSizeChangeinterval { 200 };
@@ -41,6 +44,9 @@ public:
     void processFile(const QUrl &url, const bool followLink, QQueue<QUrl> &directoryQueue);
     void emitSizeChanged();
     int countFileCount(const char *name, bool isloop = false);
+    bool canWalkInParallel() const;
+    FileSizeWalker::WalkFlags walkFlags() const;
+    void syncWalkerTotals(const FileSizeWalker &walker);
 
     FileStatisticsJob *q;
     QTimer *notifyDataTimer;
@@ -58,6 +64,7 @@ public:
     QAtomicInt directoryCount { 0 };
     SizeInfoPointer sizeInfo { nullptr };
     QList<QUrl> fileStatistics;
+    QMutex walkerSyncMutex;
 };
 
 FileStatisticsJobPrivate::FileStatisticsJobPrivate(FileStatisticsJob *qq)
@@ -295,6 +302,49 @@ int FileStatisticsJobPrivate::countFileCount(const char *name, bool isloop)
     return fileCount;
 }
 
+// the local trees are walked by several threads, the other urls and the single depth count by the dir iterators
+bool FileStatisticsJobPrivate::canWalkInParallel() const
+{
+    if (fileHints.testFlag(FileStatisticsJob::kSingleDepth))
+        return false;
+
+    return std::all_of(sourceUrlList.cbegin(), sourceUrlList.cend(), [](const QUrl &url) {
+        return url.isLocalFile() && !FileUtils::isGvfsFile(url);
+    });
+}
+
+FileSizeWalker::WalkFlags FileStatisticsJobPrivate::walkFlags() const
+{
+    FileSizeWalker::WalkFlags flags = FileSizeWalker::kDeduplicateHardLinks;
+    if (!fileHints.testFlag(FileStatisticsJob::kNoFollowSymlink))
+        flags |= FileSizeWalker::kFollowSymlink;
+    if (fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile))
+        flags |= FileSizeWalker::kExcludeRoots;
+    if (fileHints.testFlag(FileStatisticsJob::kRecordFileUrls))
+        flags |= FileSizeWalker::kRecordUrls;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipCharDeviceFile))
+        flags |= FileSizeWalker::kSkipCharDevice;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipBlockDeviceFile))
+        flags |= FileSizeWalker::kSkipBlockDevice;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipFIFOFile))
+        flags |= FileSizeWalker::kSkipFIFOFile;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipSocketFile))
+        flags |= FileSizeWalker::kSkipSocketFile;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipPROCStorage))
+        flags |= FileSizeWalker::kSkipPROCStorage;
+    if (!fileHints.testFlag(FileStatisticsJob::kDontSkipAVFSDStorage))
+        flags |= FileSizeWalker::kSkipAVFSDStorage;
+    return flags;
+}
+
+void FileStatisticsJobPrivate::syncWalkerTotals(const FileSizeWalker &walker)
+{
+    totalSize = walker.totalSize();
+    totalProgressSize = walker.totalProgressSize();
+    filesCount = walker.filesCount();
+    directoryCount = walker.directoriesCount();
+}
+
 FileStatisticsJob::FileStatisticsJob(QObject *parent)
     : QThread(parent), d(new FileStatisticsJobPrivate(this))
 {
@@ -405,7 +455,10 @@ void FileStatisticsJob::run()
     d->filesCount = 0;
     d->directoryCount = 0;
 
-    statistcsOtherFileSystem();
+    if (d->canWalkInParallel())
+        statistcsLocalFileSystem();
+    else
+        statistcsOtherFileSystem();
 }
 
 void FileStatisticsJob::setSizeInfo()
@@ -530,4 +583,27 @@ void FileStatisticsJob::statistcsOtherFileSystem()
     d->setState(kStoppedState);
 }
 
+void FileStatisticsJob::statistcsLocalFileSystem()
+{
+    Q_EMIT dataNotify(0, 0, 0);
+
+    FileSizeWalker walker(d->walkFlags());
+    walker.setStateCheck([this, &walker] {
+        // called by every walking thread, one of them is enough to update the totals
+        if (d->walkerSyncMutex.tryLock()) {
+            d->syncWalkerTotals(walker);
+            d->emitSizeChanged();
+            d->walkerSyncMutex.unlock();
+        }
+        return d->stateCheck();
+    });
+    walker.walk(d->sourceUrlList);
+
+    d->syncWalkerTotals(walker);
+    if (d->fileHints.testFlag(kRecordFileUrls))
+        d->sizeInfo->allFiles = walker.recordedUrls();
+    setSizeInfo();
+    d->setState(kStoppedState);
+}
+
 }
@@ -37,6 +37,7 @@ public:
         kNoFollowSymlink = 0x0001,
         kExcludeSourceFile = 0x0002,
         kSingleDepth = 0x0004,
+        kRecordFileUrls = 0x0008,
 
         kDontSkipAVFSDStorage = 0x0010,
         kDontSkipPROCStorage = 0x0020,
@@ -83,6 +84,7 @@ private:
 private:
     void setSizeInfo();
     void statistcsOtherFileSystem();
+    void statistcsLocalFileSystem();
 };
 
 }
@@ -12,6 +12,7 @@
 #include "dfm-base/utils/finallyutil.h"
 #include "dfm-base/base/device/deviceutils.h"
 #include "dfm-base/base/device/deviceproxymanager.h"
+#include "dfm-base/base/device/mounttable.h"
 #include "dfm-base/base/schemefactory.h"
 #include "dfm-base/base/application/application.h"
 #include "dfm-base/base/application/settings.h"
@@ -309,6 +310,11 @@ bool FileUtils::isLowSpeedDevice(const QUrl &url)
 {
     const QString &path = url.path();
 
+    // the gvfs mounts are all fuse.gvfsd-fuse, the low speed ones are told by the location under the mount point
+    const MountTable &mountTable = MountTable::instance();
+    if (mountTable.isValid() && path.startsWith('/'))
+        return mountTable.isLowSpeed(path);
+
     static QMutex mutex;
     QMutexLocker lk(&mutex);
     static QRegularExpression regExp("^/run/user/\\d+/gvfs/(?<scheme>\\w+(-?)\\w+):\\S*",
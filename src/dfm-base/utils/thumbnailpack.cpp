@@ -0,0 +1,587 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailpack.h"
+
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QList>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace dfmbase {
+
+namespace {
+constexpr char kPackMagic[8] { 'D', 'F', 'M', 'T', 'P', 'A', 'C', 'K' };
+constexpr quint32 kPackVersion { 1 };
+constexpr int kMaxEdge { 1024 };
+constexpr qint64 kCompactSize { 8 * 1024 * 1024 };
+constexpr int kMaxOpenPacks { 8 };
+constexpr qint64 kMaxPackSize { 256 * 1024 * 1024 };
+constexpr qint64 kMaxCacheSize { 1024 * 1024 * 1024 };
+constexpr int kTrimInterval { 60 * 1000 };   // 清理缓存的最小间隔(ms)
+
+struct PackHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+struct RecordHeader
+{
+    quint64 inode;
+    qint64 mtime;
+    quint16 width;
+    quint16 height;
+    quint32 reserved;
+};
+static_assert(sizeof(RecordHeader) % 8 == 0, "the pixels of a record must be aligned");
+
+inline qint64 pixelsSize(int width, int height)
+{
+    return static_cast<qint64>(width) * height * 4;
+}
+
+inline qint64 recordSize(int width, int height)
+{
+    return static_cast<qint64>(sizeof(RecordHeader)) + ((pixelsSize(width, height) + 7) & ~7);
+}
+
+QString packDir()
+{
+    static const QString kPackDir = [] {
+        const QString &dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                + "/deepin/dde-file-manager/thumbnails";
+        QDir().mkpath(dir);
+        return dir;
+    }();
+    return kPackDir;
+}
+
+// the inodes of the files in the directory, false if the directory can not be read
+bool dirInodes(const QString &dirPath, QSet<quint64> *inodes)
+{
+    DIR *dir = opendir(dirPath.toLocal8Bit().constData());
+    if (!dir)
+        return false;
+
+    while (struct dirent *ent = readdir(dir))
+        inodes->insert(ent->d_ino);
+    closedir(dir);
+    return true;
+}
+
+bool hasPackHeader(int fd, qint64 fileSize)
+{
+    PackHeader header;
+    return fileSize >= static_cast<qint64>(sizeof(header))
+            && pread(fd, &header, sizeof(header), 0) == sizeof(header)
+            && memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) == 0
+            && header.version == kPackVersion;
+}
+
+class FileLock
+{
+public:
+    FileLock(int fd, int operation)
+        : fd(fd)
+    {
+        int ret = 0;
+        while ((ret = flock(fd, operation)) != 0 && errno == EINTR) { }
+        locked = ret == 0;
+    }
+    ~FileLock()
+    {
+        if (locked)
+            flock(fd, LOCK_UN);
+    }
+    // false if LOCK_NB is given and another process holds the lock
+    bool isLocked() const { return locked; }
+
+private:
+    const int fd;
+    bool locked { false };
+};
+}   // namespace
+
+ThumbnailPack::ThumbnailPack(const QString &fileName)
+    : fileName(fileName)
+{
+    QMutexLocker lk(&mutex);
+    open();
+}
+
+ThumbnailPack::~ThumbnailPack()
+{
+    QMutexLocker lk(&mutex);
+    close();
+}
+
+/*!
+ * \brief ThumbnailPack::pack The pack of the directory, the last used packs are kept open.
+ */
+QSharedPointer<ThumbnailPack> ThumbnailPack::pack(const QString &dirPath, int size)
+{
+    static QMutex packsMutex;
+    static QList<QSharedPointer<ThumbnailPack>> packs;   // the last used first
+
+    const QString &name = packFileName(dirPath, size);
+    QMutexLocker lk(&packsMutex);
+    for (int i = 0; i < packs.size(); ++i) {
+        if (packs.at(i)->fileName == name) {
+            if (i > 0)
+                packs.move(i, 0);
+            return packs.first();
+        }
+    }
+
+    // a pack that can not be opened is kept too, so it is not opened again for every icon
+    QSharedPointer<ThumbnailPack> pack(new ThumbnailPack(name));
+    packs.prepend(pack);
+    if (packs.size() > kMaxOpenPacks)
+        packs.removeLast();
+
+    // the files removed since the pack was written
+    QtConcurrent::run([pack, dirPath]() {
+        QSet<quint64> inodes;
+        if (dirInodes(dirPath, &inodes))
+            pack->removeMissing(inodes);
+    });
+
+    static QElapsedTimer trimTimer;
+    if (!trimTimer.isValid() || trimTimer.elapsed() > kTrimInterval) {
+        trimTimer.start();
+        QStringList openFiles;
+        for (const auto &openPack : packs)
+            openFiles.append(openPack->fileName);
+        QtConcurrent::run([openFiles]() { trimPacks(packDir(), kMaxCacheSize, openFiles); });
+    }
+
+    return pack;
+}
+
+QString ThumbnailPack::packFileName(const QString &dirPath, int size)
+{
+    const QByteArray &hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QString("%1/%2-%3.pack").arg(packDir(), QString::fromLatin1(hash)).arg(size);
+}
+
+/*!
+ * \brief ThumbnailPack::trimPacks Remove the packs not used for the longest time until all of them fit in maxSize,
+ * a pack is touched when it is opened. The other processes create a new pack when they notice.
+ * \param keepFiles the packs in use
+ */
+void ThumbnailPack::trimPacks(const QString &packDirPath, qint64 maxSize, const QStringList &keepFiles)
+{
+    // the oldest first
+    const QFileInfoList &packFiles = QDir(packDirPath).entryInfoList({ "*.pack" }, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 totalSize = 0;
+    for (const QFileInfo &info : packFiles)
+        totalSize += info.size();
+
+    for (const QFileInfo &info : packFiles) {
+        if (totalSize <= maxSize)
+            break;
+        if (keepFiles.contains(info.absoluteFilePath()))
+            continue;
+
+        if (QFile::remove(info.absoluteFilePath())) {
+            qInfo() << "remove thumbnail pack:" << info.fileName() << "size:" << info.size();
+            totalSize -= info.size();
+        }
+    }
+}
+
+bool ThumbnailPack::isValid() const
+{
+    QMutexLocker lk(&mutex);
+    return fd >= 0;
+}
+
+int ThumbnailPack::count() const
+{
+    QMutexLocker lk(&mutex);
+    return entries.count();
+}
+
+/*!
+ * \brief ThumbnailPack::image The thumbnail of the file if it is in the pack and not older than the file.
+ * The image owns its pixels, the pack may be remapped after.
+ */
+QImage ThumbnailPack::image(quint64 inode, qint64 mtime)
+{
+    QMutexLocker lk(&mutex);
+    if (fd < 0) {
+        // another process was initializing or compacting the pack, open it again without waiting
+        if (!busy || !writeMutex.tryLock())
+            return QImage();
+        open();
+        writeMutex.unlock();
+        if (fd < 0)
+            return QImage();
+    }
+
+    auto it = entries.constFind(inode);
+    if (it == entries.constEnd() || it->mtime != mtime) {
+        // may be appended by another process
+        refresh();
+        it = entries.constFind(inode);
+        if (it == entries.constEnd() || it->mtime != mtime)
+            return QImage();
+    }
+
+    const Entry &entry = it.value();
+    if (entry.offset + pixelsSize(entry.width, entry.height) > mappedSize && !remap(end))
+        return QImage();
+
+    const QImage image(mapped + entry.offset, entry.width, entry.height, entry.width * 4,
+                       QImage::Format_ARGB32_Premultiplied);
+    return image.copy();
+}
+
+/*!
+ * \brief ThumbnailPack::insert Append the thumbnail of the file, the older one of the same inode becomes stale.
+ */
+bool ThumbnailPack::insert(quint64 inode, qint64 mtime, const QImage &image)
+{
+    if (inode == 0 || image.isNull() || image.width() > kMaxEdge || image.height() > kMaxEdge)
+        return false;
+
+    const QImage &pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int width = pixels.width();
+    const int height = pixels.height();
+    const qint64 size = recordSize(width, height);
+
+    QByteArray record(static_cast<int>(size), '\0');
+    RecordHeader header { inode, mtime, static_cast<quint16>(width), static_cast<quint16>(height), 0 };
+    memcpy(record.data(), &header, sizeof(header));
+    for (int y = 0; y < height; ++y)
+        memcpy(record.data() + sizeof(header) + y * width * 4, pixels.constScanLine(y), static_cast<size_t>(width * 4));
+
+    QMutexLocker writeLocker(&writeMutex);
+    bool written = false;
+    bool needCompact = false;
+    // the pack may be replaced by the compaction of another process while waiting for the lock
+    for (int retry = 0; retry < 2; ++retry) {
+        if (fd < 0 || isReplaced()) {
+            QMutexLocker lk(&mutex);
+            close();
+            if (!open())
+                return false;
+        }
+
+        // only the writers wait for the lock, the readers keep reading the mapped records
+        FileLock lock(fd, LOCK_EX);
+        if (isReplaced())
+            continue;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            return false;
+
+        qint64 offset = 0;
+        Entry old;
+        {
+            QMutexLocker lk(&mutex);
+            if (st.st_size > end && remap(st.st_size))
+                scan(st.st_size);
+
+            auto it = entries.constFind(inode);
+            if (it != entries.constEnd() && it->mtime == mtime)
+                return true;
+            if (it != entries.constEnd())
+                old = it.value();
+            offset = end;
+        }
+
+        // the rest of a large directory is read from the pngs
+        if (offset + size > kMaxPackSize)
+            return false;
+
+        // the rest of a writer that crashed
+        if (st.st_size > offset && ftruncate(fd, offset) != 0)
+            return false;
+
+        if (pwrite(fd, record.constData(), static_cast<size_t>(size), offset) != size) {
+            qWarning() << "write thumbnail pack failed:" << fileName << strerror(errno);
+            if (ftruncate(fd, offset) != 0)
+                qWarning() << "truncate thumbnail pack failed:" << fileName;
+            return false;
+        }
+
+        QMutexLocker lk(&mutex);
+        if (old.offset > 0)
+            staleSize += recordSize(old.width, old.height);
+        entries.insert(inode, Entry { mtime, offset + static_cast<qint64>(sizeof(RecordHeader)),
+                                      static_cast<quint16>(width), static_cast<quint16>(height) });
+        end = offset + size;
+        written = true;
+        needCompact = staleSize > kCompactSize && staleSize * 2 > end;
+        break;
+    }
+
+    if (needCompact)
+        compact();
+    return written;
+}
+
+/*!
+ * \brief ThumbnailPack::removeMissing Drop the records of the files that are not in the directory any more,
+ * they are removed from the file by the compaction.
+ * \param inodes the inodes of the files in the directory
+ */
+void ThumbnailPack::removeMissing(const QSet<quint64> &inodes)
+{
+    QMutexLocker writeLocker(&writeMutex);
+    bool needCompact = false;
+    {
+        QMutexLocker lk(&mutex);
+        if (fd < 0)
+            return;
+
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (inodes.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            staleSize += recordSize(it->width, it->height);
+            it = entries.erase(it);
+        }
+        needCompact = staleSize > kCompactSize && staleSize * 2 > end;
+    }
+
+    if (needCompact)
+        compact();
+}
+
+/*!
+ * \brief ThumbnailPack::open Open and index the pack, it is called on the paint path by pack() and image().
+ * The flock is never waited for, another process may hold it while compacting a large pack. If the pack
+ * is busy, it stays closed and is opened again by the next image().
+ * The writeMutex must be locked, or the pack is being constructed.
+ */
+bool ThumbnailPack::open()
+{
+    busy = false;
+    fd = ::open(fileName.toLocal8Bit().constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        qWarning() << "open thumbnail pack failed:" << fileName << strerror(errno);
+        return false;
+    }
+
+    bool initialized = false;
+    bool ok = false;
+    {
+        // a writer of another process holds the lock only while appending a record
+        FileLock lock(fd, LOCK_SH | LOCK_NB);
+        struct stat st;
+        if (!lock.isLocked()) {
+            busy = true;
+        } else if (fstat(fd, &st) == 0 && hasPackHeader(fd, st.st_size)) {
+            initialized = true;
+            end = sizeof(PackHeader);
+            ok = remap(st.st_size);
+            if (ok)
+                scan(st.st_size);
+        }
+    }
+
+    if (!initialized && !busy) {
+        FileLock lock(fd, LOCK_EX | LOCK_NB);
+        struct stat st;
+        if (!lock.isLocked()) {
+            busy = true;
+        } else if (fstat(fd, &st) == 0) {
+            qint64 fileSize = st.st_size;
+            // may be written by another process since the check
+            ok = hasPackHeader(fd, fileSize);
+            if (!ok) {
+                // a new pack, or a broken one that nobody can read, start again
+                PackHeader header;
+                memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+                header.version = kPackVersion;
+                header.reserved = 0;
+                fileSize = sizeof(header);
+                ok = ftruncate(fd, 0) == 0 && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+            }
+
+            end = sizeof(PackHeader);
+            ok = ok && remap(fileSize);
+            if (ok)
+                scan(fileSize);
+        }
+    }
+
+    // the packs not used for the longest time are removed first
+    if (ok)
+        futimens(fd, nullptr);
+    else
+        close();
+    return ok;
+}
+
+void ThumbnailPack::close()
+{
+    if (mapped)
+        munmap(mapped, static_cast<size_t>(mappedSize));
+    mapped = nullptr;
+    mappedSize = 0;
+
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+
+    end = 0;
+    staleSize = 0;
+    entries.clear();
+}
+
+void ThumbnailPack::refresh()
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= end)
+        return;
+
+    // a writer of this process takes the flock of the same open file, which must not be converted,
+    // the records it writes are scanned after it finished
+    if (!writeMutex.tryLock())
+        return;
+
+    {
+        // the record a writer of another process is writing is not complete, it is not waited for,
+        // the new records are read by the next refresh and the thumbnail is read from the png meanwhile
+        FileLock lock(fd, LOCK_SH | LOCK_NB);
+        if (lock.isLocked() && fstat(fd, &st) == 0 && remap(st.st_size))
+            scan(st.st_size);
+    }
+    writeMutex.unlock();
+}
+
+/*!
+ * \brief ThumbnailPack::scan Index the records after the end, it stops at a record which is not complete.
+ * The file must be mapped to fileSize.
+ */
+void ThumbnailPack::scan(qint64 fileSize)
+{
+    while (end + static_cast<qint64>(sizeof(RecordHeader)) <= fileSize) {
+        RecordHeader header;
+        memcpy(&header, mapped + end, sizeof(header));
+        if (header.width == 0 || header.height == 0 || header.width > kMaxEdge || header.height > kMaxEdge)
+            break;
+
+        const qint64 size = recordSize(header.width, header.height);
+        if (end + size > fileSize)
+            break;
+
+        auto it = entries.find(header.inode);
+        if (it != entries.end())
+            staleSize += recordSize(it->width, it->height);
+        entries.insert(header.inode, Entry { header.mtime, end + static_cast<qint64>(sizeof(RecordHeader)),
+                                             header.width, header.height });
+        end += size;
+    }
+}
+
+bool ThumbnailPack::remap(qint64 size)
+{
+    if (size <= mappedSize)
+        return true;
+
+    if (mapped)
+        munmap(mapped, static_cast<size_t>(mappedSize));
+    mapped = nullptr;
+    mappedSize = 0;
+
+    void *addr = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        qWarning() << "map thumbnail pack failed:" << fileName << strerror(errno);
+        return false;
+    }
+
+    mapped = static_cast<uchar *>(addr);
+    mappedSize = size;
+    return true;
+}
+
+bool ThumbnailPack::isReplaced() const
+{
+    struct stat fileStat;
+    struct stat fdStat;
+    if (stat(fileName.toLocal8Bit().constData(), &fileStat) != 0 || fstat(fd, &fdStat) != 0)
+        return true;
+    return fileStat.st_dev != fdStat.st_dev || fileStat.st_ino != fdStat.st_ino;
+}
+
+/*!
+ * \brief ThumbnailPack::compact Write the live records to a new pack and replace the old one by renaming,
+ * the processes that mapped the old pack can still read it until they notice.
+ * The records are read by the file instead of the mapping, so the readers keep the mutex meanwhile.
+ * The writeMutex must be locked.
+ */
+bool ThumbnailPack::compact()
+{
+    {
+        FileLock lock(fd, LOCK_EX);
+        if (isReplaced())
+            return false;
+
+        // the records of the others, and the last ones of this process which are not mapped yet
+        QHash<quint64, Entry> liveEntries;
+        {
+            QMutexLocker lk(&mutex);
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > end && remap(st.st_size))
+                scan(st.st_size);
+            liveEntries = entries;
+        }
+
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        PackHeader header;
+        memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+        header.version = kPackVersion;
+        header.reserved = 0;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        QByteArray pixels;
+        for (auto it = liveEntries.constBegin(); it != liveEntries.constEnd(); ++it) {
+            const Entry &entry = it.value();
+            const qint64 size = recordSize(entry.width, entry.height) - static_cast<qint64>(sizeof(RecordHeader));
+            pixels.resize(static_cast<int>(size));
+            if (pread(fd, pixels.data(), static_cast<size_t>(size), entry.offset) != size)
+                return false;
+
+            const RecordHeader record { it.key(), entry.mtime, entry.width, entry.height, 0 };
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            file.write(pixels);
+        }
+
+        if (!file.commit()) {
+            qWarning() << "compact thumbnail pack failed:" << fileName << file.errorString();
+            return false;
+        }
+    }
+
+    QMutexLocker lk(&mutex);
+    close();
+    return open();
+}
+
+}
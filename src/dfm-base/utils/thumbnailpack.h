@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILPACK_H
+#define THUMBNAILPACK_H
+
+#include "dfm-base/dfm_base_global.h"
+
+#include <QImage>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QSharedPointer>
+
+namespace dfmbase {
+
+/*!
+ * \class ThumbnailPack
+ * \brief The decoded thumbnails of one directory in one file, so that showing a thumbnail is a copy
+ * of the mapped pixels instead of reading and decoding a png.
+ * A thumbnail is keyed by the inode and the modified time of its file, the records are only appended
+ * under an flock, and the pack is replaced by a compacted copy when most of it is stale, so the mapping
+ * of another process stays valid. The pixels are in the native byte order, the pack is only a local cache
+ * and the pngs of the freedesktop store are still written for the other applications.
+ * A pack is limited in size, the packs not used for the longest time are removed when all of them
+ * exceed the limit of the cache, and the records of the removed files are dropped by the next open.
+ * The writers of a process are serialized by their own mutex, and the readers take the flock without
+ * waiting, so image() on the paint path never waits for a record being written or a pack being compacted,
+ * by this process or another one.
+ */
+class ThumbnailPack
+{
+    Q_DISABLE_COPY(ThumbnailPack)
+
+public:
+    explicit ThumbnailPack(const QString &fileName);
+    ~ThumbnailPack();
+
+    static QSharedPointer<ThumbnailPack> pack(const QString &dirPath, int size);
+    static QString packFileName(const QString &dirPath, int size);
+    static void trimPacks(const QString &packDirPath, qint64 maxSize, const QStringList &keepFiles);
+
+    bool isValid() const;
+    int count() const;
+    QImage image(quint64 inode, qint64 mtime);
+    bool insert(quint64 inode, qint64 mtime, const QImage &image);
+    void removeMissing(const QSet<quint64> &inodes);
+
+private:
+    struct Entry
+    {
+        qint64 mtime { 0 };
+        qint64 offset { 0 };   // the pixels
+        quint16 width { 0 };
+        quint16 height { 0 };
+    };
+
+    bool open();
+    void close();
+    void refresh();
+    void scan(qint64 fileSize);
+    bool remap(qint64 size);
+    bool isReplaced() const;
+    bool compact();
+
+private:
+    const QString fileName;
+    QMutex writeMutex;   // insert and compact, locked before the mutex
+    mutable QMutex mutex;   // the file, the mapping and the entries
+    int fd { -1 };
+    bool busy { false };   // not opened because another process held the flock
+    uchar *mapped { nullptr };
+    qint64 mappedSize { 0 };
+    qint64 end { 0 };   // the end of the last complete record
+    qint64 staleSize { 0 };
+    QHash<quint64, Entry> entries;
+};
+
+}
+
+#endif   // THUMBNAILPACK_H
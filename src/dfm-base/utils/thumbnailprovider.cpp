@@ -4,6 +4,7 @@
 
 #include "thumbnailprovider.h"
 #include "videothumbnailprovider.h"
+#include "thumbnailpack.h"
 
 #include "dfm-base/mimetype/dmimedatabase.h"
 #include "dfm-base/mimetype/mimetypedisplaymanager.h"
@@ -255,6 +256,17 @@ QPixmap ThumbnailProvider::thumbnailPixmap(const QUrl &fileUrl, Size size) const
         return absoluteFilePath;
     }
 
+    // the decoded thumbnails of the directory first
+    const quint64 inode = fileInfo->extendAttributes(ExtInfoType::kInode).toULongLong();
+    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
+    QSharedPointer<ThumbnailPack> pack;
+    if (inode != 0) {
+        pack = ThumbnailPack::pack(absolutePath, size);
+        const QImage &packed = pack->image(inode, fileModify);
+        if (!packed.isNull())
+            return QPixmap::fromImage(packed);
+    }
+
     const QString thumbnailName = dataToMd5Hex((QUrl::fromLocalFile(absoluteFilePath).toString(QUrl::FullyEncoded)).toLocal8Bit()) + kFormat;
     QString thumbnail = DFMIO::DFMUtils::buildFilePath(d->sizeToFilePath(size).toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
     if (!DFMIO::DFile(thumbnail).exists()) {
@@ -269,13 +281,16 @@ QPixmap ThumbnailProvider::thumbnailPixmap(const QUrl &fileUrl, Size size) const
     ir.setAutoDetectImageFormat(false);
 
     const QImage image = ir.read();
-    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
     if (!image.isNull() && image.text(QT_STRINGIFY(Thumb::MTime)).toInt() != static_cast<int>(fileModify)) {
         DecoratorFileOperator(thumbnail).deleteFile();
 
         return QPixmap();
     }
 
+    // a png made by another application, it is decoded only once
+    if (pack && !image.isNull())
+        QtConcurrent::run([pack, inode, fileModify, image]() { pack->insert(inode, fileModify, image); });
+
     return QPixmap::fromImage(image);
 }
 
@@ -319,6 +334,22 @@ QString ThumbnailProvider::createThumbnail(const QUrl &url, ThumbnailProvider::S
     QString thumbnail = DFMIO::DFMUtils::buildFilePath(StandardPaths::location(StandardPaths::kThumbnailFailPath).toStdString().c_str(),
                                                        thumbnailName.toStdString().c_str(), nullptr);
 
+    // the view requests the thumbnails ahead of painting, one made already is only packed,
+    // so it is decoded here rather than in the main thread
+    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
+    const quint64 inode = fileInfo->extendAttributes(ExtInfoType::kInode).toULongLong();
+    const QString &madeThumbnail = DFMIO::DFMUtils::buildFilePath(d->sizeToFilePath(size).toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
+    QImageReader reader(madeThumbnail, QByteArray(kFormat).mid(1));
+    reader.setAutoDetectImageFormat(false);
+    if (reader.canRead() && reader.text(QT_STRINGIFY(Thumb::MTime)).toInt() == static_cast<int>(fileModify)) {
+        if (inode != 0) {
+            const QSharedPointer<ThumbnailPack> &pack = ThumbnailPack::pack(DirPath, size);
+            if (pack->image(inode, fileModify).isNull())
+                pack->insert(inode, fileModify, reader.read());
+        }
+        return madeThumbnail;
+    }
+
     QMimeType mime = d->mimeDatabase.mimeTypeForFile(url);
     QScopedPointer<QImage> image(new QImage());
 
@@ -351,7 +382,6 @@ QString ThumbnailProvider::createThumbnail(const QUrl &url, ThumbnailProvider::S
     }
 
     image->setText(QT_STRINGIFY(Thumb::URL), fileUrl);
-    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).value<qint64>();
     image->setText(QT_STRINGIFY(Thumb::MTime), QString::number(fileModify));
 
     // create path
@@ -362,6 +392,8 @@ QString ThumbnailProvider::createThumbnail(const QUrl &url, ThumbnailProvider::S
     }
 
     if (d->errorString.isEmpty()) {
+        if (inode != 0)
+            ThumbnailPack::pack(DirPath, size)->insert(inode, fileModify, *image);
         return thumbnail;
     }
 
@@ -4,6 +4,10 @@
 
 #include <dfm-framework/event/event.h>
 
+#include <QHash>
+#include <QThread>
+#include <QCoreApplication>
+
 DPF_BEGIN_NAMESPACE
 class EventPrivate
 {
@@ -16,6 +20,10 @@ public:
         { EventStratege::kSlot, {} },
         { EventStratege::kHook, {} }
     };
+    // the types of EventHandle, by the hash of "space:topic"
+    QHash<EventTopicId, EventType> topicIdMap;
+    // activate the plugin of the space when one of its slots is used first
+    QHash<QString, std::function<void()>> activatorMap;
 };
 
 DPF_END_NAMESPACE
@@ -49,13 +57,23 @@ EventChannelManager *Event::channel()
 void Event::registerEventType(EventStratege stratege, const QString &space, const QString &topic)
 {
     QString key { space + ":" + topic };
+    QWriteLocker guard(&d->rwLock);
     if (Q_UNLIKELY(d->eventsMap[stratege].contains(key))) {
         qWarning() << "Register repeat event: " << key;
         return;
     }
 
-    QWriteLocker guard(&d->rwLock);
-    d->eventsMap[stratege].insert(key, genCustomEventId());
+    const EventType type { genCustomEventId() };
+    d->eventsMap[stratege].insert(key, type);
+
+    const EventTopicId id { eventTopicIdHash(key.toUtf8().constData()) };
+    if (Q_UNLIKELY(d->topicIdMap.contains(id))) {
+        // never dispatch to a wrong event, the handles of both events are invalid
+        qWarning() << "Event topic id conflict: " << key;
+        d->topicIdMap.insert(id, EventTypeScope::kInValid);
+        return;
+    }
+    d->topicIdMap.insert(id, type);
 }
 
 EventType Event::eventType(const QString &space, const QString &topic)
@@ -74,7 +92,54 @@ EventType Event::eventType(const QString &space, const QString &topic)
     QString key { space + ":" + topic };
 
     QReadLocker guard(&d->rwLock);
-    return d->eventsMap[stratege].contains(key) ? d->eventsMap[stratege].value(key) : EventTypeScope::kInValid;
+    const EventType type { d->eventsMap[stratege].value(key, EventTypeScope::kInValid) };
+    if (Q_LIKELY(type != EventTypeScope::kInValid) || stratege != EventStratege::kSlot || d->activatorMap.isEmpty())
+        return type;
+
+    guard.unlock();
+    return activate(space, topic);
+}
+
+EventType Event::eventType(EventTopicId id)
+{
+    QReadLocker guard(&d->rwLock);
+    return d->topicIdMap.value(id, EventTypeScope::kInValid);
+}
+
+/*!
+ * \brief Event::registerActivator The activator is called once in the main thread
+ * when a slot of the space is used and the slot is not registered,
+ * the plugin of the space can be loaded by it when it is used first.
+ */
+void Event::registerActivator(const QString &space, const std::function<void()> &activator)
+{
+    Q_ASSERT(activator);
+    QWriteLocker guard(&d->rwLock);
+    d->activatorMap.insert(space, activator);
+}
+
+EventType Event::activate(const QString &space, const QString &topic)
+{
+    std::function<void()> activator;
+    {
+        QWriteLocker guard(&d->rwLock);
+        activator = d->activatorMap.take(space);
+    }
+
+    if (!activator)
+        return EventTypeScope::kInValid;
+
+    // plugins are only loaded in the main thread, the slot is available after that
+    if (!qApp || QThread::currentThread() != qApp->thread()) {
+        qWarning() << "Activate" << space << "from other thread, the event is invalid before activated:" << topic;
+        if (qApp)
+            QMetaObject::invokeMethod(qApp, activator, Qt::QueuedConnection);
+        return EventTypeScope::kInValid;
+    }
+
+    qInfo() << "Activate" << space << "by" << topic;
+    activator();
+    return eventType(space, topic);
 }
 
 QStringList Event::pluginTopics(const QString &space)
@@ -106,4 +171,7 @@ Event::Event()
     EventConverter::registerConverter([this](const QString &space, const QString &topic) {
         return eventType(space, topic);
     });
+    EventConverter::registerIdConverter([this](EventTopicId id) {
+        return eventType(id);
+    });
 }
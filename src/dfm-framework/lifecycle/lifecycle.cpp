@@ -40,6 +40,19 @@ void initialize(const QStringList &IIDs, const QStringList &paths, const QString
     initialize(IIDs, paths, blackNames);
 }
 
+/*!
+ * \brief LifeCycle::initialize
+ * \param onDemandNames the plugins are not loaded at startup, each of them is loaded
+ * when a slot of its event space is pushed first, see PluginManager::addOnDemandPluginName
+ */
+void initialize(const QStringList &IIDs, const QStringList &paths, const QStringList &blackNames,
+                const QStringList &lazyNames, const QStringList &onDemandNames)
+{
+    for (const QString &name : onDemandNames)
+        pluginManager->addOnDemandPluginName(name);
+    initialize(IIDs, paths, blackNames, lazyNames);
+}
+
 /*!
  * \brief LifeCycle::pluginIIDs Get plugin identity
  * \return all id list
@@ -68,6 +81,11 @@ QStringList lazyLoadList()
     return pluginManager->lazyLoadList();
 }
 
+QStringList onDemandList()
+{
+    return pluginManager->onDemandList();
+}
+
 PluginMetaObjectPointer pluginMetaObj(const QString &pluginName,
                                       const QString version)
 {
@@ -47,6 +47,18 @@ void PluginManager::addLazyLoadPluginName(const QString &name)
         d->lazyLoadPluginsNames.push_back(name);
 }
 
+/*!
+ * \brief addOnDemandPluginName 添加按需加载的插件
+ * \details 插件不在启动时加载，在首次调用其事件空间中的 slot 时于主线程加载，
+ *  事件空间为插件名称中的 '-' 替换为 '_'
+ * \param name 插件名称
+ */
+void PluginManager::addOnDemandPluginName(const QString &name)
+{
+    if (!d->onDemandPluginNames.contains(name))
+        d->onDemandPluginNames.push_back(name);
+}
+
 /*!
  * \brief setPluginPaths 设置插件加载的路径
  * \param const QStringList &pluginPaths 传入路径列表
@@ -182,3 +194,8 @@ QStringList PluginManager::lazyLoadList() const
 {
     return d->lazyLoadPluginsNames;
 }
+
+QStringList PluginManager::onDemandList() const
+{
+    return d->onDemandPluginNames;
+}
@@ -9,6 +9,7 @@
 #include <dfm-framework/lifecycle/plugin.h>
 #include <dfm-framework/lifecycle/plugincreator.h>
 #include <dfm-framework/log/codetimecheck.h>
+#include <dfm-framework/event/event.h>
 
 DPF_BEGIN_NAMESPACE
 
@@ -37,24 +38,27 @@ PluginMetaObjectPointer PluginManagerPrivate::pluginMetaObj(const QString &name,
                                                             const QString &version)
 {
     dpfCheckTimeBegin();
+    PluginMetaObjectPointer result(nullptr);
     int size = readQueue.size();
     int idx = 0;
     while (idx < size) {
         if (!version.isEmpty()) {
             if (readQueue[idx]->d->version == version
                 && readQueue[idx]->d->name == name) {
-                return readQueue[idx];
+                result = readQueue[idx];
+                break;
             }
         } else {
             if (readQueue[idx]->d->name == name) {
-                return readQueue[idx];
+                result = readQueue[idx];
+                break;
             }
         }
         idx++;
     }
-    dpfCheckTimeBegin();
+    dpfCheckTimeEnd();
 
-    return PluginMetaObjectPointer(nullptr);
+    return result;
 }
 
 /*!
@@ -122,12 +126,20 @@ bool PluginManagerPrivate::readPlugins()
 
     scanfAllPlugin(&readQueue, pluginLoadPaths, pluginLoadIIDs, blackPlguinNames);
     qInfo() << "Lazy load plugin names: " << lazyLoadPluginsNames;
-    std::for_each(readQueue.begin(), readQueue.end(), [this](PluginMetaObjectPointer obj) {
+    qInfo() << "On demand plugin names: " << onDemandPluginNames;
+    // 元数据互不相关，并行解析
+    QtConcurrent::blockingMap(readQueue, [](PluginMetaObjectPointer obj) {
         readJsonToMeta(obj);
-        if (!lazyLoadPluginsNames.contains(obj->name()))
+    });
+    std::for_each(readQueue.begin(), readQueue.end(), [this](PluginMetaObjectPointer obj) {
+        if (onDemandPluginNames.contains(obj->name())) {
+            qInfo() << "Load on demand: " << obj->name();
+            registerActivator(obj);
+        } else if (!lazyLoadPluginsNames.contains(obj->name())) {
             notLazyLoadQuene.append(obj);
-        else
+        } else {
             qInfo() << "Skip load: " << obj->name();
+        }
     });
 
 #ifdef QT_DEBUG
@@ -309,12 +321,16 @@ bool PluginManagerPrivate::loadPlugins()
     dpfCheckTimeBegin();
 
     dependsSort(&loadQueue, &notLazyLoadQuene);
+    openLibraries(loadQueue);
 
+    // 插件实例在主线程按依赖顺序创建
     bool ret = true;
-    std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
-        if (!PluginManagerPrivate::doLoadPlugin(pointer))
+    for (const PluginMetaObjectPointer &pointer : loadQueue) {
+        dpfCheckTimeBeginTag(pointer->name());
+        if (!doLoadPlugin(pointer))
             ret = false;
-    });
+        dpfCheckTimeEndTag(pointer->name());
+    }
 
     dpfCheckTimeEnd();
     return ret;
@@ -328,10 +344,12 @@ bool PluginManagerPrivate::initPlugins()
     dpfCheckTimeBegin();
 
     bool ret = true;
-    std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
-        if (!PluginManagerPrivate::doInitPlugin(pointer))
+    for (const PluginMetaObjectPointer &pointer : loadQueue) {
+        dpfCheckTimeBeginTag(pointer->name());
+        if (!doInitPlugin(pointer))
             ret = false;
-    });
+        dpfCheckTimeEndTag(pointer->name());
+    }
 
     emit Listener::instance()->pluginsInitialized();
     allPluginsInitialized = true;
@@ -348,15 +366,21 @@ bool PluginManagerPrivate::startPlugins()
     dpfCheckTimeBegin();
 
     bool ret = true;
-    std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
-        if (!PluginManagerPrivate::doStartPlugin(pointer))
+    for (const PluginMetaObjectPointer &pointer : loadQueue) {
+        dpfCheckTimeBeginTag(pointer->name());
+        if (!doStartPlugin(pointer))
             ret = false;
-    });
+        dpfCheckTimeEndTag(pointer->name());
+    }
 
     emit Listener::instance()->pluginsStarted();
     allPluginsStarted = true;
     dpfCheckTimeEnd();
 
+    const QString &timeline { dpfCheckTimeline() };
+    if (!timeline.isEmpty())
+        qInfo().noquote() << timeline;
+
     return ret;
 }
 
@@ -418,6 +442,86 @@ void PluginManagerPrivate::dependsSort(QQueue<PluginMetaObjectPointer> *dstQueue
     dpfCheckTimeEnd();
 }
 
+/*!
+ * \brief 按依赖分层，每层插件的依赖都在之前的层中
+ * \param sortedQueue 已按依赖排序的队列
+ */
+QList<QList<PluginMetaObjectPointer>> PluginManagerPrivate::dependsLevels(const QQueue<PluginMetaObjectPointer> &sortedQueue)
+{
+    QList<QList<PluginMetaObjectPointer>> levels;
+    QHash<QString, int> levelOfPlugin;
+
+    for (const PluginMetaObjectPointer &ptr : sortedQueue) {
+        int level = 0;
+        for (const PluginDepend &depend : ptr->depends()) {
+            // 排序失败时依赖可能在之后，放入下一层
+            if (levelOfPlugin.contains(depend.name()))
+                level = qMax(level, levelOfPlugin.value(depend.name()) + 1);
+        }
+
+        levelOfPlugin.insert(ptr->name(), level);
+        while (levels.count() <= level)
+            levels.append({});
+        levels[level].append(ptr);
+    }
+
+    return levels;
+}
+
+/*!
+ * \brief 按依赖分层并行打开插件动态库，之后的 doLoadPlugin 只需创建实例
+ *  打开失败的插件由 doLoadPlugin 再次加载并报告错误
+ * \param sortedQueue 已按依赖排序的队列
+ */
+void PluginManagerPrivate::openLibraries(const QQueue<PluginMetaObjectPointer> &sortedQueue)
+{
+    dpfCheckTimeBegin();
+
+    for (const auto &level : dependsLevels(sortedQueue)) {
+        // 虚拟插件共用一个动态库，只打开一次
+        QStringList fileNames;
+        QList<PluginMetaObjectPointer> libraries;
+        for (const PluginMetaObjectPointer &ptr : level) {
+            if (fileNames.contains(ptr->fileName()))
+                continue;
+            fileNames.append(ptr->fileName());
+            libraries.append(ptr);
+        }
+
+        QtConcurrent::blockingMap(libraries, &PluginManagerPrivate::openLibrary);
+    }
+
+    dpfCheckTimeEnd();
+}
+
+void PluginManagerPrivate::openLibrary(PluginMetaObjectPointer pointer)
+{
+    dpfCheckTimeBeginTag(pointer->name());
+    if (!pointer->d->loader->load())
+        qWarning() << "Failed open plugin library: " << pointer->fileName() << pointer->d->loader->errorString();
+    dpfCheckTimeEndTag(pointer->name());
+}
+
+/*!
+ * \brief 按需加载的插件在首次调用其 slot 时加载
+ * \param pointer
+ */
+void PluginManagerPrivate::registerActivator(PluginMetaObjectPointer pointer)
+{
+    const QString &space { QString(pointer->name()).replace('-', '_') };
+    dpfEvent->registerActivator(space, [this, pointer]() {
+        activatePlugin(pointer);
+    });
+}
+
+void PluginManagerPrivate::activatePlugin(PluginMetaObjectPointer pointer)
+{
+    dpfCheckTimeBeginTag(pointer->name());
+    bool ret = loadPlugin(pointer) && initPlugin(pointer) && startPlugin(pointer);
+    dpfCheckTimeEndTag(pointer->name());
+    qInfo() << "Load on demand plugin:" << pointer->name() << "result:" << ret;
+}
+
 bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
 {
     Q_ASSERT(pointer);
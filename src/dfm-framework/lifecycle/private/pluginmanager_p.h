@@ -33,6 +33,7 @@ class PluginManagerPrivate : public QSharedData
     QStringList pluginLoadPaths;
     QStringList blackPlguinNames;
     QStringList lazyLoadPluginsNames;
+    QStringList onDemandPluginNames;
     QStringList loadedVirtualPlugins;
     QStringList unloadedVirtualPlugins;
     QQueue<PluginMetaObjectPointer> readQueue;
@@ -69,8 +70,13 @@ public:
     static void jsonToMeta(PluginMetaObjectPointer metaObject, const QJsonObject &metaData);
     static void dependsSort(QQueue<PluginMetaObjectPointer> *dstQueue,
                             const QQueue<PluginMetaObjectPointer> *srcQueue);
+    static QList<QList<PluginMetaObjectPointer>> dependsLevels(const QQueue<PluginMetaObjectPointer> &sortedQueue);
+    static void openLibraries(const QQueue<PluginMetaObjectPointer> &sortedQueue);
+    static void openLibrary(PluginMetaObjectPointer pointer);
 
 private:
+    void registerActivator(PluginMetaObjectPointer pointer);
+    void activatePlugin(PluginMetaObjectPointer pointer);
     bool doLoadPlugin(PluginMetaObjectPointer pointer);
     bool doInitPlugin(PluginMetaObjectPointer pointer);
     bool doStartPlugin(PluginMetaObjectPointer pointer);
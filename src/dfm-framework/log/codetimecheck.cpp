@@ -18,8 +18,12 @@
 #    include <QDate>
 #    include <QDir>
 #    include <QtConcurrent>
+#    include <QElapsedTimer>
+#    include <QThread>
 #    include <unistd.h>
 
+#    include <atomic>
+
 DPF_BEGIN_NAMESPACE
 
 namespace GlobalPrivate {
@@ -131,6 +135,79 @@ static void outCheck(const QMessageLogContext &context, const QString &msg)
     file()->close();
 }
 
+// 启动时间线，记录从进程启动到调用 timeline() 之间完成的检查点
+struct TimelineSpan
+{
+    QString name;
+    quintptr thread;
+    qint64 begin;
+    qint64 cost;
+};
+
+static std::atomic_bool kTimelineEnabled { true };
+
+static QElapsedTimer *timelineClock()
+{
+    static QElapsedTimer clock;
+    return &clock;
+}
+
+static QList<TimelineSpan> *timelineSpans()
+{
+    static QList<TimelineSpan> spans;
+    return &spans;
+}
+
+static QMutex *timelineMutex()
+{
+    static QMutex m;
+    return &m;
+}
+
+static qint64 timelineNow()
+{
+    QMutexLocker lock(timelineMutex());
+    if (!timelineClock()->isValid())
+        timelineClock()->start();
+    return timelineClock()->nsecsElapsed();
+}
+
+// 每个线程未结束的检查点
+static thread_local QList<QPair<QString, qint64>> kOpenSpans;
+
+static QString spanName(const QMessageLogContext &context, const QString &tag)
+{
+    return tag.isEmpty() ? QString(context.function) : QString(context.function) + ": " + tag;
+}
+
+static void timelineBegin(const QString &name)
+{
+    if (!kTimelineEnabled)
+        return;
+
+    kOpenSpans.append({ name, timelineNow() });
+}
+
+static void timelineEnd(const QString &name)
+{
+    if (!kTimelineEnabled)
+        return;
+
+    // 未配对的检查点在匹配到外层检查点时丢弃
+    for (int i = kOpenSpans.count() - 1; i >= 0; --i) {
+        if (kOpenSpans.at(i).first != name)
+            continue;
+
+        const qint64 begin { kOpenSpans.at(i).second };
+        const qint64 cost { timelineNow() - begin };
+        kOpenSpans.erase(kOpenSpans.begin() + i, kOpenSpans.end());
+
+        QMutexLocker lock(timelineMutex());
+        timelineSpans()->append({ name, quintptr(QThread::currentThreadId()), begin, cost });
+        return;
+    }
+}
+
 }   // namespace GlobalPrivate
 
 /*!
@@ -165,6 +242,7 @@ uint CodeCheckTime::logCacheDayCount()
  */
 void CodeCheckTime::begin(const QMessageLogContext &context)
 {
+    GlobalPrivate::timelineBegin(GlobalPrivate::spanName(context, {}));
     GlobalPrivate::outCheck(context, "begin");
 }
 
@@ -175,6 +253,60 @@ void CodeCheckTime::begin(const QMessageLogContext &context)
 void CodeCheckTime::end(const QMessageLogContext &context)
 {
     GlobalPrivate::outCheck(context, "end");
+    GlobalPrivate::timelineEnd(GlobalPrivate::spanName(context, {}));
+}
+
+/*!
+ * \brief begin 带标签的检查点-开始，只记录到启动时间线
+ * \param context 日志打印上下文，可参照QMessageLogContext
+ * \param tag 区分同一函数中的多个检查点，如插件名称
+ */
+void CodeCheckTime::begin(const QMessageLogContext &context, const QString &tag)
+{
+    GlobalPrivate::timelineBegin(GlobalPrivate::spanName(context, tag));
+}
+
+/*!
+ * \brief end 带标签的检查点-结束，只记录到启动时间线
+ * \param context 日志打印上下文，可参照QMessageLogContext
+ * \param tag 与 begin 的标签相同
+ */
+void CodeCheckTime::end(const QMessageLogContext &context, const QString &tag)
+{
+    GlobalPrivate::timelineEnd(GlobalPrivate::spanName(context, tag));
+}
+
+/*!
+ * \brief timeline 启动时间线报告，按开始时间排列已完成的检查点
+ *  在主线程调用，调用后停止记录时间线
+ * \return QString 每行为 开始(ms) 耗时(ms) 线程 检查点
+ */
+QString CodeCheckTime::timeline()
+{
+    GlobalPrivate::kTimelineEnabled = false;
+
+    QList<GlobalPrivate::TimelineSpan> spans;
+    {
+        QMutexLocker lock(GlobalPrivate::timelineMutex());
+        spans.swap(*GlobalPrivate::timelineSpans());
+    }
+
+    std::stable_sort(spans.begin(), spans.end(), [](const GlobalPrivate::TimelineSpan &l, const GlobalPrivate::TimelineSpan &r) {
+        return l.begin < r.begin;
+    });
+
+    // called in the main thread after the plugins started
+    const quintptr mainThread { quintptr(QThread::currentThreadId()) };
+    QString report { "Startup timeline (begin ms, cost ms, thread, checkpoint):\n" };
+    for (const auto &span : spans) {
+        report += QString("%1 %2 %3 %4\n")
+                          .arg(span.begin / 1e6, 10, 'f', 2)
+                          .arg(span.cost / 1e6, 10, 'f', 2)
+                          .arg(span.thread == mainThread ? QString("main") : QString::number(span.thread, 16), 14)
+                          .arg(span.name);
+    }
+
+    return report;
 }
 
 #endif   // DPF_NO_CHECK_TIME
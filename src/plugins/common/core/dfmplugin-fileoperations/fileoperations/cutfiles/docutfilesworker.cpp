@@ -151,9 +151,9 @@ bool DoCutFilesWorker::doCutFile(const AbstractFileInfoPointer &fromInfo, const
     bool ok = false;
     AbstractFileInfoPointer toInfo = nullptr;
     if (doRenameFile(fromInfo, targetPathInfo, toInfo, &ok) || ok) {
-        workData->currentWriteSize += fromInfo->size();
+        workData->currentWriteSize.add(fromInfo->size());
         if (fromInfo->isAttributes(OptInfoType::kIsFile)) {
-            workData->currentWriteSize += (fromInfo->size() > 0 ? fromInfo->size() : FileUtils::getMemoryPageSize());
+            workData->currentWriteSize.add(fromInfo->size() > 0 ? fromInfo->size() : FileUtils::getMemoryPageSize());
             if (fromInfo->size() <= 0)
                 workData->zeroOrlinkOrDirWriteSize += FileUtils::getMemoryPageSize();
         } else {
@@ -185,7 +185,7 @@ bool DoCutFilesWorker::doCutFile(const AbstractFileInfoPointer &fromInfo, const
     if (!copyAndDeleteFile(fromInfo, targetPathInfo, toInfo, &result))
         return result;
 
-    workData->currentWriteSize += fromInfo->size();
+    workData->currentWriteSize.add(fromInfo->size());
     return true;
 }
 
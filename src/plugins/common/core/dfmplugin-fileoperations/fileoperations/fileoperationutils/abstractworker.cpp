@@ -183,7 +183,10 @@ bool AbstractWorker::statisticsFilesSize()
         isSourceFileLocal = fsType.startsWith("ext");
     }
 
-    if (isSourceFileLocal) {
+    // 拷贝和剪切不需要文件列表，边统计边执行，其他任务需要完整的文件列表
+    const bool statisticsAsync = jobType == AbstractJobHandler::JobType::kCopyType
+            || jobType == AbstractJobHandler::JobType::kCutType;
+    if (isSourceFileLocal && !statisticsAsync) {
         const SizeInfoPointer &fileSizeInfo = FileOperationsUtils::statisticsFilesSize(sourceUrls, true);
 
         allFilesList = fileSizeInfo->allFiles;
@@ -191,7 +194,11 @@ bool AbstractWorker::statisticsFilesSize()
         workData->dirSize = fileSizeInfo->dirSize;
         sourceFilesCount = fileSizeInfo->fileCount;
     } else {
+        workData->dirSize = FileUtils::getMemoryPageSize();
         statisticsFilesSizeJob.reset(new DFMBASE_NAMESPACE::FileStatisticsJob());
+        // the url of every file is only recorded for the jobs that work on allFilesList
+        if (!statisticsAsync)
+            statisticsFilesSizeJob->setFileHints(DFMBASE_NAMESPACE::FileStatisticsJob::kRecordFileUrls);
         connect(statisticsFilesSizeJob.data(), &DFMBASE_NAMESPACE::FileStatisticsJob::finished,
                 this, &AbstractWorker::onStatisticsFilesSizeFinish, Qt::DirectConnection);
         connect(statisticsFilesSizeJob.data(), &DFMBASE_NAMESPACE::FileStatisticsJob::sizeChanged, this, &AbstractWorker::onStatisticsFilesSizeUpdate, Qt::DirectConnection);
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "blockcopyqueue.h"
+
+#include <QDebug>
+
+#include <cstdlib>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+constexpr quint64 kMaxPooledBuffer { 1024 };   // more than the max in-flight blocks
+constexpr size_t kBufferAlign { 4096 };
+}   // namespace
+
+BlockBufferPool::BlockBufferPool(const std::atomic_int &maxCount)
+    : maxCount(maxCount), freeBuffers(kMaxPooledBuffer)
+{
+}
+
+BlockBufferPool::~BlockBufferPool()
+{
+    Buffer buffer;
+    while (freeBuffers.pop(buffer))
+        free(buffer.data);
+}
+
+/*!
+ * \brief BlockBufferPool::acquire Get a buffer of at least size bytes
+ * \param size size of the block
+ * \return the buffer, data is nullptr if out of memory
+ */
+BlockBufferPool::Buffer BlockBufferPool::acquire(const qint64 size)
+{
+    Buffer buffer;
+    while (freeBuffers.pop(buffer)) {
+        pooledCount--;
+        if (buffer.size >= size)
+            return buffer;
+        // the block size is tuned bigger, the small buffers are useless
+        free(buffer.data);
+    }
+
+    void *data = nullptr;
+    // one more byte as the buffer of the buffered copy
+    const qint64 alignedSize = static_cast<qint64>((static_cast<size_t>(size) + kBufferAlign) / kBufferAlign * kBufferAlign);
+    if (posix_memalign(&data, kBufferAlign, static_cast<size_t>(alignedSize)) != 0) {
+        qWarning() << "alloc block buffer failed, size: " << alignedSize;
+        return Buffer();
+    }
+
+    return Buffer { static_cast<char *>(data), alignedSize };
+}
+
+void BlockBufferPool::release(const Buffer &buffer)
+{
+    if (!buffer.data)
+        return;
+
+    if (pooledCount++ < maxCount && freeBuffers.push(buffer))
+        return;
+
+    pooledCount--;
+    free(buffer.data);
+}
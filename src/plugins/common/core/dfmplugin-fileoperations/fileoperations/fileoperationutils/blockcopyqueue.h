@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BLOCKCOPYQUEUE_H
+#define BLOCKCOPYQUEUE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \class BlockRingQueue
+ * \brief Bounded lock-free queue, any thread can push and pop.
+ * Every cell carries a sequence number telling whether it is ready for the next push or pop,
+ * so a push or pop is one CAS on the position in steady state. The capacity must be a power of two.
+ */
+template<class T>
+class BlockRingQueue
+{
+public:
+    explicit BlockRingQueue(const quint64 capacity)
+        : cells(new Cell[capacity]), mask(capacity - 1)
+    {
+        Q_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        for (quint64 i = 0; i < capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    BlockRingQueue(const BlockRingQueue &) = delete;
+    BlockRingQueue &operator=(const BlockRingQueue &) = delete;
+
+    /*!
+     * \brief push Push the value to the tail
+     * \return false if the queue is full
+     */
+    bool push(const T &value)
+    {
+        Cell *cell = nullptr;
+        quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+        Q_FOREVER {
+            cell = &cells[pos & mask];
+            const quint64 sequence = cell->sequence.load(std::memory_order_acquire);
+            const qint64 diff = static_cast<qint64>(sequence - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief pop Pop the value from the head
+     * \return false if the queue is empty
+     */
+    bool pop(T &value)
+    {
+        Cell *cell = nullptr;
+        quint64 pos = dequeuePos.load(std::memory_order_relaxed);
+        Q_FOREVER {
+            cell = &cells[pos & mask];
+            const quint64 sequence = cell->sequence.load(std::memory_order_acquire);
+            const qint64 diff = static_cast<qint64>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate while other threads are pushing or popping
+    int size() const
+    {
+        const quint64 head = dequeuePos.load(std::memory_order_relaxed);
+        const quint64 tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? static_cast<int>(tail - head) : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<quint64> sequence { 0 };
+        T value {};
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const quint64 mask;
+    alignas(64) std::atomic<quint64> enqueuePos { 0 };
+    alignas(64) std::atomic<quint64> dequeuePos { 0 };
+};
+
+/*!
+ * \class BlockBufferPool
+ * \brief Recycle the aligned block buffers of the external block device copy,
+ * the reader takes a buffer back from the pool instead of allocating one for every block.
+ * At most maxCount buffers are kept, the rest are freed on release.
+ */
+class BlockBufferPool
+{
+public:
+    struct Buffer
+    {
+        char *data { nullptr };
+        qint64 size { 0 };
+    };
+
+    explicit BlockBufferPool(const std::atomic_int &maxCount);
+    ~BlockBufferPool();
+
+    Buffer acquire(const qint64 size);
+    void release(const Buffer &buffer);
+
+private:
+    const std::atomic_int &maxCount;
+    std::atomic_int pooledCount { 0 };
+    BlockRingQueue<Buffer> freeBuffers;
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // BLOCKCOPYQUEUE_H
@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "copyblocktuner.h"
+
+#include "dfm-base/base/application/application.h"
+#include "dfm-base/base/application/settings.h"
+
+#include <QApplication>
+#include <QDebug>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+DFMBASE_USE_NAMESPACE
+
+namespace {
+const char *const kCopyTuningGroup { "CopyBlockTuning" };
+const char *const kBlockSizeKey { "blockSize" };
+const char *const kInFlightBlockKey { "inFlightBlockCount" };
+
+constexpr qint64 kMinBlockSize { 64 * 1024 };
+constexpr qint64 kMaxBlockSize { 16 * 1024 * 1024 };
+constexpr int kMinInFlightBlock { 4 };
+constexpr int kMaxInFlightBlock { 512 };
+constexpr qint64 kMaxInFlightMemory { 512 * 1024 * 1024 };   // bound of block size * in-flight blocks
+constexpr qint64 kMinTuneFileSize { 32 * 1024 * 1024 };   // the speed of small files is dominated by the file count
+constexpr qint64 kSampleInterval { 1000 };   // ms, throughput of every tuning step
+constexpr qint64 kMaxTuneTime { 10 * 1000 };   // ms
+constexpr qint64 kImproveRatio { 105 };   // a step is better if the speed is 5% higher
+}   // namespace
+
+CopyBlockTuner::CopyBlockTuner(const QSharedPointer<WorkerData> &data, const QString &deviceKey)
+    : workData(data), deviceKey(deviceKey)
+{
+    blockSize = workData->copyBlockSize;
+    inFlightBlockCount = workData->inFlightBlockCount;
+    bestValue = blockSize;
+}
+
+/*!
+ * \brief CopyBlockTuner::load Start the job with the values learned by the last job on the same device,
+ * the learned values are only fine tuned
+ */
+void CopyBlockTuner::load()
+{
+    if (deviceKey.isEmpty()) {
+        stage = TuneStage::kFinished;
+        return;
+    }
+
+    const QVariantMap &values = Application::dataPersistence()->value(kCopyTuningGroup, deviceKey).toMap();
+    if (values.isEmpty())
+        return;
+
+    blockSize = qBound(kMinBlockSize, values.value(kBlockSizeKey, blockSize).toLongLong(), kMaxBlockSize);
+    inFlightBlockCount = qBound(kMinInFlightBlock, values.value(kInFlightBlockKey, inFlightBlockCount).toInt(), kMaxInFlightBlock);
+    inFlightBlockCount = static_cast<int>(qMax<qint64>(kMinInFlightBlock, qMin<qint64>(inFlightBlockCount, kMaxInFlightMemory / blockSize)));
+    bestValue = blockSize;
+    apply();
+
+    qDebug() << "copy block tuning loaded, device: " << deviceKey << " block size: " << blockSize
+             << " in-flight blocks: " << inFlightBlockCount;
+}
+
+/*!
+ * \brief CopyBlockTuner::sample Called by the progress timer
+ * \param writtenSize size written by the copy
+ * \param elapsed time elapsed of the job in ms
+ * \param averageFileSize average size of the source files, 0 if they are not counted yet
+ */
+void CopyBlockTuner::sample(const qint64 writtenSize, const qint64 elapsed, const qint64 averageFileSize)
+{
+    if (stage == TuneStage::kFinished)
+        return;
+
+    // the files are not counted yet, only move the sample window
+    if (averageFileSize <= 0) {
+        lastWrittenSize = writtenSize;
+        lastElapsed = elapsed;
+        return;
+    }
+
+    // the speed of many small files does not depend on the block size, keep the loaded values
+    if (averageFileSize < kMinTuneFileSize) {
+        stop();
+        return;
+    }
+
+    if (elapsed > kMaxTuneTime) {
+        nextStage();
+        if (stage != TuneStage::kFinished)
+            nextStage();
+        return;
+    }
+
+    const qint64 elapsedDelta = elapsed - lastElapsed;
+    if (elapsedDelta < kSampleInterval)
+        return;
+
+    const qint64 speed = (writtenSize - lastWrittenSize) * 1000 / elapsedDelta;
+    lastWrittenSize = writtenSize;
+    lastElapsed = elapsed;
+
+    // paused or waiting for error handling, nothing to judge
+    if (speed <= 0)
+        return;
+
+    if (bestSpeed == 0) {
+        bestSpeed = speed;
+        if (!step())
+            nextStage();
+        return;
+    }
+
+    if (speed * 100 > bestSpeed * kImproveRatio) {
+        bestSpeed = speed;
+        bestValue = stage == TuneStage::kBlockSize ? blockSize : inFlightBlockCount;
+        if (!step())
+            nextStage();
+        return;
+    }
+
+    // the step is no better, go back to the best value and try the other direction once
+    if (stage == TuneStage::kBlockSize)
+        blockSize = bestValue;
+    else
+        inFlightBlockCount = static_cast<int>(bestValue);
+    apply();
+
+    if (reversed) {
+        nextStage();
+        return;
+    }
+    reversed = true;
+    direction = -direction;
+    if (!step())
+        nextStage();
+}
+
+bool CopyBlockTuner::step()
+{
+    if (stage == TuneStage::kBlockSize) {
+        const qint64 value = direction > 0 ? blockSize * 2 : blockSize / 2;
+        if (value < kMinBlockSize || value > kMaxBlockSize || value * inFlightBlockCount > kMaxInFlightMemory)
+            return false;
+        blockSize = value;
+    } else if (stage == TuneStage::kInFlightBlock) {
+        const int value = direction > 0 ? inFlightBlockCount * 2 : inFlightBlockCount / 2;
+        if (value < kMinInFlightBlock || value > kMaxInFlightBlock || blockSize * value > kMaxInFlightMemory)
+            return false;
+        inFlightBlockCount = value;
+    } else {
+        return false;
+    }
+
+    apply();
+    return true;
+}
+
+void CopyBlockTuner::nextStage()
+{
+    if (stage == TuneStage::kBlockSize) {
+        blockSize = bestValue;
+        stage = TuneStage::kInFlightBlock;
+        bestValue = inFlightBlockCount;
+        direction = 1;
+        reversed = false;
+        apply();
+        if (!step())
+            nextStage();
+        return;
+    }
+
+    if (stage == TuneStage::kInFlightBlock)
+        inFlightBlockCount = static_cast<int>(bestValue);
+
+    stage = TuneStage::kFinished;
+    apply();
+    save();
+}
+
+/*!
+ * \brief CopyBlockTuner::stop Stop tuning without saving, the step in trial is rolled back
+ */
+void CopyBlockTuner::stop()
+{
+    if (stage == TuneStage::kBlockSize)
+        blockSize = bestValue;
+    else if (stage == TuneStage::kInFlightBlock)
+        inFlightBlockCount = static_cast<int>(bestValue);
+
+    stage = TuneStage::kFinished;
+    apply();
+}
+
+void CopyBlockTuner::apply()
+{
+    workData->copyBlockSize = blockSize;
+    workData->inFlightBlockCount = inFlightBlockCount;
+}
+
+void CopyBlockTuner::save()
+{
+    qInfo() << "copy block tuning finished, device: " << deviceKey << " block size: " << blockSize
+            << " in-flight blocks: " << inFlightBlockCount << " speed: " << bestSpeed;
+
+    const QVariantMap values { { kBlockSizeKey, blockSize }, { kInFlightBlockKey, inFlightBlockCount } };
+    const QString key = deviceKey;
+    // settings live in the main thread
+    QMetaObject::invokeMethod(qApp, [key, values]() {
+        Application::dataPersistence()->setValue(kCopyTuningGroup, key, values);
+    });
+}
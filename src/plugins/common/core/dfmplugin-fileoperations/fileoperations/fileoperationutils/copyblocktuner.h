@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COPYBLOCKTUNER_H
+#define COPYBLOCKTUNER_H
+
+#include "dfmplugin_fileoperations_global.h"
+#include "workerdata.h"
+
+#include <QSharedPointer>
+#include <QString>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \class CopyBlockTuner
+ * \brief Tune the block size and the count of in-flight blocks of the buffered copy
+ * by the throughput measured in the first seconds of a job. The values are hill climbed one
+ * after another within a fixed memory budget, and the result is saved per target device for the next job.
+ * Jobs of small files are not tuned.
+ */
+class CopyBlockTuner
+{
+public:
+    CopyBlockTuner(const QSharedPointer<WorkerData> &data, const QString &deviceKey);
+
+    void load();
+    void sample(const qint64 writtenSize, const qint64 elapsed, const qint64 averageFileSize);
+
+private:
+    enum class TuneStage : quint8 {
+        kBlockSize,
+        kInFlightBlock,
+        kFinished,
+    };
+
+    bool step();
+    void nextStage();
+    void stop();
+    void apply();
+    void save();
+
+private:
+    QSharedPointer<WorkerData> workData { nullptr };
+    QString deviceKey;   // device and file system of target
+    TuneStage stage { TuneStage::kBlockSize };
+    qint64 blockSize { 0 };
+    int inFlightBlockCount { 0 };
+    qint64 bestValue { 0 };   // best value of current stage
+    qint64 bestSpeed { 0 };
+    int direction { 1 };   // 1: grow, -1: shrink
+    bool reversed { false };
+    qint64 lastWrittenSize { 0 };
+    qint64 lastElapsed { 0 };
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // COPYBLOCKTUNER_H
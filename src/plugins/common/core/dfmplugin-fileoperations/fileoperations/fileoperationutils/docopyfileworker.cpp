@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "docopyfileworker.h"
+#include "uringcopyengine.h"
+#include "integrityverifier.h"
 #include "utils/fileutils.h"
 
 #include <dfm-io/dfmio_utils.h>
@@ -12,12 +14,21 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <QThread>
+#include <QScopedPointer>
 
 #include <fcntl.h>
+#include <unistd.h>
 #include <zlib.h>
 #include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
 
 static const quint32 kMaxBufferLength { 1024 * 1024 * 1 };
+static const quint32 kMaxKernelCopyLength { 1024 * 1024 * 16 };
 
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
@@ -69,14 +80,69 @@ void DoCopyFileWorker::doFileCopy(const AbstractFileInfoPointer fromInfo, const
     workData->completeFileCount++;
 }
 
+/*!
+ * \brief DoCopyFileWorker::doFilesCopyBatch Copy a batch of small files through io_uring,
+ * the files failed in batch are copied again one by one, which handles the errors
+ * \param infos source and target file informations
+ */
+void DoCopyFileWorker::doFilesCopyBatch(const QList<WorkerData::SmallFileThreadCopyInfo> infos)
+{
+    QVector<UringCopyEngine::CopyTask> tasks;
+    tasks.reserve(infos.size());
+    for (const auto &info : infos) {
+        UringCopyEngine::CopyTask task;
+        task.fromPath = info.fromInfo->urlOf(UrlInfoType::kUrl).path().toStdString();
+        task.toPath = info.toInfo->urlOf(UrlInfoType::kUrl).path().toStdString();
+        task.size = static_cast<size_t>(info.fromInfo->size());
+        tasks.append(task);
+    }
+
+    if (!isStopped()) {
+        const auto onFileFinished = [this](qint64 size) {
+            workData->currentWriteSize.add(size);
+        };
+        const auto canContinue = [this]() {
+            return stateCheck();
+        };
+        // the ring of the worker is reused, a batch of the worker running on another thread meanwhile
+        // sets up its own
+        if (uringMutex.tryLock()) {
+            if (!uringEngine)
+                uringEngine.reset(new UringCopyEngine);
+            uringEngine->copy(tasks, onFileFinished, canContinue);
+            uringMutex.unlock();
+        } else {
+            UringCopyEngine engine;
+            engine.copy(tasks, onFileFinished, canContinue);
+        }
+    }
+
+    for (int i = 0; i < infos.size(); ++i) {
+        if (Q_UNLIKELY(!stateCheck()))
+            return;
+
+        const auto &info = infos.at(i);
+        if (!tasks.at(i).finished) {
+            doFileCopy(info.fromInfo, info.toInfo);
+            continue;
+        }
+
+        emit currentTask(info.fromInfo->urlOf(UrlInfoType::kUrl), info.toInfo->urlOf(UrlInfoType::kUrl));
+        setTargetPermissions(info.fromInfo, info.toInfo);
+        FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, info.toInfo->urlOf(UrlInfoType::kUrl));
+        workData->completeFileCount++;
+    }
+}
+
 void DoCopyFileWorker::writeExblockFile()
 {
     while (true) {
         if (isStopped())
             return;
-        if (workData->blockCopyInfoQueue.size() <= 0) {
-            QThread::msleep(10);
-        } else if (!doWriteBlockFileCopy(workData->blockCopyInfoQueue.takeByLock())) {
+        BlockFileCopyInfoPointer info;
+        if (!workData->blockCopyInfoQueue.pop(info)) {
+            QThread::msleep(1);
+        } else if (!doWriteBlockFileCopy(info)) {
             return;
         }
     }
@@ -124,8 +190,129 @@ void DoCopyFileWorker::doMemcpyLocalBigFile(const AbstractFileInfoPointer fromIn
         if (memcpySkipUrl.isValid() && memcpySkipUrl == fromInfo->urlOf(UrlInfoType::kUrl))
             return;
 
-        workData->currentWriteSize += static_cast<int64_t>(everyCopySize);
+        workData->currentWriteSize.add(static_cast<int64_t>(everyCopySize));
+    }
+}
+
+/*!
+ * \brief DoCopyFileWorker::doCopyFileByKernel Copy the file content without user-space buffer.
+ * Try FICLONE, copy_file_range and sendfile in order, the method that works is remembered
+ * for the source and target device pair, so the following files skip the unsupported ones.
+ * The files are opened by doOpenFile, so the open errors are handled as the other copies do,
+ * the errors of copying are not reported here, the buffered copy redoes the file and handles them.
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \param skip set if the file is skipped on the open error
+ * \return copy result
+ */
+DoCopyFileWorker::KernelCopyResult DoCopyFileWorker::doCopyFileByKernel(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo, bool *skip)
+{
+    const QUrl &fromUrl = fromInfo->urlOf(UrlInfoType::kUrl);
+    const QUrl &toUrl = toInfo->urlOf(UrlInfoType::kUrl);
+    const qint64 fileSize = fromInfo->size();
+    if (fileSize <= 0 || !fromUrl.isLocalFile() || !toUrl.isLocalFile())
+        return KernelCopyResult::kCopyUnsupported;
+    // integrity checking needs the source data in user space,
+    // and the target that need sync every write is handled by the buffered copy
+    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking) || workData->needSyncEveryRW)
+        return KernelCopyResult::kCopyUnsupported;
+
+    int fromFd = doOpenFile(fromInfo, toInfo, false, O_RDONLY | O_CLOEXEC, skip);
+    if (fromFd < 0)
+        return isStopped() ? KernelCopyResult::kCopyStopped : KernelCopyResult::kCopyFailed;
+    int toFd = doOpenFile(fromInfo, toInfo, true, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, skip);
+    if (toFd < 0) {
+        close(fromFd);
+        return isStopped() ? KernelCopyResult::kCopyStopped : KernelCopyResult::kCopyFailed;
+    }
+
+    struct stat fromStat, toStat;
+    if (fstat(fromFd, &fromStat) != 0 || fstat(toFd, &toStat) != 0) {
+        close(fromFd);
+        close(toFd);
+        return KernelCopyResult::kCopyUnsupported;
     }
+
+    const WorkerData::DevicePair devices { fromStat.st_dev, toStat.st_dev };
+    WorkerData::CopyMethod method = workData->copyMethodOf(devices, defaultCopyMethod(fromFd, toFd));
+    KernelCopyResult result = KernelCopyResult::kCopyUnsupported;
+    qint64 copiedSize = 0;
+    while (method != WorkerData::CopyMethod::kBuffered) {
+        if (doKernelCopy(method, fromFd, toFd, fileSize, copiedSize)) {
+            result = KernelCopyResult::kCopyFinished;
+            break;
+        }
+        if (isStopped()) {
+            result = KernelCopyResult::kCopyStopped;
+            break;
+        }
+        // failed after some data written (eg. no space), the method works for this device pair
+        if (copiedSize > 0)
+            break;
+        workData->demoteCopyMethod(devices, method);
+        method = workData->copyMethodOf(devices, method);
+    }
+
+    close(fromFd);
+    close(toFd);
+
+    // the buffered copy writes the file again from the beginning
+    if (result == KernelCopyResult::kCopyUnsupported && copiedSize > 0)
+        workData->currentWriteSize.add(-copiedSize);
+
+    return result;
+}
+
+WorkerData::CopyMethod DoCopyFileWorker::defaultCopyMethod(const int fromFd, const int toFd)
+{
+    struct statfs fromFs, toFs;
+    if (fstatfs(fromFd, &fromFs) != 0 || fstatfs(toFd, &toFs) != 0)
+        return WorkerData::CopyMethod::kBuffered;
+
+    // copy_file_range does not work across different filesystem types since linux 5.19
+    if (fromFs.f_type != toFs.f_type)
+        return WorkerData::CopyMethod::kSendFile;
+
+    if (fromFs.f_type == BTRFS_SUPER_MAGIC || fromFs.f_type == XFS_SUPER_MAGIC)
+        return WorkerData::CopyMethod::kReflink;
+
+    return WorkerData::CopyMethod::kCopyFileRange;
+}
+
+bool DoCopyFileWorker::doKernelCopy(const WorkerData::CopyMethod method, const int fromFd, const int toFd,
+                                    const qint64 size, qint64 &copiedSize)
+{
+    if (method == WorkerData::CopyMethod::kReflink) {
+        if (ioctl(toFd, FICLONE, fromFd) != 0)
+            return false;
+        copiedSize = size;
+        workData->currentWriteSize.add(size);
+        return true;
+    }
+
+    while (copiedSize < size) {
+        if (Q_UNLIKELY(!stateCheck()))
+            return false;
+
+        const size_t length = static_cast<size_t>(qMin<qint64>(size - copiedSize, kMaxKernelCopyLength));
+        ssize_t ret = method == WorkerData::CopyMethod::kCopyFileRange
+                ? copy_file_range(fromFd, nullptr, toFd, nullptr, length, 0)
+                : sendfile(toFd, fromFd, nullptr, length);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        // the source file is truncated while copying if ret is 0
+        if (ret <= 0) {
+            if (ret < 0 && copiedSize > 0)
+                qWarning() << "kernel copy failed, method: " << static_cast<int>(method) << " copied size: " << copiedSize
+                           << " error msg: " << strerror(errno);
+            return false;
+        }
+
+        copiedSize += ret;
+        workData->currentWriteSize.add(ret);
+    }
+
+    return true;
 }
 
 bool DoCopyFileWorker::doWriteBlockFileCopy(const BlockFileCopyInfoPointer blockFileInfo)
@@ -207,7 +394,8 @@ int DoCopyFileWorker::doOpenFile(const AbstractFileInfoPointer fromInfo, const A
 
 BlockFileCopyInfoPointer DoCopyFileWorker::doReadExBlockFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, const int fd, bool *skip)
 {
-    qint64 sizeBlock = fromInfo->size() > kMaxBufferLength ? kMaxBufferLength : fromInfo->size();
+    const qint64 copyBlockSize = workData->copyBlockSize;
+    qint64 sizeBlock = fromInfo->size() > copyBlockSize ? copyBlockSize : fromInfo->size();
     BlockFileCopyInfoPointer copyinfo(new WorkerData::BlockFileCopyInfo());
     copyinfo->frominfo = fromInfo;
     copyinfo->toinfo = toInfo;
@@ -221,20 +409,27 @@ BlockFileCopyInfoPointer DoCopyFileWorker::doReadExBlockFile(const AbstractFileI
             close(fd);
             return copyinfo;
         }
-        char *buffer = new char[static_cast<uint>(sizeBlock + 1)];
+        // the buffer goes back to the pool after written
+        const BlockBufferPool::Buffer buffer = workData->blockBufferPool.acquire(sizeBlock);
+        if (Q_UNLIKELY(!buffer.data)) {
+            close(fd);
+            return copyinfo;
+        }
         AbstractJobHandler::SupportAction actionForRead = AbstractJobHandler::SupportAction::kNoAction;
         do {
-            readSize = read(fd, buffer, static_cast<size_t>(sizeBlock));
+            readSize = read(fd, buffer.data, static_cast<size_t>(sizeBlock));
             auto laststr = strerror(errno);
             if (Q_UNLIKELY(!stateCheck())) {
-                delete[] buffer;
+                workData->blockBufferPool.release(buffer);
                 close(fd);
                 return copyinfo;
             }
             if (Q_UNLIKELY(readSize <= 0)) {
                 // read over
                 if (readSize == 0 && currentPos == fromInfo->size()) {
-                    copyinfo->buffer = buffer;
+                    copyinfo->buffer = buffer.data;
+                    copyinfo->bufferSize = buffer.size;
+                    copyinfo->bufferPool = &workData->blockBufferPool;
                     copyinfo->size = readSize;
                     close(fd);
                     return copyinfo;
@@ -261,6 +456,7 @@ BlockFileCopyInfoPointer DoCopyFileWorker::doReadExBlockFile(const AbstractFileI
                         checkRetry();
                         actionOperating(actionForReadSeek, fromInfo->size() <= 0 ? FileUtils::getMemoryPageSize() : fromInfo->size(), skip);
 
+                        workData->blockBufferPool.release(buffer);
                         close(fd);
 
                         return copyinfo;
@@ -272,6 +468,7 @@ BlockFileCopyInfoPointer DoCopyFileWorker::doReadExBlockFile(const AbstractFileI
         checkRetry();
 
         if (!actionOperating(actionForRead, fromInfo->size() <= 0 ? FileUtils::getMemoryPageSize() : fromInfo->size(), skip)) {
+            workData->blockBufferPool.release(buffer);
             close(fd);
             return copyinfo;
         }
@@ -282,20 +479,28 @@ BlockFileCopyInfoPointer DoCopyFileWorker::doReadExBlockFile(const AbstractFileI
     }
 }
 
-void DoCopyFileWorker::createExBlockFileCopyInfo(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, const qint64 currentPos, const bool closeFlag, const qint64 size, char *buffer, const bool isDir, const QFileDevice::Permissions permission)
+void DoCopyFileWorker::createExBlockFileCopyInfo(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, const qint64 currentPos, const bool closeFlag, const qint64 size, const BlockBufferPool::Buffer &buffer, const bool isDir, const QFileDevice::Permissions permission)
 {
     BlockFileCopyInfoPointer tmpinfo(new WorkerData::BlockFileCopyInfo());
     tmpinfo->closeflag = closeFlag;
     tmpinfo->frominfo = fromInfo;
     tmpinfo->toinfo = toInfo;
     tmpinfo->currentpos = currentPos;
-    tmpinfo->buffer = buffer;
+    tmpinfo->buffer = buffer.data;
+    tmpinfo->bufferSize = buffer.size;
+    tmpinfo->bufferPool = &workData->blockBufferPool;
     tmpinfo->size = size;
     tmpinfo->isdir = isDir;
     tmpinfo->permission = permission;
-    workData->blockCopyInfoQueue.push_backByLock(tmpinfo);
-    while (workData->blockCopyInfoQueue.count() > 500 && !isStopped())
-        QThread::msleep(10);
+    pushBlockCopyInfo(tmpinfo);
+    while (workData->blockCopyInfoQueue.size() > workData->inFlightBlockCount && !isStopped())
+        QThread::msleep(1);
+}
+
+void DoCopyFileWorker::pushBlockCopyInfo(const BlockFileCopyInfoPointer &info)
+{
+    while (!workData->blockCopyInfoQueue.push(info) && !isStopped())
+        QThread::msleep(1);
 }
 
 // copy thread using
@@ -305,15 +510,27 @@ bool DoCopyFileWorker::doCopyFilePractically(const AbstractFileInfoPointer fromI
         return false;
     // emit current task url
     emit currentTask(fromInfo->urlOf(UrlInfoType::kUrl), toInfo->urlOf(UrlInfoType::kUrl));
+    // reflink or copy in kernel first, the buffered copy is the fallback
+    const KernelCopyResult kernelResult = doCopyFileByKernel(fromInfo, toInfo, skip);
+    if (kernelResult == KernelCopyResult::kCopyStopped || kernelResult == KernelCopyResult::kCopyFailed)
+        return false;
+    // the jobs checking integrity never copy in kernel, see doCopyFileByKernel
+    if (kernelResult == KernelCopyResult::kCopyFinished)
+        return finishFileCopy(fromInfo, toInfo, []() { return true; }, skip);
     // read ahead source file
-    readAheadSourceFile(fromInfo);
+    qint64 readAheadEnd = 0;
+    int readAheadFd = readAheadSourceFile(fromInfo, readAheadEnd);
     // 创建文件的divice
     QSharedPointer<DFMIO::DFile> fromDevice { nullptr }, toDevice { nullptr };
-    if (!createFileDevices(fromInfo, toInfo, fromDevice, toDevice, skip))
+    if (!createFileDevices(fromInfo, toInfo, fromDevice, toDevice, skip)) {
+        closeReadAheadFile(readAheadFd);
         return false;
+    }
     // 打开文件并创建
-    if (!openFiles(fromInfo, toInfo, fromDevice, toDevice, skip))
+    if (!openFiles(fromInfo, toInfo, fromDevice, toDevice, skip)) {
+        closeReadAheadFile(readAheadFd);
         return false;
+    }
     // 源文件大小如果为0
     if (fromInfo->size() <= 0) {
         // 对文件加权
@@ -323,28 +540,40 @@ bool DoCopyFileWorker::doCopyFilePractically(const AbstractFileInfoPointer fromI
         return true;
     }
     // resize target file
-    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyResizeDestinationFile) && !resizeTargetFile(fromInfo, toInfo, toDevice, skip))
+    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyResizeDestinationFile) && !resizeTargetFile(fromInfo, toInfo, toDevice, skip)) {
+        closeReadAheadFile(readAheadFd);
         return false;
+    }
     // 循环读取和写入文件，拷贝
-    qint64 blockSize = fromInfo->size() > kMaxBufferLength ? kMaxBufferLength : fromInfo->size();
+    const qint64 copyBlockSize = workData->copyBlockSize;
+    qint64 blockSize = fromInfo->size() > copyBlockSize ? copyBlockSize : fromInfo->size();
     char *data = new char[static_cast<uint>(blockSize + 1)];
     uLong sourceCheckSum = adler32(0L, nullptr, 0);
     qint64 sizeRead = 0;
+    // verify the written range of local target while copying, instead of reading it again after copied
+    QScopedPointer<IntegrityVerifier> verifier { createIntegrityVerifier(toInfo) };
 
     do {
         if (!doReadFile(fromInfo, toInfo, fromDevice, data, blockSize, sizeRead, skip)) {
             delete[] data;
             data = nullptr;
+            closeReadAheadFile(readAheadFd);
             return false;
         }
 
         if (!doWriteFile(fromInfo, toInfo, toDevice, data, sizeRead, skip)) {
             delete[] data;
             data = nullptr;
+            closeReadAheadFile(readAheadFd);
             return false;
         }
 
-        if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
+        readAheadWindow(readAheadFd, fromDevice->pos(), fromInfo->size(), readAheadEnd);
+
+        if (verifier) {
+            verifier->updateSource(data, sizeRead);
+            verifier->written(sizeRead);
+        } else if (Q_UNLIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
             sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(sizeRead));
         }
 
@@ -354,7 +583,25 @@ bool DoCopyFileWorker::doCopyFilePractically(const AbstractFileInfoPointer fromI
 
     delete[] data;
     data = nullptr;
+    closeReadAheadFile(readAheadFd);
 
+    const auto verify = [&]() {
+        return verifier ? verifyFileIntegrity(verifier.data(), fromInfo, toInfo)
+                        : verifyFileIntegrity(blockSize, sourceCheckSum, fromInfo, toInfo, toDevice);
+    };
+    return finishFileCopy(fromInfo, toInfo, verify, skip);
+}
+
+/*!
+ * \brief DoCopyFileWorker::finishFileCopy The handling after the content is copied, shared by the kernel copy
+ * and the buffered copy
+ * \param verify check the integrity of the target file
+ * \param skip set to the result of verify
+ * \return false if the job is stopped
+ */
+bool DoCopyFileWorker::finishFileCopy(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                                      const std::function<bool()> &verify, bool *skip)
+{
     // 对文件加权
     setTargetPermissions(fromInfo, toInfo);
     if (!stateCheck())
@@ -362,7 +609,7 @@ bool DoCopyFileWorker::doCopyFilePractically(const AbstractFileInfoPointer fromI
 
     // 校验文件完整性
     if (skip)
-        *skip = verifyFileIntegrity(blockSize, sourceCheckSum, fromInfo, toInfo, toDevice);
+        *skip = verify();
     toInfo->refresh();
 
     if (skip && *skip)
@@ -385,7 +632,7 @@ void DoCopyFileWorker::readExblockFile(const AbstractFileInfoPointer fromInfo, c
     if (!stateCheck())
         return;
 
-    workData->blockCopyInfoQueue.push_backByLock(info);
+    pushBlockCopyInfo(info);
 }
 
 bool DoCopyFileWorker::stateCheck()
@@ -453,19 +700,54 @@ AbstractJobHandler::SupportAction DoCopyFileWorker::doHandleErrorAndWait(const Q
 }
 
 /*!
- * \brief FileOperateBaseWorker::readAheadSourceFile Pre read source file content
+ * \brief DoCopyFileWorker::readAheadSourceFile Pre read the first window of source file content,
+ * the window is the in-flight blocks of current block size
  * \param fileInfo File information of source file
+ * \param readAheadEnd Output parameter: end of the advised range
+ * \return fd used by the following read ahead, -1 if not opened
  */
-void DoCopyFileWorker::readAheadSourceFile(const AbstractFileInfoPointer &fileInfo)
+int DoCopyFileWorker::readAheadSourceFile(const AbstractFileInfoPointer &fileInfo, qint64 &readAheadEnd)
 {
+    readAheadEnd = 0;
     if (fileInfo->size() <= 0)
-        return;
+        return -1;
     std::string stdStr = fileInfo->urlOf(UrlInfoType::kUrl).path().toUtf8().toStdString();
     int fromfd = open(stdStr.data(), O_RDONLY);
-    if (-1 != fromfd) {
-        readahead(fromfd, 0, static_cast<size_t>(fileInfo->size()));
-        close(fromfd);
-    }
+    if (-1 == fromfd)
+        return -1;
+
+    posix_fadvise(fromfd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    readAheadWindow(fromfd, 0, fileInfo->size(), readAheadEnd);
+    return fromfd;
+}
+
+/*!
+ * \brief DoCopyFileWorker::readAheadWindow Keep a window of in-flight blocks advised ahead of the read position
+ * \param fd source file fd
+ * \param pos current read position
+ * \param size source file size
+ * \param readAheadEnd end of the advised range, updated when advised
+ */
+void DoCopyFileWorker::readAheadWindow(const int fd, const qint64 pos, const qint64 size, qint64 &readAheadEnd)
+{
+    if (fd < 0 || readAheadEnd >= size)
+        return;
+
+    const qint64 window = workData->copyBlockSize * workData->inFlightBlockCount;
+    // advise the next window when half of the current one is consumed
+    if (readAheadEnd - pos > window / 2)
+        return;
+
+    const qint64 start = qMax(pos, readAheadEnd);
+    const qint64 length = qMin(window, size - start);
+    posix_fadvise(fd, start, length, POSIX_FADV_WILLNEED);
+    readAheadEnd = start + length;
+}
+
+void DoCopyFileWorker::closeReadAheadFile(const int fd)
+{
+    if (fd >= 0)
+        close(fd);
 }
 /*!
  * \brief FileOperateBaseWorker::createFileDevice Device to create the file
@@ -695,7 +977,7 @@ bool DoCopyFileWorker::doWriteFile(const AbstractFileInfoPointer &fromInfo, cons
             surplusSize -= sizeWrite;
             sizeWrite = toDevice->write(surplusData, surplusSize);
             if (sizeWrite > 0)
-                workData->currentWriteSize += sizeWrite;
+                workData->currentWriteSize.add(sizeWrite);
             if (Q_UNLIKELY(!stateCheck()))
                 return false;
             writeFinishedOnce = false;
@@ -797,6 +1079,49 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
     return true;
 }
 
+/*!
+ * \brief DoCopyFileWorker::createIntegrityVerifier Create the verifier for the local target
+ * \param toInfo target file info
+ * \return nullptr if integrity checking is off or the target can not be read directly,
+ * the target is read again after copied in this case
+ */
+IntegrityVerifier *DoCopyFileWorker::createIntegrityVerifier(const AbstractFileInfoPointer &toInfo)
+{
+    if (!workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
+        return nullptr;
+
+    const QUrl &targetUrl = toInfo->urlOf(UrlInfoType::kUrl);
+    if (!targetUrl.isLocalFile())
+        return nullptr;
+
+    IntegrityVerifier *verifier = new IntegrityVerifier(workData, IntegrityVerifier::preferredType(), targetUrl.path());
+    if (!verifier->isValid()) {
+        delete verifier;
+        return nullptr;
+    }
+    return verifier;
+}
+
+bool DoCopyFileWorker::verifyFileIntegrity(IntegrityVerifier *verifier, const AbstractFileInfoPointer &fromInfo,
+                                           const AbstractFileInfoPointer &toInfo)
+{
+    QTime t;
+    t.start();
+    const bool same = verifier->finish();
+    qDebug("Time spent of waiting integrity check of the file: %d", t.elapsed());
+
+    if (!same) {
+        qWarning("Failed on file integrity checking, source file: 0x%x, target file: 0x%x", verifier->sourceChecksum(), verifier->targetChecksum());
+        AbstractJobHandler::SupportAction actionForCheck = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                                toInfo->urlOf(UrlInfoType::kUrl),
+                                                                                AbstractJobHandler::JobErrorType::kIntegrityCheckingError,
+                                                                                true);
+        return actionForCheck == AbstractJobHandler::SupportAction::kSkipAction;
+    }
+
+    return true;
+}
+
 void DoCopyFileWorker::checkRetry()
 {
     if (!workData->signalThread && retry && !isStopped()) {
@@ -812,10 +1137,7 @@ bool DoCopyFileWorker::isStopped()
 
 void DoCopyFileWorker::releaseCopyInfo(const BlockFileCopyInfoPointer &info)
 {
-    if (info->buffer) {
-        delete[] info->buffer;
-        info->buffer = nullptr;
-    }
+    info->releaseBuffer();
 }
 
 bool DoCopyFileWorker::writeBlockFile(const BlockFileCopyInfoPointer &info, bool *skip)
@@ -848,7 +1170,7 @@ bool DoCopyFileWorker::writeBlockFile(const BlockFileCopyInfoPointer &info, bool
             surplusSize -= sizeWrite;
             sizeWrite = write(blockFileFd, surplusData, static_cast<size_t>(info->size));
             if (sizeWrite > 0)
-                workData->currentWriteSize += sizeWrite;
+                workData->currentWriteSize.add(sizeWrite);
             if (Q_UNLIKELY(!stateCheck()))
                 return false;
             writeFinishedOnce = false;
@@ -15,14 +15,18 @@
 #include <dfm-io/dfile.h>
 
 #include <QObject>
+#include <QMutex>
+
+#include <functional>
 
 #include <fcntl.h>
 
 class QWaitCondition;
-class QMutex;
 USING_IO_NAMESPACE
 DPFILEOPERATIONS_BEGIN_NAMESPACE
 DFMBASE_USE_NAMESPACE
+class IntegrityVerifier;
+class UringCopyEngine;
 class DoCopyFileWorker : public QObject
 {
     Q_OBJECT
@@ -33,6 +37,13 @@ public:
         kStoped,
     };
 
+    enum class KernelCopyResult : u_int8_t {
+        kCopyFinished,   // file content copied in kernel
+        kCopyUnsupported,   // nothing usable copied, use the buffered copy
+        kCopyStopped,   // job stopped while copying
+        kCopyFailed,   // the file can not be opened, the error is handled and the file skipped
+    };
+
 public:
     explicit DoCopyFileWorker(const QSharedPointer<WorkerData> &data, QObject *parent = nullptr);
     ~DoCopyFileWorker() override;
@@ -45,9 +56,11 @@ public:
     bool doCopyFilePractically(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo,
                                bool *skip);
     void doFileCopy(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
+    void doFilesCopyBatch(const QList<WorkerData::SmallFileThreadCopyInfo> infos);
     void readExblockFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
     void writeExblockFile();
     void doMemcpyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, char *dest, char *source, size_t size);
+    KernelCopyResult doCopyFileByKernel(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo, bool *skip);
 signals:
     void ErrorFinished();
     void CompleteSize(const int size);
@@ -67,7 +80,9 @@ private:   // file copy
                                                            const bool isTo = false,
                                                            const QString &errorMsg = QString());
 
-    void readAheadSourceFile(const AbstractFileInfoPointer &fileInfo);
+    int readAheadSourceFile(const AbstractFileInfoPointer &fileInfo, qint64 &readAheadEnd);
+    void readAheadWindow(const int fd, const qint64 pos, const qint64 size, qint64 &readAheadEnd);
+    void closeReadAheadFile(const int fd);
     bool createFileDevices(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
                            QSharedPointer<DFMIO::DFile> &fromeFile, QSharedPointer<DFMIO::DFile> &toFile,
                            bool *skip);
@@ -89,15 +104,26 @@ private:   // file copy
                      const QSharedPointer<DFMIO::DFile> &toDevice,
                      const char *data, const qint64 readSize, bool *skip);
     void setTargetPermissions(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo);
+    bool finishFileCopy(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
+                        const std::function<bool()> &verify, bool *skip);
     bool verifyFileIntegrity(const qint64 &blockSize, const ulong &sourceCheckSum,
                              const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo,
                              QSharedPointer<DFMIO::DFile> &toFile);
+    bool verifyFileIntegrity(IntegrityVerifier *verifier, const AbstractFileInfoPointer &fromInfo,
+                             const AbstractFileInfoPointer &toInfo);
+    IntegrityVerifier *createIntegrityVerifier(const AbstractFileInfoPointer &toInfo);
     void checkRetry();
     bool isStopped();
 
+private:   // kernel file copy
+    WorkerData::CopyMethod defaultCopyMethod(const int fromFd, const int toFd);
+    bool doKernelCopy(const WorkerData::CopyMethod method, const int fromFd, const int toFd,
+                      const qint64 size, qint64 &copiedSize);
+
 private:   // block file copy
     //清理当前拷贝信息
     void releaseCopyInfo(const BlockFileCopyInfoPointer &info);
+    void pushBlockCopyInfo(const BlockFileCopyInfoPointer &info);
     bool writeBlockFile(const BlockFileCopyInfoPointer &info, bool *skip);
     void syncBlockFile(const BlockFileCopyInfoPointer &info);
     bool doWriteBlockFileCopy(const BlockFileCopyInfoPointer blockFileInfo);
@@ -110,7 +136,7 @@ private:   // block file copy
                                    const qint64 currentPos,
                                    const bool closeFlag,
                                    const qint64 size,
-                                   char *buffer = nullptr,
+                                   const BlockBufferPool::Buffer &buffer = BlockBufferPool::Buffer(),
                                    const bool isDir = false,
                                    const QFileDevice::Permissions permission = QFileDevice::Permission::ReadOwner);
 
@@ -125,6 +151,8 @@ private:
     int blockFileFd { -1 };
     QList<QUrl> skipUrls;
     QUrl memcpySkipUrl;
+    QMutex uringMutex;
+    QSharedPointer<UringCopyEngine> uringEngine { nullptr };   // set up by the first batch of small files
 };
 DPFILEOPERATIONS_END_NAMESPACE
 #endif   // DOCOPYFILEWORKER_H
@@ -6,6 +6,8 @@
 #include "fileoperations/fileoperationutils/fileoperationsutils.h"
 #include "fileoperations/copyfiles/storageinfo.h"
 #include "workerdata.h"
+#include "uringcopyengine.h"
+#include "copyblocktuner.h"
 
 #include "dfm-base/interfaces/abstractdiriterator.h"
 #include "dfm-base/base/schemefactory.h"
@@ -25,11 +27,12 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <zlib.h>
-#include <syscall.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 
 constexpr uint32_t kBigFileSize { 300 * 1024 * 1024 };
+constexpr uint32_t kSmallFileSize { 1024 * 1024 };
+constexpr int kSmallFileBatchCount { 128 };
 
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
@@ -77,12 +80,21 @@ AbstractJobHandler::SupportAction FileOperateBaseWorker::doHandleErrorAndWait(co
 
 void FileOperateBaseWorker::emitSpeedUpdatedNotify(const qint64 &writSize)
 {
+    if (blockTuner) {
+        const qint64 filesCount = sourceFilesCount;
+        blockTuner->sample(workData->currentWriteSize.value(), time.elapsed(), filesCount > 0 ? sourceFilesTotalSize / filesCount : 0);
+    }
+
     JobInfoPointer info(new QMap<quint8, QVariant>);
     qint64 speed = writSize * 1000 / (time.elapsed() == 0 ? 1 : time.elapsed());
     info->insert(AbstractJobHandler::NotifyInfoKey::kJobtypeKey, QVariant::fromValue(jobType));
     info->insert(AbstractJobHandler::NotifyInfoKey::kJobStateKey, QVariant::fromValue(currentState));
     info->insert(AbstractJobHandler::NotifyInfoKey::kSpeedKey, QVariant::fromValue(speed));
     info->insert(AbstractJobHandler::NotifyInfoKey::kRemindTimeKey, QVariant::fromValue(speed == 0 ? 0 : (sourceFilesTotalSize - writSize) / speed));
+    if (workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking)) {
+        const qint64 verifySpeed = workData->verifiedSize * 1000 / (time.elapsed() == 0 ? 1 : time.elapsed());
+        info->insert(AbstractJobHandler::NotifyInfoKey::kVerifySpeedKey, QVariant::fromValue(verifySpeed));
+    }
 
     emit stateChangedNotify(info);
     emit speedUpdatedNotify(info);
@@ -635,6 +647,8 @@ bool FileOperateBaseWorker::checkAndCopyDir(const AbstractFileInfoPointer &fromI
 
 void FileOperateBaseWorker::waitThreadPoolOver()
 {
+    // small files wait for batch copy
+    doCopySmallFileBatch();
     // wait all thread start
     if (!isStopped() && threadPool) {
         QThread::msleep(10);
@@ -655,7 +669,7 @@ void FileOperateBaseWorker::initCopyWay()
 {
     // local file useing least 8 thread
     if (isSourceFileLocal && isTargetFileLocal) {
-        countWriteType = CountWriteSizeType::kCustomizeType;
+        waitStatisticsForCopyWay();
         workData->signalThread = (sourceFilesCount > 1 || sourceFilesTotalSize > kBigFileSize) && FileUtils::getCpuProcessCount() > 4
                 ? false
                 : true;
@@ -668,14 +682,32 @@ void FileOperateBaseWorker::initCopyWay()
         workData->signalThread = false;
     }
 
-    if (DeviceUtils::isSamba(targetUrl) || DeviceUtils::isFtp(targetUrl))
-        countWriteType = CountWriteSizeType::kCustomizeType;
-
     if (!workData->signalThread) {
         initThreadCopy();
+        // integrity checking needs the source data in user space
+        smallFileBatchCopy = isSourceFileLocal && isTargetFileLocal
+                && !workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking)
+                && UringCopyEngine::isSupported();
+    }
+}
+
+/*!
+ * \brief FileOperateBaseWorker::waitStatisticsForCopyWay The statistics runs while copying,
+ * wait until it knows enough to choose single or multiple threads, not the whole tree
+ */
+void FileOperateBaseWorker::waitStatisticsForCopyWay()
+{
+    if (!statisticsFilesSizeJob)
+        return;
+
+    while (!isStopped() && !statisticsFilesSizeJob->isFinished()) {
+        if (statisticsFilesSizeJob->filesCount() > 1 || statisticsFilesSizeJob->totalSize() > kBigFileSize)
+            break;
+        QThread::msleep(10);
     }
 
-    copyTid = (countWriteType == CountWriteSizeType::kTidType) ? syscall(SYS_gettid) : -1;
+    sourceFilesCount = qMax<qint64>(sourceFilesCount, statisticsFilesSizeJob->filesCount());
+    sourceFilesTotalSize = qMax(qint64(sourceFilesTotalSize), statisticsFilesSizeJob->totalSize());
 }
 
 void FileOperateBaseWorker::setSkipValue(bool *skip, AbstractJobHandler::SupportAction action)
@@ -725,6 +757,13 @@ bool FileOperateBaseWorker::doCopyLocalFile(const AbstractFileInfoPointer fromIn
     if (!stateCheck())
         return false;
 
+    if (smallFileBatchCopy && fromInfo->size() > 0 && fromInfo->size() <= kSmallFileSize) {
+        smallFileCopyInfos.append({ fromInfo, toInfo });
+        if (smallFileCopyInfos.count() >= kSmallFileBatchCount)
+            doCopySmallFileBatch();
+        return true;
+    }
+
     QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
                       static_cast<void (DoCopyFileWorker::*)(const AbstractFileInfoPointer, const AbstractFileInfoPointer)>(&DoCopyFileWorker::doFileCopy),
                       fromInfo, toInfo);
@@ -733,9 +772,31 @@ bool FileOperateBaseWorker::doCopyLocalFile(const AbstractFileInfoPointer fromIn
     return true;
 }
 
+void FileOperateBaseWorker::doCopySmallFileBatch()
+{
+    if (smallFileCopyInfos.isEmpty() || isStopped())
+        return;
+
+    QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
+                      static_cast<void (DoCopyFileWorker::*)(const QList<WorkerData::SmallFileThreadCopyInfo>)>(&DoCopyFileWorker::doFilesCopyBatch),
+                      smallFileCopyInfos);
+
+    threadCopyFileCount++;
+    smallFileCopyInfos.clear();
+}
+
 bool FileOperateBaseWorker::doCopyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip)
 {
     waitThreadPoolOver();
+    // reflink or copy in kernel first, the mmap copy is the fallback
+    const auto kernelResult = threadCopyWorker.first()->doCopyFileByKernel(fromInfo, toInfo, skip);
+    if (kernelResult == DoCopyFileWorker::KernelCopyResult::kCopyStopped
+        || kernelResult == DoCopyFileWorker::KernelCopyResult::kCopyFailed)
+        return false;
+    if (kernelResult == DoCopyFileWorker::KernelCopyResult::kCopyFinished) {
+        setTargetPermissions(fromInfo, toInfo);
+        return true;
+    }
     // open file
     auto fromFd = doOpenFile(fromInfo, toInfo, false, O_RDONLY, skip);
     if (fromFd < 0)
@@ -949,7 +1010,8 @@ void FileOperateBaseWorker::createExBlockFileCopyInfo(const AbstractFileInfoPoin
     tmpinfo->size = size;
     tmpinfo->isdir = isDir;
     tmpinfo->permission = permission;
-    workData->blockCopyInfoQueue.push_backByLock(tmpinfo);
+    while (!workData->blockCopyInfoQueue.push(tmpinfo) && !isStopped())
+        QThread::msleep(1);
 }
 
 void FileOperateBaseWorker::startBlockFileCopy()
@@ -1124,24 +1186,24 @@ void FileOperateBaseWorker::setAllDirPermisson()
     }
 }
 
+/*!
+ * \brief FileOperateBaseWorker::getWriteDataSize Size written by the job, the in-process counter of the
+ * copy threads. On removable devices the data in the page cache is not on the device yet, so only
+ * the part already written back to the device is counted until the device is synced
+ * \return written size
+ */
 qint64 FileOperateBaseWorker::getWriteDataSize()
 {
-    qint64 writeSize = 0;
-
-    if (CountWriteSizeType::kTidType == countWriteType) {
-        writeSize = getTidWriteSize();
+    qint64 writeSize = workData->currentWriteSize.value();
 
-        if (writeSize > workData->currentWriteSize && workData->currentWriteSize > 0) {
-            writeSize = workData->currentWriteSize;
-        }
-        if (writeSize <= 0)
-            writeSize = workData->currentWriteSize;
-    } else if (CountWriteSizeType::kCustomizeType == countWriteType) {
-        writeSize = workData->currentWriteSize;
-    } else if (CountWriteSizeType::kWriteBlockType == countWriteType) {
+    if (CountWriteSizeType::kWriteBlockType == countWriteType && !targetDeviceSynced) {
         qint64 currentSectorsWritten = getSectorsWritten() + workData->blockRenameWriteSize;
-        if (currentSectorsWritten > targetDeviceStartSectorsWritten)
-            writeSize = (currentSectorsWritten - targetDeviceStartSectorsWritten) * targetLogSecionSize;
+        const qint64 deviceWriteSize = currentSectorsWritten > targetDeviceStartSectorsWritten
+                ? (currentSectorsWritten - targetDeviceStartSectorsWritten) * targetLogSecionSize
+                : 0;
+        // dirty pages waiting for writeback
+        const qint64 pendingWriteSize = qMax(writeSize - deviceWriteSize, qint64(0));
+        writeSize -= pendingWriteSize;
     }
 
     writeSize += (workData->skipWriteSize + workData->zeroOrlinkOrDirWriteSize);
@@ -1149,44 +1211,6 @@ qint64 FileOperateBaseWorker::getWriteDataSize()
     return writeSize;
 }
 
-qint64 FileOperateBaseWorker::getTidWriteSize()
-{
-    QFile file(QStringLiteral("/proc/self/task/%1/io").arg(copyTid));
-
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed on open the" << file.fileName() << ", will be not update the job speed and progress";
-
-        return 0;
-    }
-
-    const QByteArray &line_head = QByteArrayLiteral("write_bytes: ");
-    const QByteArray &all_data = file.readAll();
-
-    file.close();
-
-    QTextStream text_stream(all_data);
-
-    while (!text_stream.atEnd()) {
-        const QByteArray &line = text_stream.readLine().toLatin1();
-
-        if (line.startsWith(line_head)) {
-            bool ok = false;
-            qint64 size = line.mid(line_head.size()).toLongLong(&ok);
-
-            if (!ok) {
-                qWarning() << "Failed to convert to qint64, line string=" << line;
-
-                return 0;
-            }
-            return size;
-        }
-    }
-
-    qWarning() << "Failed to find \"" << line_head << "\" from the" << file.fileName();
-
-    return 0;
-}
-
 qint64 FileOperateBaseWorker::getSectorsWritten()
 {
     QByteArray data;
@@ -1260,6 +1284,11 @@ void FileOperateBaseWorker::determineCountProcessType()
         }
         qDebug("targetIsRemovable = %d", bool(targetIsRemovable));
     }
+
+    // the learned block size is kept per target device
+    const QString &deviceKey = QString("%1:%2").arg(QString(targetStorageInfo->device()), QString(targetStorageInfo->fileSystemType()));
+    blockTuner.reset(new CopyBlockTuner(workData, deviceKey));
+    blockTuner->load();
 }
 
 void FileOperateBaseWorker::syncFilesToDevice()
@@ -1268,10 +1297,19 @@ void FileOperateBaseWorker::syncFilesToDevice()
         return;
 
     qDebug() << __FUNCTION__ << "syncFilesToDevice begin";
-    qint64 writeSize = getWriteDataSize();
-    while (!isStopped() && sourceFilesTotalSize > 0 && writeSize < sourceFilesTotalSize) {
-        QThread::msleep(100);
-        writeSize = getWriteDataSize();
+    const std::string &targetPath = targetUrl.path().toStdString();
+    int fd = open(targetPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "open target dir for sync failed, url: " << targetUrl << " error msg: " << strerror(errno);
+        return;
     }
+    // the progress keeps following the writeback of the device while syncing
+    QFuture<void> future = QtConcurrent::run([fd]() {
+        syncfs(fd);
+        close(fd);
+    });
+    while (!isStopped() && !future.isFinished())
+        QThread::msleep(100);
+    targetDeviceSynced = future.isFinished();
     qDebug() << __FUNCTION__ << "syncFilesToDevice end";
 }
@@ -17,6 +17,7 @@ class QObject;
 DPFILEOPERATIONS_BEGIN_NAMESPACE
 class StorageInfo;
 class DoCopyFileWorker;
+class CopyBlockTuner;
 using StoragePointer = QSharedPointer<StorageInfo>;
 class FileOperateBaseWorker : public AbstractWorker, public QEnableSharedFromThis<AbstractFileInfo>
 {
@@ -34,12 +35,6 @@ public:
     using DirPermsissonPointer = QSharedPointer<DirSetPermissonInfo>;
     using DirPermissonList = DThreadList<DirPermsissonPointer>;
 
-    struct SmallFileThreadCopyInfo
-    {
-        AbstractFileInfoPointer fromInfo { nullptr };
-        AbstractFileInfoPointer toInfo { nullptr };
-    };
-
 public:
     bool doCheckFile(const AbstractFileInfoPointer &fromInfo, const AbstractFileInfoPointer &toInfo, const QString &fileName,
                      AbstractFileInfoPointer &newTargetInfo, bool *skip);
@@ -52,7 +47,6 @@ public:
     void setAllDirPermisson();
     void determineCountProcessType();
     qint64 getWriteDataSize();
-    qint64 getTidWriteSize();
     qint64 getSectorsWritten();
     void readAheadSourceFile(const AbstractFileInfoPointer &fileInfo);
     void syncFilesToDevice();
@@ -82,6 +76,7 @@ public:
 protected:
     void waitThreadPoolOver();
     void initCopyWay();
+    void waitStatisticsForCopyWay();
 
 private:
     void setSkipValue(bool *skip, AbstractJobHandler::SupportAction action);
@@ -93,6 +88,7 @@ private:
                              bool *skip, bool isCountSize = false);
     QUrl createNewTargetUrl(const AbstractFileInfoPointer &toInfo, const QString &fileName);
     bool doCopyLocalFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
+    void doCopySmallFileBatch();
     bool doCopyExBlockFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo);
     bool doCopyOtherFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip);
     bool doCopyLocalBigFile(const AbstractFileInfoPointer fromInfo, const AbstractFileInfoPointer toInfo, bool *skip);
@@ -134,8 +130,8 @@ protected:
     QTime time;   // time eslape
     AbstractFileInfoPointer targetInfo { nullptr };   // target file infor pointer
     StoragePointer targetStorageInfo { nullptr };   // target file's device infor
-    CountWriteSizeType countWriteType { CountWriteSizeType::kTidType };   // get write size type
-    long copyTid = { -1 };   // 使用 /pric/[pid]/task/[tid]/io 文件中的的 writeBytes 字段的值作为判断已写入数据的依据
+    CountWriteSizeType countWriteType { CountWriteSizeType::kCustomizeType };   // get write size type
+    std::atomic_bool targetDeviceSynced { false };   // all written data is on the removable device
     qint64 targetDeviceStartSectorsWritten { 0 };   // 记录任务开始时目标磁盘设备已写入扇区数
     QString targetSysDevPath;   // /sys/dev/block/x:x
     qint16 targetLogSecionSize { 512 };   // 目标设备逻辑扇区大小
@@ -143,6 +139,9 @@ protected:
     DirPermissonList dirPermissonList;   // dir set Permisson list
 
     std::atomic_int threadCopyFileCount { 0 };
+    QSharedPointer<CopyBlockTuner> blockTuner { nullptr };   // tune block size of buffered copy
+    bool smallFileBatchCopy { false };   // copy small local files in batch through io_uring
+    QList<WorkerData::SmallFileThreadCopyInfo> smallFileCopyInfos;   // small files wait for batch copy
 };
 DPFILEOPERATIONS_END_NAMESPACE
 
@@ -5,6 +5,7 @@
 #include "fileoperationsutils.h"
 #include "dfm-base/base/urlroute.h"
 #include "dfm-base/utils/fileutils.h"
+#include "dfm-base/utils/filesizewalker.h"
 
 #include <QDirIterator>
 #include <QUrl>
@@ -30,9 +31,10 @@ QSet<QString> FileOperationsUtils::fileNameUsing = {};
 QMutex FileOperationsUtils::mutex;
 
 /*!
- * \brief FileOperationsUtils::statisticsFilesSize 使用c库统计文件大小
- * 统计了所有文件的大小信息（如果文件大小 <= 0就统计这个文件大小为一个内存页，有些文件系统dir有大小，就统计dir大小，
- * 如果dir大小 <= 0就统计这个dir大小为一个内存页），统计文件的数量, 统计所有的文件及子目录路径
+ * \brief FileOperationsUtils::statisticsFilesSize 多线程统计文件大小
+ * 统计了所有文件的大小信息（如果文件大小 <= 0就统计这个文件大小为一个内存页，目录和链接文件统计为一个内存页），
+ * 统计文件的数量, 统计所有的文件及子目录路径（目录总是在它的子文件之前）
+ * 所有的源文件在同一个FileSizeWalker中统计，大小目录共用所有线程
  * \param files 统计文件的urllist
  * \param isRecordUrl 是否统计所有的文件及子目录路径
  * \return QSharedPointer<FileOperationsUtils::FilesSizeInfo> 文件大小信息
@@ -42,9 +44,13 @@ SizeInfoPointer FileOperationsUtils::statisticsFilesSize(const QList<QUrl> &file
     SizeInfoPointer filesSizeInfo(new DFMBASE_NAMESPACE::FileUtils::FilesSizeInfo);
     filesSizeInfo->dirSize = FileUtils::getMemoryPageSize();
 
-    for (auto url : files) {
-        statisticFilesSize(url, filesSizeInfo, isRecordUrl);
-    }
+    FileSizeWalker walker(isRecordUrl ? FileSizeWalker::kRecordUrls : FileSizeWalker::kNoFlag);
+    walker.walk(files);
+
+    filesSizeInfo->totalSize = walker.totalProgressSize();
+    filesSizeInfo->fileCount = static_cast<quint32>(walker.filesCount());
+    if (isRecordUrl)
+        filesSizeInfo->allFiles = walker.recordedUrls();
 
     return filesSizeInfo;
 }
@@ -86,48 +92,13 @@ void FileOperationsUtils::statisticFilesSize(const QUrl &url,
                                              SizeInfoPointer &sizeInfo,
                                              const bool &isRecordUrl)
 {
-    QSet<QUrl> urlCounted;
-
-    char *paths[2] = { nullptr, nullptr };
-    paths[0] = strdup(url.path().toUtf8().toStdString().data());
-    FTS *fts = fts_open(paths, 0, nullptr);
-    if (paths[0])
-        free(paths[0]);
+    FileSizeWalker walker(isRecordUrl ? FileSizeWalker::kRecordUrls : FileSizeWalker::kNoFlag);
+    walker.walk({ url });
 
-    if (nullptr == fts) {
-        perror("fts_open");
-        qWarning() << "fts_open open error : " << QString::fromLocal8Bit(strerror(errno));
-        return;
-    }
-    while (1) {
-        FTSENT *ent = fts_read(fts);
-        if (ent == nullptr) {
-            break;
-        }
-        const QUrl &curUrl = QUrl::fromLocalFile(ent->fts_path);
-        if (urlCounted.contains(curUrl))
-            continue;
-        urlCounted.insert(curUrl);
-
-        unsigned short flag = ent->fts_info;
-
-        const auto &fileSize = ent->fts_statp->st_size;
-
-        // url record
-        if (isRecordUrl && flag != FTS_DP)
-            sizeInfo->allFiles.append(curUrl);
-
-        // file counted
-        if (flag == FTS_F || flag == FTS_SL || flag == FTS_SLNONE)
-            sizeInfo->fileCount++;
-
-        // total size
-        if (flag == FTS_D)
-            sizeInfo->totalSize += FileUtils::getMemoryPageSize();
-        else if (flag != FTS_DP)
-            sizeInfo->totalSize += (fileSize > 0 ? fileSize : FileUtils::getMemoryPageSize());
-    }
-    fts_close(fts);
+    sizeInfo->totalSize += walker.totalProgressSize();
+    sizeInfo->fileCount += static_cast<quint32>(walker.filesCount());
+    if (isRecordUrl)
+        sizeInfo->allFiles.append(walker.recordedUrls());
 }
 
 bool FileOperationsUtils::isAncestorUrl(const QUrl &from, const QUrl &to)
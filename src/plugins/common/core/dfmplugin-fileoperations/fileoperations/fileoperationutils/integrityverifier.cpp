@@ -0,0 +1,281 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "integrityverifier.h"
+
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <cstring>
+#include <cstdlib>
+#include <array>
+
+#if defined(__x86_64__)
+#    include <nmmintrin.h>
+#endif
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+constexpr qint64 kDirectIOAlign { 4096 };
+constexpr qint64 kVerifyBufferSize { 1024 * 1024 };
+constexpr qint64 kVerifyChunkSize { 4 * 1024 * 1024 };   // verify thread wakes up every chunk written
+
+const quint32 *crc32cTable()
+{
+    static const auto table = [] {
+        std::array<quint32, 256> t {};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int j = 0; j < 8; ++j)
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+quint32 crc32cSoftware(quint32 crc, const uchar *data, size_t size)
+{
+    const quint32 *table = crc32cTable();
+    crc = ~crc;
+    while (size--)
+        crc = table[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) quint32 crc32cHardware(quint32 crc, const uchar *data, size_t size)
+{
+    quint64 crc64 = ~crc & 0xffffffff;
+    while (size >= sizeof(quint64)) {
+        quint64 value;
+        memcpy(&value, data, sizeof(value));
+        crc64 = _mm_crc32_u64(crc64, value);
+        data += sizeof(quint64);
+        size -= sizeof(quint64);
+    }
+    quint32 crc32 = static_cast<quint32>(crc64);
+    while (size--)
+        crc32 = _mm_crc32_u8(crc32, *data++);
+    return ~crc32;
+}
+#endif
+
+bool hasCrc32cHardware()
+{
+#if defined(__x86_64__)
+    static const bool hasSse42 = __builtin_cpu_supports("sse4.2");
+    return hasSse42;
+#else
+    return false;
+#endif
+}
+
+quint32 crc32c(quint32 crc, const uchar *data, size_t size)
+{
+#if defined(__x86_64__)
+    if (hasCrc32cHardware())
+        return crc32cHardware(crc, data, size);
+#endif
+    return crc32cSoftware(crc, data, size);
+}
+}   // namespace
+
+IntegrityVerifier::IntegrityVerifier(const QSharedPointer<WorkerData> &data, const ChecksumType type, const QString &targetPath)
+    : workData(data), type(type)
+{
+    sourceSum = initialChecksum(type);
+    targetSum = sourceSum;
+
+    const std::string &path = targetPath.toStdString();
+    // read from disk instead of the page cache filled by the copy,
+    // O_DIRECT is not supported by some file systems (eg. tmpfs, fuse)
+    targetFd = open(path.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (targetFd < 0 && errno == EINVAL)
+        targetFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (targetFd < 0) {
+        qWarning() << "open target file for integrity checking failed, path: " << targetPath << " error msg: " << strerror(errno);
+        return;
+    }
+
+    void *alignedBuffer = nullptr;
+    if (posix_memalign(&alignedBuffer, kDirectIOAlign, kVerifyBufferSize) == 0)
+        buffer = static_cast<char *>(alignedBuffer);
+}
+
+IntegrityVerifier::~IntegrityVerifier()
+{
+    {
+        QMutexLocker lk(&mutex);
+        writeFinished = true;
+        canceled = true;
+        writtenCondition.wakeAll();
+    }
+    verifyFuture.waitForFinished();
+
+    if (targetFd >= 0)
+        close(targetFd);
+    free(buffer);
+}
+
+bool IntegrityVerifier::isValid() const
+{
+    return targetFd >= 0 && buffer;
+}
+
+/*!
+ * \brief IntegrityVerifier::updateSource Update the source checksum with the buffer written to target
+ * \param data buffer read from source
+ * \param size buffer size
+ */
+void IntegrityVerifier::updateSource(const char *data, const qint64 size)
+{
+    sourceSum = checksum(type, sourceSum, data, size);
+}
+
+/*!
+ * \brief IntegrityVerifier::written The size of data has been written to the end of target,
+ * the verify thread is started once the file is big enough
+ * \param size written size
+ */
+void IntegrityVerifier::written(const qint64 size)
+{
+    QMutexLocker lk(&mutex);
+    writtenSize += size;
+    if (verifyStarted) {
+        if (writtenSize - verifiedSize >= kVerifyChunkSize)
+            writtenCondition.wakeAll();
+        return;
+    }
+
+    if (writtenSize >= kVerifyChunkSize) {
+        verifyStarted = true;
+        verifyFuture = QtConcurrent::run([this]() { verifyTarget(); });
+    }
+}
+
+/*!
+ * \brief IntegrityVerifier::finish All data is written, wait for the rest of target verified
+ * \return whether the checksum of target is same with source
+ */
+bool IntegrityVerifier::finish()
+{
+    {
+        QMutexLocker lk(&mutex);
+        writeFinished = true;
+        writtenCondition.wakeAll();
+    }
+
+    // small file, verify in current thread
+    if (!verifyStarted)
+        verifyTarget();
+    verifyFuture.waitForFinished();
+
+    if (readFailed)
+        return false;
+    return sourceSum == targetSum;
+}
+
+quint32 IntegrityVerifier::sourceChecksum() const
+{
+    return sourceSum;
+}
+
+quint32 IntegrityVerifier::targetChecksum() const
+{
+    return targetSum;
+}
+
+quint32 IntegrityVerifier::checksum(const ChecksumType type, quint32 sum, const char *data, const qint64 size)
+{
+    if (size <= 0)
+        return sum;
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    if (type == ChecksumType::kCrc32c)
+        return crc32c(sum, bytes, static_cast<size_t>(size));
+
+    return static_cast<quint32>(adler32(sum, bytes, static_cast<uInt>(size)));
+}
+
+/*!
+ * \brief IntegrityVerifier::preferredType crc32c if the cpu calculates it, it is faster than adler32 then,
+ * the table driven crc32c is slower than adler32
+ */
+IntegrityVerifier::ChecksumType IntegrityVerifier::preferredType()
+{
+    return hasCrc32cHardware() ? ChecksumType::kCrc32c : ChecksumType::kAdler32;
+}
+
+quint32 IntegrityVerifier::initialChecksum(const ChecksumType type)
+{
+    if (type == ChecksumType::kCrc32c)
+        return 0;
+    return static_cast<quint32>(adler32(0L, nullptr, 0));
+}
+
+void IntegrityVerifier::verifyTarget()
+{
+    if (!isValid()) {
+        readFailed = true;
+        return;
+    }
+
+    Q_FOREVER {
+        qint64 end = 0;
+        bool finished = false;
+        {
+            QMutexLocker lk(&mutex);
+            while (!writeFinished && writtenSize - verifiedSize < kVerifyChunkSize)
+                writtenCondition.wait(&mutex);
+            if (canceled)
+                return;
+            end = writtenSize;
+            finished = writeFinished;
+        }
+
+        // only the tail of target can be read at unaligned end
+        if (!finished)
+            end = end / kDirectIOAlign * kDirectIOAlign;
+
+        if (!readTarget(end)) {
+            readFailed = true;
+            return;
+        }
+
+        if (finished)
+            return;
+    }
+}
+
+bool IntegrityVerifier::readTarget(const qint64 end)
+{
+    while (verifiedSize < end) {
+        const qint64 size = qMin(kVerifyBufferSize, end - verifiedSize);
+        const qint64 alignedSize = (size + kDirectIOAlign - 1) / kDirectIOAlign * kDirectIOAlign;
+        ssize_t ret = pread(targetFd, buffer, static_cast<size_t>(alignedSize), verifiedSize);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0) {
+            qWarning() << "read target file for integrity checking failed, pos: " << verifiedSize
+                       << " error msg: " << (ret < 0 ? strerror(errno) : "unexpected end of file");
+            return false;
+        }
+
+        const qint64 readSize = qMin(static_cast<qint64>(ret), size);
+        targetSum = checksum(type, targetSum, buffer, readSize);
+        {
+            QMutexLocker lk(&mutex);
+            verifiedSize += readSize;
+        }
+        workData->verifiedSize += readSize;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INTEGRITYVERIFIER_H
+#define INTEGRITYVERIFIER_H
+
+#include "dfmplugin_fileoperations_global.h"
+#include "workerdata.h"
+
+#include <QSharedPointer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFuture>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \class IntegrityVerifier
+ * \brief Verify the integrity of a copied file while it is being written.
+ * The source checksum is calculated from the written buffers, and the written range of the
+ * target is read back with O_DIRECT (from the disk instead of the page cache) and hashed on
+ * a separate thread, so the target is never read again after the copy.
+ */
+class IntegrityVerifier
+{
+public:
+    enum class ChecksumType : quint8 {
+        kAdler32,
+        kCrc32c,   // hardware accelerated on sse4.2
+    };
+
+    IntegrityVerifier(const QSharedPointer<WorkerData> &data, const ChecksumType type, const QString &targetPath);
+    ~IntegrityVerifier();
+
+    bool isValid() const;
+    void updateSource(const char *data, const qint64 size);
+    void written(const qint64 size);
+    bool finish();
+    quint32 sourceChecksum() const;
+    quint32 targetChecksum() const;
+
+    static quint32 checksum(const ChecksumType type, quint32 sum, const char *data, const qint64 size);
+    static quint32 initialChecksum(const ChecksumType type);
+    static ChecksumType preferredType();
+
+private:
+    void verifyTarget();
+    bool readTarget(const qint64 end);
+
+private:
+    QSharedPointer<WorkerData> workData { nullptr };
+    ChecksumType type { ChecksumType::kAdler32 };
+    int targetFd { -1 };
+    char *buffer { nullptr };   // aligned for O_DIRECT
+    quint32 sourceSum { 0 };
+    quint32 targetSum { 0 };
+    qint64 verifiedSize { 0 };
+    qint64 writtenSize { 0 };
+    bool writeFinished { false };
+    bool canceled { false };   // copy failed, no need to verify
+    bool verifyStarted { false };
+    bool readFailed { false };
+    QMutex mutex;
+    QWaitCondition writtenCondition;
+    QFuture<void> verifyFuture;
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // INTEGRITYVERIFIER_H
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "progresscounter.h"
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+// every thread takes the next slot the first time it writes
+int currentThreadSlot(const int slotCount)
+{
+    static std::atomic_int nextSlot { 0 };
+    thread_local const int slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    return slot % slotCount;
+}
+}   // namespace
+
+void ProgressCounter::add(const qint64 size)
+{
+    slots[currentThreadSlot(kSlotCount)].size.fetch_add(size, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief ProgressCounter::value Sum of all slots, called by the progress timer
+ * \return written size
+ */
+qint64 ProgressCounter::value() const
+{
+    qint64 size = 0;
+    for (const Slot &slot : slots)
+        size += slot.size.load(std::memory_order_relaxed);
+    return size;
+}
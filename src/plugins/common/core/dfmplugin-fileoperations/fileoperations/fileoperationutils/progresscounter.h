@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROGRESSCOUNTER_H
+#define PROGRESSCOUNTER_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QtGlobal>
+
+#include <atomic>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \class ProgressCounter
+ * \brief Count the bytes written by all copy threads of a job.
+ * Every thread adds to its own cache line, and the slots are only summed when the
+ * progress timer asks for the value, so the copy threads never contend on one atomic.
+ */
+class ProgressCounter
+{
+public:
+    ProgressCounter() = default;
+    ProgressCounter(const ProgressCounter &) = delete;
+    ProgressCounter &operator=(const ProgressCounter &) = delete;
+
+    void add(const qint64 size);
+    qint64 value() const;
+
+private:
+    static constexpr int kSlotCount { 16 };
+    struct alignas(64) Slot
+    {
+        std::atomic_int64_t size { 0 };
+    };
+    Slot slots[kSlotCount];
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // PROGRESSCOUNTER_H
@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "uringcopyengine.h"
+
+#include <QDebug>
+
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+
+#ifdef ENABLE_IO_URING
+#    include <liburing.h>
+#endif
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+#ifdef ENABLE_IO_URING
+constexpr unsigned kQueueDepth { 256 };
+constexpr int kOperationsPerFile { 6 };
+constexpr int kMaxFilesPerWave { kQueueDepth / kOperationsPerFile };
+constexpr unsigned kFileSlotCount { kMaxFilesPerWave * 2 };
+constexpr size_t kMaxWaveBufferSize { 16 * 1024 * 1024 };
+
+// every file is copied by the linked chain of these operations
+enum Operation : quint64 {
+    kOpenSource,
+    kRead,
+    kOpenTarget,
+    kWrite,
+    kCloseSource,
+    kCloseTarget,
+    kClearSlot,
+};
+
+inline void *operationTag(const int waveIndex, const Operation op)
+{
+    return reinterpret_cast<void *>((static_cast<quint64>(waveIndex) << 3) | op);
+}
+#endif
+}   // namespace
+
+UringCopyEngine::UringCopyEngine()
+{
+    if (!init())
+        release();
+}
+
+UringCopyEngine::~UringCopyEngine()
+{
+    release();
+}
+
+/*!
+ * \brief UringCopyEngine::isSupported Whether io_uring can be used by the current process,
+ * the kernel is probed only once
+ * \return supported
+ */
+bool UringCopyEngine::isSupported()
+{
+#ifdef ENABLE_IO_URING
+    static const bool supported = [] {
+        io_uring ring;
+        if (io_uring_queue_init(8, &ring, 0) != 0)
+            return false;
+
+        bool ret = false;
+        io_uring_probe *probe = io_uring_get_probe_ring(&ring);
+        if (probe) {
+            ret = io_uring_opcode_supported(probe, IORING_OP_OPENAT)
+                    && io_uring_opcode_supported(probe, IORING_OP_READ)
+                    && io_uring_opcode_supported(probe, IORING_OP_WRITE)
+                    && io_uring_opcode_supported(probe, IORING_OP_CLOSE)
+                    // mkdirat comes with the direct descriptors in linux 5.15,
+                    // which can not be probed directly
+                    && io_uring_opcode_supported(probe, IORING_OP_MKDIRAT);
+            io_uring_free_probe(probe);
+        }
+        io_uring_queue_exit(&ring);
+
+        qInfo() << "io_uring copy engine supported: " << ret;
+        return ret;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool UringCopyEngine::isValid() const
+{
+    return ring != nullptr;
+}
+
+/*!
+ * \brief UringCopyEngine::copy Copy the tasks in waves, every wave submits the chains of
+ * as many files as the queue depth and the buffer allow and waits for all of them.
+ * The task whose chain failed keeps finished false, the caller copies it again in the
+ * normal way which reports the error.
+ * \param tasks files to copy, the size must be larger than 0
+ * \param onFileFinished called with the file size for every finished file
+ * \param canContinue called before every wave, it may block while the job is paused,
+ * the tasks left are not copied if it returns false
+ */
+void UringCopyEngine::copy(QVector<CopyTask> &tasks, const std::function<void(qint64)> &onFileFinished,
+                           const std::function<bool()> &canContinue)
+{
+#ifdef ENABLE_IO_URING
+    if (!ring)
+        return;
+
+    int waveBegin = 0;
+    while (waveBegin < tasks.size()) {
+        if (canContinue && !canContinue())
+            return;
+
+        // collect the files of current wave
+        int waveEnd = waveBegin;
+        size_t waveBufferSize = 0;
+        while (waveEnd < tasks.size() && waveEnd - waveBegin < kMaxFilesPerWave
+               && waveBufferSize + tasks.at(waveEnd).size <= kMaxWaveBufferSize) {
+            waveBufferSize += tasks.at(waveEnd).size;
+            ++waveEnd;
+        }
+        // file too big for the wave buffer, leave it to the caller
+        if (waveEnd == waveBegin) {
+            ++waveBegin;
+            continue;
+        }
+
+        if (buffer.size() < waveBufferSize)
+            buffer.resize(waveBufferSize);
+
+        // submit the linked chains
+        const int fileCount = waveEnd - waveBegin;
+        char *data = buffer.data();
+        for (int i = 0; i < fileCount; ++i) {
+            const CopyTask &task = tasks.at(waveBegin + i);
+            const unsigned sourceSlot = static_cast<unsigned>(i * 2);
+            const unsigned targetSlot = sourceSlot + 1;
+            const unsigned size = static_cast<unsigned>(task.size);
+
+            io_uring_sqe *sqe = io_uring_get_sqe(ring);
+            io_uring_prep_openat_direct(sqe, AT_FDCWD, task.fromPath.c_str(), O_RDONLY, 0, sourceSlot);
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, operationTag(i, kOpenSource));
+
+            sqe = io_uring_get_sqe(ring);
+            io_uring_prep_read(sqe, static_cast<int>(sourceSlot), data, size, 0);
+            sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, operationTag(i, kRead));
+
+            sqe = io_uring_get_sqe(ring);
+            io_uring_prep_openat_direct(sqe, AT_FDCWD, task.toPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, task.mode, targetSlot);
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, operationTag(i, kOpenTarget));
+
+            sqe = io_uring_get_sqe(ring);
+            io_uring_prep_write(sqe, static_cast<int>(targetSlot), data, size, 0);
+            sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, operationTag(i, kWrite));
+
+            sqe = io_uring_get_sqe(ring);
+            io_uring_prep_close_direct(sqe, sourceSlot);
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, operationTag(i, kCloseSource));
+
+            sqe = io_uring_get_sqe(ring);
+            io_uring_prep_close_direct(sqe, targetSlot);
+            io_uring_sqe_set_data(sqe, operationTag(i, kCloseTarget));
+
+            data += task.size;
+        }
+
+        QVector<bool> failed(fileCount, false);
+        int pending = fileCount * kOperationsPerFile;
+        int ret = io_uring_submit(ring);
+        if (ret < 0) {
+            qWarning() << "io_uring submit failed, error msg: " << strerror(-ret);
+            // the ring is reused by the next batch, drop it rather than leave operations in it
+            release();
+            return;
+        }
+
+        // reap all completions of current wave, the cancelled operations complete too
+        while (pending > 0) {
+            io_uring_cqe *cqe = nullptr;
+            ret = io_uring_wait_cqe(ring, &cqe);
+            if (ret == -EINTR)
+                continue;
+            if (ret < 0) {
+                qWarning() << "io_uring wait failed, error msg: " << strerror(-ret);
+                release();
+                return;
+            }
+
+            const quint64 tag = reinterpret_cast<quint64>(io_uring_cqe_get_data(cqe));
+            const int index = static_cast<int>(tag >> 3);
+            const Operation op = static_cast<Operation>(tag & 0x7);
+            const int res = cqe->res;
+            io_uring_cqe_seen(ring, cqe);
+            --pending;
+
+            const qint64 expectSize = static_cast<qint64>(tasks.at(waveBegin + index).size);
+            if (res < 0 || ((op == kRead || op == kWrite) && res != expectSize))
+                failed[index] = true;
+        }
+
+        QVector<int> failedTasks;
+        for (int i = 0; i < fileCount; ++i) {
+            if (failed.at(i)) {
+                failedTasks.append(i);
+                continue;
+            }
+            CopyTask &task = tasks[waveBegin + i];
+            task.finished = true;
+            if (onFileFinished)
+                onFileFinished(static_cast<qint64>(task.size));
+        }
+        if (!failedTasks.isEmpty())
+            clearFileSlots(failedTasks);
+
+        waveBegin = waveEnd;
+    }
+#else
+    Q_UNUSED(tasks)
+    Q_UNUSED(onFileFinished)
+    Q_UNUSED(canContinue)
+#endif
+}
+
+bool UringCopyEngine::init()
+{
+#ifdef ENABLE_IO_URING
+    if (!isSupported())
+        return false;
+
+    ring = new io_uring;
+    int ret = io_uring_queue_init(kQueueDepth, ring, 0);
+    if (ret != 0) {
+        qWarning() << "io_uring init failed, error msg: " << strerror(-ret);
+        delete ring;
+        ring = nullptr;
+        return false;
+    }
+
+    // sparse table of direct descriptors used by openat/read/write/close
+    std::vector<int> slots(kFileSlotCount, -1);
+    ret = io_uring_register_files(ring, slots.data(), kFileSlotCount);
+    if (ret != 0) {
+        qWarning() << "io_uring register files failed, error msg: " << strerror(-ret);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UringCopyEngine::release()
+{
+#ifdef ENABLE_IO_URING
+    if (!ring)
+        return;
+    // the registered files are closed when the ring exits
+    io_uring_queue_exit(ring);
+    delete ring;
+    ring = nullptr;
+#endif
+}
+
+/*!
+ * \brief UringCopyEngine::clearFileSlots The close operations of a broken chain are cancelled,
+ * close the direct descriptors left in the slots before they are used by the next wave
+ * \param failedTasks index in wave of failed tasks, the slots are indexed by the position in wave
+ */
+void UringCopyEngine::clearFileSlots(const QVector<int> &failedTasks)
+{
+#ifdef ENABLE_IO_URING
+    int pending = 0;
+    for (int index : failedTasks) {
+        for (unsigned slot : { static_cast<unsigned>(index * 2), static_cast<unsigned>(index * 2 + 1) }) {
+            io_uring_sqe *sqe = io_uring_get_sqe(ring);
+            if (!sqe)
+                break;
+            io_uring_prep_close_direct(sqe, slot);
+            io_uring_sqe_set_data(sqe, operationTag(index, kClearSlot));
+            ++pending;
+        }
+    }
+
+    if (io_uring_submit(ring) < 0)
+        return;
+
+    // the slot may be empty already, result is not cared
+    while (pending > 0) {
+        io_uring_cqe *cqe = nullptr;
+        int ret = io_uring_wait_cqe(ring, &cqe);
+        if (ret == -EINTR)
+            continue;
+        if (ret < 0)
+            return;
+        io_uring_cqe_seen(ring, cqe);
+        --pending;
+    }
+#else
+    Q_UNUSED(failedTasks)
+#endif
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef URINGCOPYENGINE_H
+#define URINGCOPYENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QVector>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+struct io_uring;
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \class UringCopyEngine
+ * \brief Copy many small files through io_uring, the openat/read/write/close of every file
+ * is submitted as one linked chain, and the chains of many files are in flight together.
+ * Only available when built with liburing and the running kernel supports direct descriptors.
+ * The ring and its file slots are set up once, keep the engine for all the batches of a worker.
+ */
+class UringCopyEngine
+{
+public:
+    struct CopyTask
+    {
+        std::string fromPath;
+        std::string toPath;
+        size_t size { 0 };
+        mode_t mode { 0666 };
+        bool finished { false };   // output: file copied completely
+    };
+
+    UringCopyEngine();
+    ~UringCopyEngine();
+
+    static bool isSupported();
+    bool isValid() const;
+    void copy(QVector<CopyTask> &tasks, const std::function<void(qint64)> &onFileFinished,
+              const std::function<bool()> &canContinue = nullptr);
+
+private:
+    bool init();
+    void release();
+    void clearFileSlots(const QVector<int> &failedTasks);
+
+private:
+    io_uring *ring { nullptr };
+    std::vector<char> buffer;
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // URINGCOPYENGINE_H
@@ -8,3 +8,32 @@ DPFILEOPERATIONS_USE_NAMESPACE
 WorkerData::WorkerData()
 {
 }
+
+/*!
+ * \brief WorkerData::copyMethodOf Get the copy method used between the source and target device
+ * \param devices source and target st_dev
+ * \param defaultMethod method used when the device pair is first met
+ * \return copy method
+ */
+WorkerData::CopyMethod WorkerData::copyMethodOf(const DevicePair &devices, const CopyMethod defaultMethod)
+{
+    QMutexLocker lk(&copyMethodMutex);
+    auto it = copyMethodOfDevices.find(devices);
+    if (it == copyMethodOfDevices.end())
+        it = copyMethodOfDevices.insert(devices, defaultMethod);
+    return it.value();
+}
+
+/*!
+ * \brief WorkerData::demoteCopyMethod The method is not supported by the device pair,
+ * all following files of this pair use the next cheaper method
+ * \param devices source and target st_dev
+ * \param failedMethod method that failed
+ */
+void WorkerData::demoteCopyMethod(const DevicePair &devices, const CopyMethod failedMethod)
+{
+    QMutexLocker lk(&copyMethodMutex);
+    CopyMethod &method = copyMethodOfDevices[devices];
+    if (method <= failedMethod && failedMethod != CopyMethod::kBuffered)
+        method = static_cast<CopyMethod>(static_cast<quint8>(failedMethod) + 1);
+}
@@ -5,12 +5,16 @@
 #ifndef WORKERDATA_H
 #define WORKERDATA_H
 #include "dfmplugin_fileoperations_global.h"
+#include "blockcopyqueue.h"
+#include "progresscounter.h"
 #include <dfm-base/interfaces/abstractjobhandler.h>
 #include <dfm-base/interfaces/abstractfileinfo.h>
 #include <dfm-base/utils/threadcontainer.hpp>
 
 #include <QSharedPointer>
 #include <QQueue>
+#include <QMutex>
+#include <QMap>
 
 #include <fcntl.h>
 
@@ -27,6 +31,8 @@ public:
         AbstractFileInfoPointer frominfo;
         AbstractFileInfoPointer toinfo;
         char *buffer;
+        qint64 bufferSize { 0 };   // capacity of buffer
+        BlockBufferPool *bufferPool { nullptr };   // buffer is given back to the pool
         qint64 size;
         qint64 currentpos;
         QFileDevice::Permissions permission;
@@ -34,32 +40,62 @@ public:
             : closeflag(true), isdir(false), frominfo(nullptr), toinfo(nullptr), buffer(nullptr), size(0), currentpos(0), permission(QFileDevice::ReadOwner)
         {
         }
-        BlockFileCopyInfo(const BlockFileCopyInfo &other)
-            : closeflag(other.closeflag), isdir(other.isdir), frominfo(other.frominfo), toinfo(other.toinfo), buffer(other.buffer), size(other.size), currentpos(other.currentpos), permission(other.permission)
+        BlockFileCopyInfo(const BlockFileCopyInfo &other) = delete;
+        ~BlockFileCopyInfo()
         {
+            releaseBuffer();
         }
-        ~BlockFileCopyInfo(){
-            if (buffer) {
-                delete []buffer;
-                buffer = nullptr;
-            }
+        void releaseBuffer()
+        {
+            if (buffer && bufferPool)
+                bufferPool->release({ buffer, bufferSize });
+            buffer = nullptr;
+            bufferSize = 0;
         }
     };
 
+    struct SmallFileThreadCopyInfo
+    {
+        AbstractFileInfoPointer fromInfo { nullptr };
+        AbstractFileInfoPointer toInfo { nullptr };
+    };
+
+    // The way file content is transferred between a pair of filesystems,
+    // ordered from the cheapest to the most expensive one
+    enum class CopyMethod : quint8 {
+        kReflink,   // FICLONE, metadata only on btrfs/xfs
+        kCopyFileRange,   // copy_file_range, in-kernel copy
+        kSendFile,   // sendfile, in-kernel copy without fs support
+        kBuffered,   // read/write through user-space buffer
+    };
+    using DevicePair = QPair<quint64, quint64>;
+    static constexpr quint64 kBlockCopyQueueCapacity { 1024 };   // more than the max in-flight blocks
+
     WorkerData();
 
+    CopyMethod copyMethodOf(const DevicePair &devices, const CopyMethod defaultMethod);
+    void demoteCopyMethod(const DevicePair &devices, const CopyMethod failedMethod);
+
     quint16 dirSize { 0 };   // size of dir
     AbstractJobHandler::JobFlags jobFlags { AbstractJobHandler::JobFlag::kNoHint };   // job flag
     QMap<AbstractJobHandler::JobErrorType, AbstractJobHandler::SupportAction> errorOfAction;
     std::atomic_bool needSyncEveryRW { false };
     std::atomic_bool isFsTypeVfat { false };
-    std::atomic_int64_t currentWriteSize { 0 };
+    ProgressCounter currentWriteSize;   // size written by all copy threads
+    std::atomic_int64_t verifiedSize { 0 };   // size of target verified by IntegrityVerifier
+    std::atomic_int64_t copyBlockSize { 1024 * 1024 };   // block size of the buffered copy, tuned by CopyBlockTuner
+    std::atomic_int inFlightBlockCount { 64 };   // blocks read ahead or queued for block device, tuned by CopyBlockTuner
     QAtomicInteger<qint64> zeroOrlinkOrDirWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
     QAtomicInteger<qint64> blockRenameWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
     QAtomicInteger<qint64> skipWriteSize { 0 };   // 跳过的文件大
     QAtomicInteger<qint64> completeFileCount { 0 };   // copy complete file count
     std::atomic_bool signalThread { true };
-    DThreadList<QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>> blockCopyInfoQueue;
+    BlockBufferPool blockBufferPool { inFlightBlockCount };   // keep it before the queue, the queued blocks give buffers back on destruction
+    BlockRingQueue<QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>> blockCopyInfoQueue { kBlockCopyQueueCapacity };
+
+private:
+    QMutex copyMethodMutex;
+    QMap<DevicePair, CopyMethod> copyMethodOfDevices;   // (source st_dev, target st_dev) -> copy method
 };
 DPFILEOPERATIONS_END_NAMESPACE
 using BlockFileCopyInfoPointer = QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>;
@@ -22,12 +22,24 @@
 #include <QDebug>
 #include <QProcess>
 #include <QVariant>
+#include <QThread>
+#include <QSqlError>
 
 DPTAG_USE_NAMESPACE
 USING_IO_NAMESPACE
 
 static constexpr char kTagTableFileTags[] = "file_tags";
 static constexpr char kTagTableTagProperty[] = "tag_property";
+// values bound to one "IN (...)", below the 999 variables limit of old sqlite
+static constexpr int kBatchCount { 256 };
+
+static QString batchPlaceholders()
+{
+    QStringList placeholders;
+    for (int i = 0; i < kBatchCount; ++i)
+        placeholders.append("?");
+    return placeholders.join(',');
+}
 
 TagDbHandle *TagDbHandle::instance()
 {
@@ -97,20 +109,17 @@ QVariantMap TagDbHandle::getTagsByUrls(const QStringList &urlList)
         return {};
     }
 
-    // query
-    const auto &field = Expression::Field<FileTagInfo>;
-    QVariantMap allFileTags;
-    for (auto &path : urlList) {
-        const auto &beanList = handle->query<FileTagInfo>().where(field("filePath") == path).toBeans();
-
-        QStringList fileTags;
-        for (auto oneBean : beanList)
-            fileTags.append(oneBean->getTagName());
-
-        if (!fileTags.isEmpty())
-            allFileTags.insert(path, fileTags);
+    // query in batches instead of one query for each file
+    QHash<QString, QStringList> fileTags;
+    for (int i = 0; i < urlList.count(); i += kBatchCount) {
+        if (!queryTagsOfFiles(urlList.mid(i, kBatchCount), &fileTags))
+            return {};
     }
 
+    QVariantMap allFileTags;
+    for (auto it = fileTags.cbegin(); it != fileTags.cend(); ++it)
+        allFileTags.insert(it.key(), it.value());
+
     finally.dismiss();
     return allFileTags;
 }
@@ -314,9 +323,8 @@ bool TagDbHandle::deleteFiles(const QStringList &urls)
         return false;
     }
 
-    auto field = Expression::Field<FileTagInfo>;
-    for (const auto &url : urls) {
-        if (!handle->remove<FileTagInfo>(field("filePath") == url))
+    for (int i = 0; i < urls.count(); i += kBatchCount) {
+        if (!removeFiles(urls.mid(i, kBatchCount)))
             return false;
     }
 
@@ -384,10 +392,25 @@ bool TagDbHandle::changeFilePaths(const QVariantMap &data)
         return false;
     }
 
-    auto it = data.begin();
-    for (; it != data.end(); ++it)
-        if (!changeFilePath(it.key(), it.value().toString()))
-            return false;
+    // the moved files with their descendants, notified as untagged at the old path and tagged at the new path
+    QVariantMap untaggedFiles;
+    QVariantMap taggedFiles;
+    bool ret = handle->transaction([&]() -> bool {
+        auto it = data.begin();
+        for (; it != data.end(); ++it) {
+            if (!changeFilePath(it.key(), it.value().toString(), &untaggedFiles, &taggedFiles))
+                return false;
+        }
+        return true;
+    });
+
+    if (!ret)
+        return false;
+
+    if (!untaggedFiles.isEmpty()) {
+        emit filesUntagged(untaggedFiles);
+        emit filesWereTagged(taggedFiles);
+    }
 
     finally.dismiss();
     return true;
@@ -409,9 +432,9 @@ bool TagDbHandle::checkDatabase()
     if (!dir.exists())
         dir.mkpath(dbPath);
 
-    const auto &dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
-                                                     Global::DataBase::kDfmDBName,
-                                                     nullptr);
+    dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
+                                         Global::DataBase::kDfmDBName,
+                                         nullptr);
     handle = new SqliteHandle(dbFilePath);
     QSqlDatabase db { SqliteConnectionPool::instance().openConnection(dbFilePath) };
     if (!db.isValid() || db.isOpenError()) {
@@ -426,7 +449,7 @@ bool TagDbHandle::checkDatabase()
     if (!checkTableExists(kTagTableFileTags))
         return false;
 
-    return true;
+    return createIndexes();
 }
 
 bool TagDbHandle::checkTag(const QString &tag)
@@ -574,22 +597,80 @@ bool TagDbHandle::changeTagNameWithFile(const QString &tagName, const QString &n
     return ret;
 }
 
-bool TagDbHandle::changeFilePath(const QString &oldPath, const QString &newPath)
+/*!
+ * \brief TagDbHandle::changeFilePath Move the file and all files below it to the new path,
+ * the rows are found by a range of the path index and rewritten by one statement.
+ * \param oldFiles the tags of the moved files at the old paths are inserted to it
+ * \param newFiles the tags of the moved files at the new paths are inserted to it
+ */
+bool TagDbHandle::changeFilePath(const QString &oldPath, const QString &newPath, QVariantMap *oldFiles, QVariantMap *newFiles)
 {
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
     if (oldPath.isEmpty() || newPath.isEmpty()) {
         lastErr = "input parameter is empty!";
         return false;
     }
 
-    const auto &field = Expression::Field<FileTagInfo>;
-    if (!handle->update<TagProperty>(field("filePath") = newPath, field("filePath") == oldPath)) {
-        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(oldPath);
+    QString oldDir = oldPath;
+    while (oldDir.length() > 1 && oldDir.endsWith('/'))
+        oldDir.chop(1);
+    QString newDir = newPath;
+    while (newDir.length() > 1 && newDir.endsWith('/'))
+        newDir.chop(1);
+    if (oldDir == newDir)
+        return true;
+
+    // '0' is the next character of '/', so the range contains all paths below the directory
+    const QVariantList &range { oldDir, oldDir + "/", oldDir + "0" };
+    static const QString selectSql = QString("SELECT filePath, tagName FROM %1 WHERE filePath = ? OR (filePath >= ? AND filePath < ?) ORDER BY fileIndex;")
+                                             .arg(kTagTableFileTags);
+    static const QString updateSql = QString("UPDATE %1 SET filePath = ? || substr(filePath, length(?) + 1) WHERE filePath = ? OR (filePath >= ? AND filePath < ?);")
+                                             .arg(kTagTableFileTags);
+
+    const auto &selectQuery = preparedQuery(selectSql);
+    if (!selectQuery)
+        return false;
+    for (int i = 0; i < range.count(); ++i)
+        selectQuery->bindValue(i, range.at(i));
+    if (!selectQuery->exec()) {
+        lastErr = QString("Query moved files failed! oldPath: %1, error: %2").arg(oldDir).arg(selectQuery->lastError().text());
         return false;
     }
 
-    finally.dismiss();
+    QHash<QString, QStringList> movedFiles;
+    QStringList movedOrder;
+    while (selectQuery->next()) {
+        const QString &path = selectQuery->value(0).toString();
+        if (!movedFiles.contains(path))
+            movedOrder.append(path);
+        movedFiles[path].append(selectQuery->value(1).toString());
+    }
+    selectQuery->finish();
+
+    if (movedFiles.isEmpty())
+        return true;
+
+    const auto &updateQuery = preparedQuery(updateSql);
+    if (!updateQuery)
+        return false;
+    updateQuery->bindValue(0, newDir);
+    updateQuery->bindValue(1, oldDir);
+    for (int i = 0; i < range.count(); ++i)
+        updateQuery->bindValue(i + 2, range.at(i));
+    if (!updateQuery->exec()) {
+        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2, error: %3")
+                          .arg(oldDir)
+                          .arg(newDir)
+                          .arg(updateQuery->lastError().text());
+        return false;
+    }
+    updateQuery->finish();
+
+    for (const QString &path : movedOrder) {
+        const QVariant &tags = QVariant(movedFiles.value(path));
+        oldFiles->insert(path, tags);
+        newFiles->insert(newDir + path.mid(oldDir.length()), tags);
+    }
+
     return true;
 }
 
@@ -629,3 +710,118 @@ bool TagDbHandle::createTable(const QString &tableName)
 
     return ret;
 }
+
+bool TagDbHandle::createIndexes()
+{
+    // files are looked up by path and by tag, without indexes every lookup scans the whole table
+    return handle->excute(QString("CREATE INDEX IF NOT EXISTS file_tags_path_index ON %1(filePath);").arg(kTagTableFileTags))
+            && handle->excute(QString("CREATE INDEX IF NOT EXISTS file_tags_tag_index ON %1(tagName);").arg(kTagTableFileTags));
+}
+
+/*!
+ * \brief TagDbHandle::queryTagsOfFiles Query the tags of at most kBatchCount files in one statement
+ * \param fileTags the tags are appended to it by path, in the order they were added
+ */
+bool TagDbHandle::queryTagsOfFiles(const QStringList &paths, QHash<QString, QStringList> *fileTags)
+{
+    static const QString sql = QString("SELECT filePath, tagName FROM %1 WHERE filePath IN (%2) ORDER BY fileIndex;")
+                                       .arg(kTagTableFileTags)
+                                       .arg(batchPlaceholders());
+
+    QSqlQuery *query { nullptr };
+    if (!execBatch(sql, paths, &query))
+        return false;
+
+    while (query->next())
+        (*fileTags)[query->value(0).toString()].append(query->value(1).toString());
+    query->finish();
+
+    return true;
+}
+
+bool TagDbHandle::removeFiles(const QStringList &paths)
+{
+    static const QString sql = QString("DELETE FROM %1 WHERE filePath IN (%2);")
+                                       .arg(kTagTableFileTags)
+                                       .arg(batchPlaceholders());
+
+    QSqlQuery *query { nullptr };
+    if (!execBatch(sql, paths, &query))
+        return false;
+
+    query->finish();
+    return true;
+}
+
+/*!
+ * \brief TagDbHandle::execBatch Execute a statement with kBatchCount placeholders,
+ * the statement is prepared once for each thread and then reused.
+ * Fewer values are padded with the last one, so every batch has the same statement.
+ * \param result the executed query, valid until the next call in the same thread
+ */
+bool TagDbHandle::execBatch(const QString &sql, const QStringList &values, QSqlQuery **result)
+{
+    if (values.isEmpty() || values.count() > kBatchCount) {
+        lastErr = "invalid batch size!";
+        return false;
+    }
+
+    const auto &query = preparedQuery(sql);
+    if (!query)
+        return false;
+
+    for (int i = 0; i < kBatchCount; ++i)
+        query->bindValue(i, i < values.count() ? values.at(i) : values.last());
+
+    if (!query->exec()) {
+        lastErr = QString("Execute sql failed! sql: %1, error: %2").arg(sql).arg(query->lastError().text());
+        return false;
+    }
+
+    if (result)
+        *result = query.data();
+    return true;
+}
+
+/*!
+ * \brief TagDbHandle::preparedQuery The statement prepared on the connection of current thread,
+ * it is prepared at the first call and reused until the thread finished.
+ */
+QSharedPointer<QSqlQuery> TagDbHandle::preparedQuery(const QString &sql)
+{
+    QThread *thread = QThread::currentThread();
+    {
+        QMutexLocker lk(&preparedMutex);
+        auto it = preparedQueries.constFind(thread);
+        if (it != preparedQueries.constEnd()) {
+            const auto &query = it->queries.value(sql);
+            if (query)
+                return query;
+        }
+    }
+
+    QSharedPointer<QSqlQuery> query(new QSqlQuery(SqliteConnectionPool::instance().openConnection(dbFilePath)));
+    if (!query->prepare(sql)) {
+        lastErr = QString("Prepare sql failed! sql: %1, error: %2").arg(sql).arg(query->lastError().text());
+        return nullptr;
+    }
+
+    QMutexLocker lk(&preparedMutex);
+    auto it = preparedQueries.find(thread);
+    if (it == preparedQueries.end()) {
+        it = preparedQueries.insert(thread, {});
+        // direct, so the statements are dropped before the pool removes the connection of the thread,
+        // and a new thread at the same address never gets them
+        it->finishedConnection = connect(thread, &QThread::finished, this, [this, thread]() {
+            QMutexLocker locker(&preparedMutex);
+            auto iter = preparedQueries.find(thread);
+            if (iter == preparedQueries.end())
+                return;
+            disconnect(iter->finishedConnection);
+            preparedQueries.erase(iter);
+        }, Qt::DirectConnection);
+    }
+    it->queries.insert(sql, query);
+
+    return query;
+}
@@ -9,6 +9,11 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QSqlQuery>
+#include <QThread>
 
 DFMBASE_USE_NAMESPACE
 namespace dfmplugin_tag {
@@ -64,10 +69,16 @@ private:
     bool removeSpecifiedTagOfFile(const QString &url, const QVariant &val);
     bool changeTagColor(const QString &tagName, const QString &newTagColor);
     bool changeTagNameWithFile(const QString &tagName, const QString &newName);
-    bool changeFilePath(const QString &oldPath, const QString &newPath);
+    bool changeFilePath(const QString &oldPath, const QString &newPath, QVariantMap *oldFiles, QVariantMap *newFiles);
 
     bool checkTableExists(const QString &tableName);
     bool createTable(const QString &tableName);
+    bool createIndexes();
+
+    bool queryTagsOfFiles(const QStringList &paths, QHash<QString, QStringList> *fileTags);
+    bool removeFiles(const QStringList &paths);
+    bool execBatch(const QString &sql, const QStringList &values, QSqlQuery **result = nullptr);
+    QSharedPointer<QSqlQuery> preparedQuery(const QString &sql);
 
     explicit TagDbHandle(QObject *parent = nullptr);
     virtual ~TagDbHandle();
@@ -84,6 +95,17 @@ Q_SIGNALS:
 private:
     SqliteHandle *handle { nullptr };
     QString lastErr;
+    QString dbFilePath;
+
+    // prepared statements of each thread, sqlite connections are per thread
+    // and removed when the thread finished, so are the statements
+    struct ThreadQueries
+    {
+        QMetaObject::Connection finishedConnection;
+        QHash<QString, QSharedPointer<QSqlQuery>> queries;
+    };
+    QMutex preparedMutex;
+    QHash<QThread *, ThreadQueries> preparedQueries;
 };
 
 }
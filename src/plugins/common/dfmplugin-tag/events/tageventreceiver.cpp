@@ -35,16 +35,22 @@ void TagEventReceiver::handleFileCutResult(const QList<QUrl> &srcUrls, const QLi
     if (!ok)
         return;
 
-    for (const QUrl &url : srcUrls) {
-        const auto &tags = TagManager::instance()->getTagsByUrls({ url }, true).toStringList();
-        if (tags.isEmpty())
+    // the tags of the children are moved with the directory by one statement
+    QMap<QUrl, QUrl> movedUrls;
+    for (int i = 0; i < srcUrls.count() && i < destUrls.count(); ++i) {
+        const QUrl &url = srcUrls.at(i);
+        if (TagManager::instance()->canTagFile(destUrls.at(i))) {
+            movedUrls.insert(url, destUrls.at(i));
             continue;
+        }
 
-        TagManager::instance()->removeTagsOfFiles(tags, { url });
-        const QUrl &newUrl = destUrls.at(srcUrls.indexOf(url));
-        if (TagManager::instance()->canTagFile(newUrl))
-            TagManager::instance()->addTagsForFiles(tags, { newUrl });
+        const auto &tags = TagManager::instance()->getTagsByUrls({ url }, true).toStringList();
+        if (!tags.isEmpty())
+            TagManager::instance()->removeTagsOfFiles(tags, { url });
     }
+
+    if (!movedUrls.isEmpty())
+        TagManager::instance()->changeFilePaths(movedUrls);
 }
 
 void TagEventReceiver::handleFileRemoveResult(const QList<QUrl> &srcUrls, bool ok, const QString &errMsg)
@@ -71,15 +77,7 @@ void TagEventReceiver::handleFileRenameResult(quint64 winId, const QMap<QUrl, QU
     if (!ok || renamedUrls.isEmpty())
         return;
 
-    auto iter = renamedUrls.constBegin();
-    for (; iter != renamedUrls.constEnd(); ++iter) {
-        const auto &tags = TagManager::instance()->getTagsByUrls({ iter.key() }, true).toStringList();
-        if (tags.isEmpty())
-            continue;
-
-        TagManager::instance()->removeTagsOfFiles(tags, { iter.key() });
-        TagManager::instance()->addTagsForFiles(tags, { iter.value() });
-    }
+    TagManager::instance()->changeFilePaths(renamedUrls);
 }
 
 void TagEventReceiver::handleWindowUrlChanged(quint64 winId, const QUrl &url)
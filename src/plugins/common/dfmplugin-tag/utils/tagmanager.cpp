@@ -438,6 +438,26 @@ bool TagManager::changeTagName(const QString &tagName, const QString &newName)
     return TagProxyHandleIns->changeTagNamesWithFiles(oldAndNewName);
 }
 
+/*!
+ * \brief TagManager::changeFilePaths Move the tags of the files and all files below them to the new paths
+ */
+bool TagManager::changeFilePaths(const QMap<QUrl, QUrl> &oldAndNew)
+{
+    QVariantMap pathMap;
+    auto iter = oldAndNew.constBegin();
+    for (; iter != oldAndNew.constEnd(); ++iter) {
+        const QString &oldPath = UrlRoute::urlToLocalPath(iter.key());
+        const QString &newPath = UrlRoute::urlToLocalPath(iter.value());
+        if (!oldPath.isEmpty() && !newPath.isEmpty() && oldPath != newPath)
+            pathMap.insert(oldPath, QVariant { newPath });
+    }
+
+    if (pathMap.isEmpty())
+        return false;
+
+    return TagProxyHandleIns->changeFilePaths(pathMap);
+}
+
 QMap<QString, QString> TagManager::getTagsColorName(const QStringList &tags) const
 {
     if (tags.isEmpty())
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "anythingserver.h"
+#include "filenameindexdbus.h"
+
 #include <QProcess>
 
 DAEMONPANYTHING_USE_NAMESPACE
@@ -12,6 +14,35 @@ void AnythingPlugin::initialize()
 }
 
 bool AnythingPlugin::start()
+{
+    anythingStarted = startAnything();
+    if (anythingStarted)
+        return true;
+
+    // deepin-anything 不可用时, 使用内置的文件名索引, 它提供相同的搜索接口
+    qInfo() << "deepin-anything is not available, start the built-in file name index.";
+    fileNameIndex.reset(new FileNameIndexDBus(this));
+    return true;
+}
+
+void AnythingPlugin::stop()
+{
+    // save the file name index before the plugin is unloaded
+    fileNameIndex.reset();
+    if (!anythingStarted)
+        return;
+
+    // unload kernel module vfs_monitor
+    QProcess process;
+    process.start("rmmod", { "vfs_monitor" }, QIODevice::ReadOnly);
+    if (process.waitForFinished(1000)) {
+        qInfo() << "unload kernel module vfs_monitor" << (process.exitCode() == 0 ? " succeeded." : " failed.");
+    } else {
+        qInfo() << "unload kernel module vfs_monitor timed out.";
+    }
+}
+
+bool AnythingPlugin::startAnything()
 {
     // define the deepin anything backend share library.
     QLibrary backendLib("deepin-anything-server-lib");
@@ -54,15 +85,3 @@ bool AnythingPlugin::start()
     //backendLib.unload();
     return true;
 }
-
-void AnythingPlugin::stop()
-{
-    // unload kernel module vfs_monitor
-    QProcess process;
-    process.start("rmmod", { "vfs_monitor" }, QIODevice::ReadOnly);
-    if (process.waitForFinished(1000)) {
-        qInfo() << "unload kernel module vfs_monitor" << (process.exitCode() == 0 ? " succeeded." : " failed.");
-    } else {
-        qInfo() << "unload kernel module vfs_monitor timed out.";
-    }
-}
@@ -9,6 +9,7 @@
 
 #include <dfm-framework/dpf.h>
 
+class FileNameIndexDBus;
 DAEMONPANYTHING_BEGIN_NAMESPACE
 
 class AnythingPlugin : public DPF_NAMESPACE::Plugin
@@ -22,6 +23,11 @@ public:
     virtual void stop() override;
 
 private:
+    bool startAnything();
+
+private:
+    bool anythingStarted { false };
+    QScopedPointer<FileNameIndexDBus> fileNameIndex;
 };
 
 DAEMONPANYTHING_END_NAMESPACE
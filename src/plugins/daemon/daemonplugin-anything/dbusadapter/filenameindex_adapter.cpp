@@ -0,0 +1,52 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./filenameindexdbus.h -c FileNameIndexAdapter -l FileNameIndexDBus -a dbusadapter/filenameindex_adapter filenameindexdbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2017 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * Do not edit! All changes made to it will be lost.
+ */
+
+#include "dbusadapter/filenameindex_adapter.h"
+#include <QtCore/QMetaObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+/*
+ * Implementation of adaptor class FileNameIndexAdapter
+ */
+
+FileNameIndexAdapter::FileNameIndexAdapter(FileNameIndexDBus *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    // constructor
+    setAutoRelaySignals(true);
+}
+
+FileNameIndexAdapter::~FileNameIndexAdapter()
+{
+    // destructor
+}
+
+bool FileNameIndexAdapter::hasLFT(const QString &path)
+{
+    // handle method call com.deepin.anything.hasLFT
+    return parent()->hasLFT(path);
+}
+
+QStringList FileNameIndexAdapter::hasLFTSubdirectories(const QString &path)
+{
+    // handle method call com.deepin.anything.hasLFTSubdirectories
+    return parent()->hasLFTSubdirectories(path);
+}
+
+QStringList FileNameIndexAdapter::search(int maxCount, qlonglong maxTime, uint startOffset, uint endOffset, const QString &path, const QString &keyword, bool useRegExp, uint &startOffset_, uint &endOffset_)
+{
+    // handle method call com.deepin.anything.search
+    return parent()->search(maxCount, maxTime, startOffset, endOffset, path, keyword, useRegExp, startOffset_, endOffset_);
+}
@@ -0,0 +1,77 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./filenameindexdbus.h -c FileNameIndexAdapter -l FileNameIndexDBus -a dbusadapter/filenameindex_adapter filenameindexdbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2017 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * This file may have been hand-edited. Look for HAND-EDIT comments
+ * before re-generating it.
+ */
+
+#ifndef FILENAMEINDEX_ADAPTER_H
+#define FILENAMEINDEX_ADAPTER_H
+
+#include <QtCore/QObject>
+#include <QtDBus/QtDBus>
+#include "../filenameindexdbus.h"
+QT_BEGIN_NAMESPACE
+class QByteArray;
+template<class T>
+class QList;
+template<class Key, class Value>
+class QMap;
+class QString;
+class QStringList;
+class QVariant;
+QT_END_NAMESPACE
+
+/*
+ * Adaptor class for interface com.deepin.anything
+ */
+class FileNameIndexAdapter : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.anything")
+    Q_CLASSINFO("D-Bus Introspection", ""
+                                       "  <interface name=\"com.deepin.anything\">\n"
+                                       "    <method name=\"hasLFT\">\n"
+                                       "      <arg direction=\"out\" type=\"b\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"path\"/>\n"
+                                       "    </method>\n"
+                                       "    <method name=\"hasLFTSubdirectories\">\n"
+                                       "      <arg direction=\"out\" type=\"as\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"path\"/>\n"
+                                       "    </method>\n"
+                                       "    <method name=\"search\">\n"
+                                       "      <arg direction=\"out\" type=\"as\"/>\n"
+                                       "      <arg direction=\"in\" type=\"i\" name=\"maxCount\"/>\n"
+                                       "      <arg direction=\"in\" type=\"x\" name=\"maxTime\"/>\n"
+                                       "      <arg direction=\"in\" type=\"u\" name=\"startOffset\"/>\n"
+                                       "      <arg direction=\"in\" type=\"u\" name=\"endOffset\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"path\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"keyword\"/>\n"
+                                       "      <arg direction=\"in\" type=\"b\" name=\"useRegExp\"/>\n"
+                                       "      <arg direction=\"out\" type=\"u\" name=\"startOffset\"/>\n"
+                                       "      <arg direction=\"out\" type=\"u\" name=\"endOffset\"/>\n"
+                                       "    </method>\n"
+                                       "  </interface>\n"
+                                       "")
+public:
+    FileNameIndexAdapter(FileNameIndexDBus *parent);
+    virtual ~FileNameIndexAdapter();
+
+    inline FileNameIndexDBus *parent() const
+    {
+        return static_cast<FileNameIndexDBus *>(QObject::parent());
+    }
+
+public:   // PROPERTIES
+public Q_SLOTS:   // METHODS
+    bool hasLFT(const QString &path);
+    QStringList hasLFTSubdirectories(const QString &path);
+    QStringList search(int maxCount, qlonglong maxTime, uint startOffset, uint endOffset, const QString &path, const QString &keyword, bool useRegExp, uint &startOffset_, uint &endOffset_);
+Q_SIGNALS:   // SIGNALS
+};
+
+#endif
@@ -0,0 +1,520 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filenameindex.h"
+
+#include <QSocketNotifier>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QFile>
+#include <QTimer>
+#include <QDir>
+#include <QDebug>
+
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+
+#include <algorithm>
+
+static constexpr char kIndexDir[] { "/var/cache/deepin/dde-file-manager-daemon" };
+static constexpr char kIndexFileName[] { "filename.index" };
+static constexpr int kSaveInterval { 10 * 60 * 1000 };   // 保存索引的间隔(ms)
+static constexpr int kRescanInterval { 60 * 60 * 1000 };   // 没有 fanotify 时重新扫描的间隔(ms)
+static constexpr int kOverflowRescanDelay { 60 * 1000 };   // 事件队列溢出后重新扫描的延时(ms)
+static constexpr int kTimeCheckRows { 1024 };   // 搜索时每比较这么多行检查一次超时
+// the offsets handed to the clients carry the generation of the table in the high bits,
+// since a compaction or a rescan renumbers the rows
+static constexpr int kGenerationShift { 28 };
+static constexpr uint kRowMask { (1u << kGenerationShift) - 1 };
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+namespace {
+// the mount points in mountinfo are escaped as octal, like "\040" for space
+QByteArray unescapeMountPoint(const QByteArray &path)
+{
+    QByteArray result;
+    result.reserve(path.size());
+    for (int i = 0; i < path.size(); ++i) {
+        if (path.at(i) == '\\' && i + 3 < path.size()) {
+            result.append(static_cast<char>(path.mid(i + 1, 3).toInt(nullptr, 8)));
+            i += 3;
+        } else {
+            result.append(path.at(i));
+        }
+    }
+
+    return result;
+}
+
+QByteArray joinPath(const QByteArray &dir, const QByteArray &name)
+{
+    return dir.endsWith('/') ? dir + name : dir + '/' + name;
+}
+
+quint64 fsidKey(const int val[2])
+{
+    return (static_cast<quint64>(static_cast<quint32>(val[0])) << 32) | static_cast<quint32>(val[1]);
+}
+}   // namespace
+
+FileNameIndex::FileNameIndex()
+    : QObject(nullptr)
+{
+    indexFile = QString("%1/%2").arg(kIndexDir, kIndexFileName);
+    moveToThread(&workerThread);
+}
+
+FileNameIndex::~FileNameIndex()
+{
+    stopped = true;
+    if (workerThread.isRunning()) {
+        QMetaObject::invokeMethod(this, "release", Qt::BlockingQueuedConnection);
+        workerThread.quit();
+        workerThread.wait();
+    }
+}
+
+void FileNameIndex::start()
+{
+    workerThread.start();
+    QMetaObject::invokeMethod(this, "initIndex", Qt::QueuedConnection);
+}
+
+bool FileNameIndex::isReady() const
+{
+    return ready;
+}
+
+bool FileNameIndex::contains(const QString &path) const
+{
+    if (!ready)
+        return false;
+
+    QReadLocker lk(&lock);
+    return table.find(QFile::encodeName(path)) != FileNameTable::kInvalidRow;
+}
+
+/*!
+ * \brief FileNameIndex::search Search the names below the path, the rows in [startOffset, endOffset) are
+ * compared until maxCount files are found or maxTime is used up, like the search of deepin-anything.
+ * The offsets are only valid for the generation of the table that they are given by.
+ * \param startOffset the row to start, it is set to the next row to search
+ * \param endOffset the row to stop, 0 means all rows, it is set to the row count at the first call
+ * \param filter return false to drop a matched file
+ * \param isStale set to true if the offsets are given by an older generation, the search has to start again
+ * \return the matched files, the search is finished if startOffset >= endOffset
+ */
+QStringList FileNameIndex::search(const QString &path, const QString &keyword, bool useRegExp,
+                                  int maxCount, qint64 maxTime, uint *startOffset, uint *endOffset,
+                                  const Filter &filter, bool *isStale) const
+{
+    QStringList results;
+    *isStale = false;
+    const QRegularExpression regExp(useRegExp ? keyword : QRegularExpression::escape(keyword),
+                                    QRegularExpression::CaseInsensitiveOption);
+    if (!ready || keyword.isEmpty() || !regExp.isValid()) {
+        *startOffset = *endOffset = 0;
+        return results;
+    }
+
+    QReadLocker lk(&lock);
+    const uint tag = (generation << kGenerationShift) & ~kRowMask;
+    if (*endOffset != 0 && ((*endOffset & ~kRowMask) != tag || (*startOffset & ~kRowMask) != tag)) {
+        *isStale = true;
+        *startOffset = *endOffset = 0;
+        return results;
+    }
+
+    const quint32 root = table.find(QFile::encodeName(path));
+    if (root == FileNameTable::kInvalidRow) {
+        *startOffset = *endOffset = 0;
+        return results;
+    }
+
+    // the rows are only appended in a generation
+    const uint rowCount = qMin(static_cast<uint>(table.rowCount()), kRowMask);
+    uint endRow = *endOffset & kRowMask;
+    if (endRow == 0 || endRow > rowCount)
+        endRow = rowCount;
+
+    QElapsedTimer timer;
+    timer.start();
+    uint row = *startOffset & kRowMask;
+    for (; row < endRow; ++row) {
+        if (results.count() >= maxCount)
+            break;
+        if (row % kTimeCheckRows == 0 && maxTime > 0 && timer.elapsed() > maxTime)
+            break;
+
+        if (!regExp.match(QString::fromUtf8(table.nameAt(row))).hasMatch())
+            continue;
+        if (row == root || !table.isAncestor(root, row) || !table.isAlive(row))
+            continue;
+
+        const QByteArray &file = table.pathAt(row);
+        if (!filter || filter(file))
+            results.append(QFile::decodeName(file));
+    }
+
+    *startOffset = row | tag;
+    *endOffset = endRow | tag;
+    return results;
+}
+
+void FileNameIndex::initIndex()
+{
+    if (stopped)
+        return;
+
+    if (!saveTimer) {
+        saveTimer = new QTimer(this);
+        saveTimer->setInterval(kSaveInterval);
+        connect(saveTimer, &QTimer::timeout, this, &FileNameIndex::save);
+        saveTimer->start();
+
+        // the index has the names of all users, only root can read it
+        QDir().mkpath(kIndexDir);
+        QFile::setPermissions(kIndexDir, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+        if (QFile::exists(indexFile))
+            QFile::setPermissions(indexFile, QFile::ReadOwner | QFile::WriteOwner);
+
+        // serve the last index until the scan finished
+        QWriteLocker lk(&lock);
+        if (table.load(indexFile)) {
+            ++generation;
+            ready = true;
+            qInfo() << "load the file name index:" << table.count() << "files";
+        }
+    }
+
+    // the events during the scan are queued by the kernel and applied after the scan
+    if (fanotifyFd < 0 && !initFanotify()) {
+        qWarning() << "fanotify is not available, the file name index is rescanned every" << kRescanInterval / 1000 << "seconds";
+        QTimer::singleShot(kRescanInterval, this, &FileNameIndex::initIndex);
+    }
+
+    // the filesystems mounted since the last scan are watched here
+    loadMounts();
+
+    QElapsedTimer timer;
+    timer.start();
+    FileNameTable newTable;
+    scanTree("/", &newTable);
+    if (stopped)
+        return;
+
+    {
+        QWriteLocker lk(&lock);
+        table = std::move(newTable);
+        ++generation;
+        ready = true;
+    }
+
+    qInfo() << "the file name index is created," << table.count() << "files, cost" << timer.elapsed() << "ms";
+    dirty = true;
+    save();
+}
+
+void FileNameIndex::onFanotifyEvent()
+{
+    if (fanotifyFd < 0)
+        return;
+
+    alignas(fanotify_event_metadata) char buffer[8192];
+    QSet<QByteArray> changedPaths;
+    bool overflow = false;
+    ssize_t len = 0;
+    while ((len = read(fanotifyFd, buffer, sizeof(buffer))) > 0) {
+        auto metadata = reinterpret_cast<const fanotify_event_metadata *>(buffer);
+        for (; FAN_EVENT_OK(metadata, len); metadata = FAN_EVENT_NEXT(metadata, len)) {
+            if (metadata->vers != FANOTIFY_METADATA_VERSION)
+                continue;
+            if (metadata->mask & FAN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+
+            // with FAN_REPORT_DFID_NAME the event has the handle of the parent directory and the name
+            auto fid = reinterpret_cast<const fanotify_event_info_fid *>(metadata + 1);
+            if (fid->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                continue;
+
+            const int mountFd = mountFds.value(fsidKey(fid->fsid.val), -1);
+            if (mountFd < 0)
+                continue;
+
+            auto handle = reinterpret_cast<file_handle *>(const_cast<unsigned char *>(fid->handle));
+            const char *name = reinterpret_cast<const char *>(handle->f_handle + handle->handle_bytes);
+            const int dirFd = open_by_handle_at(mountFd, handle, O_PATH | O_CLOEXEC);
+            // the directory is removed
+            if (dirFd < 0)
+                continue;
+
+            char dirPath[PATH_MAX];
+            const ssize_t size = readlink(QByteArray("/proc/self/fd/").append(QByteArray::number(dirFd)).constData(),
+                                          dirPath, sizeof(dirPath));
+            close(dirFd);
+            if (size > 0 && size < static_cast<ssize_t>(sizeof(dirPath)))
+                changedPaths.insert(aliasedPath(joinPath(QByteArray(dirPath, static_cast<int>(size)), name)));
+        }
+    }
+
+    if (!changedPaths.isEmpty())
+        applyChanges(changedPaths);
+
+    if (overflow) {
+        qWarning() << "the fanotify events overflowed, rescan the file name index later";
+        QTimer::singleShot(kOverflowRescanDelay, this, &FileNameIndex::initIndex);
+    }
+}
+
+void FileNameIndex::save()
+{
+    if (!dirty || stopped)
+        return;
+
+    {
+        QWriteLocker lk(&lock);
+        if (table.needCompact()) {
+            table.compact();
+            ++generation;
+        }
+    }
+
+    QReadLocker lk(&lock);
+    if (table.save(indexFile))
+        dirty = false;
+}
+
+void FileNameIndex::release()
+{
+    delete saveTimer;
+    saveTimer = nullptr;
+    delete notifier;
+    notifier = nullptr;
+    if (fanotifyFd >= 0)
+        close(fanotifyFd);
+    fanotifyFd = -1;
+    for (int fd : mountFds)
+        close(fd);
+    mountFds.clear();
+
+    // keep the changes of the last minutes
+    if (dirty) {
+        QReadLocker lk(&lock);
+        table.save(indexFile);
+    }
+}
+
+/*!
+ * \brief FileNameIndex::loadMounts Only the filesystems on block devices are indexed,
+ * the pseudo filesystems like proc, sysfs, tmpfs and the loop devices of the snaps are skipped.
+ */
+void FileNameIndex::loadMounts()
+{
+    devices.clear();
+    mountRoots.clear();
+
+    QFile mountInfo("/proc/self/mountinfo");
+    if (!mountInfo.open(QIODevice::ReadOnly)) {
+        qWarning() << "can not read the mounts:" << mountInfo.errorString();
+        return;
+    }
+
+    // id parent major:minor root mount-point options [optional fields] - type source super-options
+    for (const QByteArray &line : mountInfo.readAll().split('\n')) {
+        const QList<QByteArray> &fields = line.split(' ');
+        const int separator = fields.indexOf("-");
+        if (separator < 5 || separator + 2 >= fields.count())
+            continue;
+
+        const QByteArray &source = fields.at(separator + 2);
+        if (!source.startsWith("/dev/") || source.startsWith("/dev/loop"))
+            continue;
+
+        const QByteArray &mountPoint = unescapeMountPoint(fields.at(4));
+        struct stat st;
+        if (stat(mountPoint.constData(), &st) != 0)
+            continue;
+
+        devices.insert(st.st_dev);
+        const auto &key = qMakePair(st.st_dev, st.st_ino);
+        if (!mountRoots.contains(key))
+            mountRoots.insert(key, mountPoint);
+
+        // the events are reported once per filesystem, resolve them by the mount of the filesystem root
+        struct statfs fs;
+        if (fields.at(3) != "/" || statfs(mountPoint.constData(), &fs) != 0)
+            continue;
+
+        const quint64 fsid = fsidKey(fs.f_fsid.__val);
+        if (fanotifyFd >= 0 && !mountFds.contains(fsid)) {
+            const int fd = open(mountPoint.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0)
+                continue;
+
+            const uint64_t mask = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_ONDIR;
+            if (fanotify_mark(fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, mountPoint.constData()) != 0) {
+                qWarning() << "can not watch the filesystem of" << mountPoint << "errno:" << errno;
+                close(fd);
+                continue;
+            }
+            mountFds.insert(fsid, fd);
+        }
+    }
+}
+
+bool FileNameIndex::initFanotify()
+{
+#ifdef FAN_REPORT_DFID_NAME
+    fanotifyFd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_NONBLOCK | FAN_CLOEXEC, O_RDONLY | O_LARGEFILE);
+    if (fanotifyFd < 0) {
+        qWarning() << "fanotify_init failed, errno:" << errno;
+        return false;
+    }
+
+    notifier = new QSocketNotifier(fanotifyFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &FileNameIndex::onFanotifyEvent);
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief FileNameIndex::scanTree Scan the tree of the path into the table, the directories of
+ * one level are read in parallel and inserted in order, so a parent is always before its children.
+ */
+void FileNameIndex::scanTree(const QByteArray &path, FileNameTable *table)
+{
+    QVector<ScanTask> level { { FileNameTable::kRootRow, path, {} } };
+    while (!level.isEmpty() && !stopped) {
+        QtConcurrent::blockingMap(level, [this](ScanTask &task) { readDirectory(&task); });
+
+        QVector<ScanTask> nextLevel;
+        for (const ScanTask &task : level) {
+            for (const DirEntry &entry : task.children) {
+                const quint32 row = table->insert(task.row, entry.name, entry.isDir);
+                if (entry.isWalkable)
+                    nextLevel.append({ row, joinPath(task.path, entry.name), {} });
+            }
+        }
+        level.swap(nextLevel);
+    }
+}
+
+void FileNameIndex::readDirectory(ScanTask *task)
+{
+    if (stopped)
+        return;
+
+    DIR *dir = opendir(task->path.constData());
+    if (!dir)
+        return;
+
+    const int dirFd = dirfd(dir);
+    while (struct dirent *ent = readdir(dir)) {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))
+            continue;
+
+        DirEntry entry { QByteArray(ent->d_name), ent->d_type == DT_DIR, false };
+        if (ent->d_type == DT_DIR || ent->d_type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirFd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                entry.isDir = S_ISDIR(st.st_mode);
+                entry.isWalkable = entry.isDir && devices.contains(st.st_dev);
+                // a bind mounted directory is only walked at its mount point
+                const QByteArray &mountPoint = mountRoots.value(qMakePair(st.st_dev, st.st_ino));
+                const QByteArray &childPath = joinPath(task->path, entry.name);
+                if (entry.isWalkable && !mountPoint.isEmpty() && mountPoint != childPath) {
+                    entry.isWalkable = false;
+                    QMutexLocker lk(&aliasMutex);
+                    aliases.insert(childPath, mountPoint);
+                }
+            }
+        }
+        task->children.append(entry);
+    }
+
+    closedir(dir);
+}
+
+/*!
+ * \brief FileNameIndex::applyChanges Check the changed files again, a file that exists is inserted and a
+ * directory is rescanned, so the moves are handled as a remove and an insert.
+ */
+void FileNameIndex::applyChanges(const QSet<QByteArray> &paths)
+{
+    struct Change
+    {
+        QByteArray path;
+        bool exists;
+        bool isDir;
+        FileNameTable tree;
+    };
+
+    // the directories are scanned without the lock
+    QList<Change> changes;
+    for (const QByteArray &path : paths) {
+        struct stat st;
+        Change change { path, lstat(path.constData(), &st) == 0, false, {} };
+        change.isDir = change.exists && S_ISDIR(st.st_mode);
+        if (change.isDir && devices.contains(st.st_dev))
+            scanTree(path, &change.tree);
+        changes.append(std::move(change));
+    }
+
+    // apply the parents first
+    std::sort(changes.begin(), changes.end(), [](const Change &c1, const Change &c2) {
+        return c1.path.count('/') < c2.path.count('/');
+    });
+
+    QWriteLocker lk(&lock);
+    for (const Change &change : changes) {
+        const int pos = change.path.lastIndexOf('/');
+        const quint32 parent = table.find(pos > 0 ? change.path.left(pos) : QByteArray("/"));
+        if (parent == FileNameTable::kInvalidRow)
+            continue;
+
+        const QByteArray &name = change.path.mid(pos + 1);
+        const quint32 old = table.child(parent, name);
+        if (old != FileNameTable::kInvalidRow) {
+            // the file is modified in place, like the temporary file of an editor is moved to it
+            if (change.exists && !change.isDir && !table.isDir(old))
+                continue;
+            table.remove(old);
+        }
+
+        if (change.exists) {
+            const quint32 row = table.insert(parent, name, change.isDir);
+            table.merge(row, change.tree);
+        }
+    }
+
+    if (table.needCompact()) {
+        table.compact();
+        ++generation;
+    }
+    dirty = true;
+}
+
+QByteArray FileNameIndex::aliasedPath(const QByteArray &path) const
+{
+    QMutexLocker lk(&aliasMutex);
+    for (auto it = aliases.cbegin(); it != aliases.cend(); ++it) {
+        if (path == it.key() || path.startsWith(it.key() + '/'))
+            return it.value() + path.mid(it.key().size());
+    }
+
+    return path;
+}
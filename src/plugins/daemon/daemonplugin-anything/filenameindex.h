@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILENAMEINDEX_H
+#define FILENAMEINDEX_H
+
+#include "daemonplugin_anything_global.h"
+#include "filenametable.h"
+
+#include <QObject>
+#include <QThread>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+
+#include <functional>
+#include <atomic>
+
+#include <sys/types.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+class QTimer;
+QT_END_NAMESPACE
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+
+/*!
+ * \class FileNameIndex
+ * \brief The built-in file name index, it is used when deepin-anything is not available.
+ * The names of the local disks are scanned level by level with several threads into a FileNameTable,
+ * which is saved to the disk so that the next start can serve the searches before the scan finished.
+ * The index lives in its own thread and is updated by the fanotify events of the whole filesystems.
+ * search() can be called from any thread.
+ */
+class FileNameIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Filter = std::function<bool(const QByteArray &path)>;
+
+    FileNameIndex();
+    ~FileNameIndex();
+
+    void start();
+    bool isReady() const;
+    bool contains(const QString &path) const;
+    QStringList search(const QString &path, const QString &keyword, bool useRegExp,
+                       int maxCount, qint64 maxTime, uint *startOffset, uint *endOffset,
+                       const Filter &filter, bool *isStale) const;
+
+private slots:
+    void initIndex();
+    void onFanotifyEvent();
+    void save();
+    void release();
+
+private:
+    struct DirEntry
+    {
+        QByteArray name;
+        bool isDir;
+        bool isWalkable;   // a directory on the indexed disks
+    };
+
+    struct ScanTask
+    {
+        quint32 row;
+        QByteArray path;
+        QVector<DirEntry> children;
+    };
+
+    void loadMounts();
+    bool initFanotify();
+    void scanTree(const QByteArray &path, FileNameTable *table);
+    void readDirectory(ScanTask *task);
+    void applyChanges(const QSet<QByteArray> &paths);
+    QByteArray aliasedPath(const QByteArray &path) const;
+
+private:
+    QThread workerThread;
+    std::atomic_bool stopped { false };
+    std::atomic_bool ready { false };
+
+    mutable QReadWriteLock lock;
+    FileNameTable table;
+    quint32 generation { 0 };   // increased when the rows are renumbered
+
+    // only touched in the worker thread
+    QString indexFile;
+    bool dirty { false };
+    QSet<dev_t> devices;
+    QHash<QPair<dev_t, ino_t>, QByteArray> mountRoots;   // the root of a mount -> mount point
+    QHash<quint64, int> mountFds;   // fsid -> fd of the mount point for open_by_handle_at
+    int fanotifyFd { -1 };
+    QSocketNotifier *notifier { nullptr };
+    QTimer *saveTimer { nullptr };
+
+    // written by the scanning threads
+    mutable QMutex aliasMutex;
+    QHash<QByteArray, QByteArray> aliases;   // a bind mounted directory -> the mount point
+};
+
+DAEMONPANYTHING_END_NAMESPACE
+
+#endif   // FILENAMEINDEX_H
@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filenameindexdbus.h"
+#include "filenameindex.h"
+#include "dbusadapter/filenameindex_adapter.h"
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QtConcurrent>
+#include <QVector>
+#include <QHash>
+#include <QDebug>
+
+#include <sys/fsuid.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <grp.h>
+#include <pwd.h>
+
+static constexpr char kFileNameIndexObjPath[] { "/com/deepin/filemanager/daemon/FileNameIndex" };
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+namespace {
+/*!
+ * \brief Check the files as the caller in the current thread, a file is visible if the caller can list
+ * its directory. fsuid, fsgid and the groups set by the raw syscall only belong to the thread.
+ */
+class CallerAccess
+{
+public:
+    explicit CallerAccess(uint uid)
+        : uid(uid)
+    {
+        if (uid == 0)
+            return;
+
+        struct passwd *pw = getpwuid(uid);
+        if (!pw)
+            return;
+
+        int count = getgroups(0, nullptr);
+        savedGroups.resize(qMax(count, 0));
+        getgroups(savedGroups.size(), savedGroups.data());
+
+        count = 64;
+        QVector<gid_t> groups(count);
+        if (getgrouplist(pw->pw_name, pw->pw_gid, groups.data(), &count) == -1) {
+            groups.resize(count);
+            getgrouplist(pw->pw_name, pw->pw_gid, groups.data(), &count);
+        }
+        groups.resize(count);
+
+        if (syscall(SYS_setgroups, static_cast<size_t>(groups.size()), groups.constData()) != 0)
+            return;
+        setfsgid(pw->pw_gid);
+        setfsuid(uid);
+        switched = static_cast<uint>(setfsuid(static_cast<uid_t>(-1))) == uid;
+    }
+
+    ~CallerAccess()
+    {
+        if (uid == 0)
+            return;
+
+        // the thread belongs to the pool, give the root back
+        setfsuid(0);
+        setfsgid(0);
+        syscall(SYS_setgroups, static_cast<size_t>(savedGroups.size()), savedGroups.constData());
+    }
+
+    bool isVisible(const QByteArray &file)
+    {
+        if (uid == 0)
+            return true;
+        if (!switched)
+            return false;
+
+        const int pos = file.lastIndexOf('/');
+        const QByteArray &dir = pos > 0 ? file.left(pos) : QByteArray("/");
+        auto it = visibleDirs.constFind(dir);
+        if (it != visibleDirs.constEnd())
+            return it.value();
+
+        const int fd = open(dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0)
+            close(fd);
+        visibleDirs.insert(dir, fd >= 0);
+        return fd >= 0;
+    }
+
+private:
+    const uint uid;
+    bool switched { false };
+    QVector<gid_t> savedGroups;
+    QHash<QByteArray, bool> visibleDirs;
+};
+}   // namespace
+
+FileNameIndexDBus::FileNameIndexDBus(QObject *parent)
+    : QObject(parent), QDBusContext()
+{
+    index.reset(new FileNameIndex);
+    index->start();
+
+    QDBusConnection::systemBus().registerObject(kFileNameIndexObjPath, this);
+    adapter = new FileNameIndexAdapter(this);
+}
+
+FileNameIndexDBus::~FileNameIndexDBus()
+{
+    index.reset();
+    if (adapter)
+        delete adapter;
+    adapter = nullptr;
+}
+
+bool FileNameIndexDBus::hasLFT(const QString &path)
+{
+    return index->contains(path);
+}
+
+/*!
+ * \brief FileNameIndexDBus::hasLFTSubdirectories The mounts below the path are in the same index,
+ * so there is no other directory to search.
+ */
+QStringList FileNameIndexDBus::hasLFTSubdirectories(const QString &path)
+{
+    Q_UNUSED(path)
+    return {};
+}
+
+/*!
+ * \brief FileNameIndexDBus::search Search like deepin-anything, the reply is sent when the search finished
+ * so that the daemon keeps serving other calls. The files that the caller can not list are dropped.
+ */
+QStringList FileNameIndexDBus::search(int maxCount, qlonglong maxTime, uint startOffset, uint endOffset,
+                                      const QString &path, const QString &keyword, bool useRegExp,
+                                      uint &startOffsetOut, uint &endOffsetOut)
+{
+    startOffsetOut = endOffsetOut = 0;
+    if (!index->isReady())
+        return {};
+
+    setDelayedReply(true);
+    const QDBusMessage msg = message();
+    const uint uid = callerUid();
+    auto fileIndex = index;
+    QtConcurrent::run([=]() {
+        uint start = startOffset;
+        uint end = endOffset;
+        bool isStale = false;
+        QStringList results;
+        {
+            CallerAccess access(uid);
+            results = fileIndex->search(path, keyword, useRegExp, maxCount, maxTime, &start, &end,
+                                        [&access](const QByteArray &file) { return access.isVisible(file); }, &isStale);
+        }
+
+        // the rows are renumbered since the last page, the results would be skipped or repeated
+        if (isStale)
+            QDBusConnection::systemBus().send(msg.createErrorReply(QDBusError::InvalidArgs, "the offsets are out of date, search again"));
+        else
+            QDBusConnection::systemBus().send(msg.createReply({ results, start, end }));
+    });
+
+    return {};
+}
+
+uint FileNameIndexDBus::callerUid()
+{
+    return connection().interface()->serviceUid(message().service()).value();
+}
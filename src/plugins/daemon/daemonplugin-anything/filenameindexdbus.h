@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILENAMEINDEXDBUS_H
+#define FILENAMEINDEXDBUS_H
+
+#include "daemonplugin_anything_global.h"
+
+#include <QObject>
+#include <QDBusContext>
+#include <QSharedPointer>
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+class FileNameIndex;
+DAEMONPANYTHING_END_NAMESPACE
+
+class FileNameIndexAdapter;
+/*!
+ * \brief The same interface as deepin-anything, so the searcher can use the built-in index
+ * by only changing the service and the path.
+ */
+class FileNameIndexDBus : public QObject, public QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.anything")
+
+public:
+    explicit FileNameIndexDBus(QObject *parent = nullptr);
+    ~FileNameIndexDBus();
+
+public slots:
+    bool hasLFT(const QString &path);
+    QStringList hasLFTSubdirectories(const QString &path);
+    QStringList search(int maxCount, qlonglong maxTime, uint startOffset, uint endOffset,
+                       const QString &path, const QString &keyword, bool useRegExp,
+                       uint &startOffsetOut, uint &endOffsetOut);
+
+private:
+    uint callerUid();
+
+private:
+    FileNameIndexAdapter *adapter = nullptr;
+    QSharedPointer<DAEMONPANYTHING_NAMESPACE::FileNameIndex> index;
+};
+
+#endif   // FILENAMEINDEXDBUS_H
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filenametable.h"
+
+#include <QSaveFile>
+#include <QFile>
+#include <QDebug>
+
+#include <cstring>
+
+DAEMONPANYTHING_USE_NAMESPACE
+
+static constexpr char kFileMagic[8] { 'D', 'F', 'M', 'N', 'A', 'M', 'E', 'S' };
+static constexpr quint32 kFileVersion { 1 };
+static constexpr int kMinCompactCount { 4096 };
+
+namespace {
+struct FileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 entryCount;
+    quint32 arenaSize;
+    quint32 reserved;
+};
+}   // namespace
+
+FileNameTable::FileNameTable()
+{
+    clear();
+}
+
+int FileNameTable::count() const
+{
+    return entries.count() - removedCount;
+}
+
+// the removed rows are counted, the rows are searched in [0, rowCount)
+int FileNameTable::rowCount() const
+{
+    return entries.count();
+}
+
+bool FileNameTable::isDir(quint32 row) const
+{
+    return entries.at(static_cast<int>(row)).flags & kIsDir;
+}
+
+/*!
+ * \brief FileNameTable::isAlive The row is alive if none of itself and its parents is removed
+ */
+bool FileNameTable::isAlive(quint32 row) const
+{
+    for (quint32 r = row; r != kInvalidRow; r = entries.at(static_cast<int>(r)).parent) {
+        if (entries.at(static_cast<int>(r)).flags & kIsRemoved)
+            return false;
+    }
+
+    return true;
+}
+
+QByteArray FileNameTable::nameAt(quint32 row) const
+{
+    const Entry &entry = entries.at(static_cast<int>(row));
+    return QByteArray::fromRawData(arena.constData() + entry.nameOffset, entry.nameSize);
+}
+
+QByteArray FileNameTable::pathAt(quint32 row) const
+{
+    if (row == kRootRow)
+        return QByteArrayLiteral("/");
+
+    QVector<quint32> chain;
+    for (quint32 r = row; r != kRootRow && r != kInvalidRow; r = entries.at(static_cast<int>(r)).parent)
+        chain.append(r);
+
+    QByteArray path;
+    for (auto it = chain.crbegin(); it != chain.crend(); ++it) {
+        path.append('/');
+        path.append(nameAt(*it));
+    }
+
+    return path;
+}
+
+bool FileNameTable::isAncestor(quint32 ancestor, quint32 row) const
+{
+    for (quint32 r = row; r != kInvalidRow; r = entries.at(static_cast<int>(r)).parent) {
+        if (r == ancestor)
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+ * \brief FileNameTable::find Find the row of an absolute path
+ * \return kInvalidRow if the path is not in the table
+ */
+quint32 FileNameTable::find(const QByteArray &path) const
+{
+    if (!path.startsWith('/'))
+        return kInvalidRow;
+
+    quint32 row = kRootRow;
+    for (const QByteArray &name : path.split('/')) {
+        if (name.isEmpty())
+            continue;
+
+        row = child(row, name);
+        if (row == kInvalidRow)
+            break;
+    }
+
+    return row;
+}
+
+quint32 FileNameTable::child(quint32 parent, const QByteArray &name) const
+{
+    const quint64 key = childKey(parent, name);
+    for (auto it = children.constFind(key); it != children.constEnd() && it.key() == key; ++it) {
+        const quint32 row = it.value();
+        if (nameAt(row) == name && entries.at(static_cast<int>(row)).parent == parent)
+            return row;
+    }
+
+    return kInvalidRow;
+}
+
+/*!
+ * \brief FileNameTable::insert Append a child, or update the type if the child is in the table
+ * \return the row of the child
+ */
+quint32 FileNameTable::insert(quint32 parent, const QByteArray &name, bool isDir)
+{
+    quint32 row = child(parent, name);
+    if (row != kInvalidRow) {
+        Entry &entry = entries[static_cast<int>(row)];
+        entry.flags = isDir ? (entry.flags | kIsDir) : (entry.flags & ~kIsDir);
+        return row;
+    }
+
+    row = static_cast<quint32>(entries.count());
+    Entry entry;
+    entry.parent = parent;
+    entry.nameOffset = static_cast<quint32>(arena.size());
+    entry.nameSize = static_cast<quint16>(name.size());
+    entry.flags = isDir ? kIsDir : 0;
+    entries.append(entry);
+    arena.append(name);
+    children.insert(childKey(parent, name), row);
+    return row;
+}
+
+void FileNameTable::remove(quint32 row)
+{
+    if (row == kRootRow || row >= static_cast<quint32>(entries.count()))
+        return;
+
+    Entry &entry = entries[static_cast<int>(row)];
+    if (entry.flags & kIsRemoved)
+        return;
+
+    children.remove(childKey(entry.parent, nameAt(row)), row);
+    entry.flags |= kIsRemoved;
+    ++removedCount;
+}
+
+/*!
+ * \brief FileNameTable::merge Insert the rows of another table as the children of the row,
+ * the root of the other table is the row itself
+ */
+void FileNameTable::merge(quint32 row, const FileNameTable &other)
+{
+    QVector<quint32> rows(other.entries.count(), kInvalidRow);
+    rows[kRootRow] = row;
+    for (int i = 1; i < other.entries.count(); ++i) {
+        const Entry &entry = other.entries.at(i);
+        const quint32 parent = rows.at(static_cast<int>(entry.parent));
+        if (parent != kInvalidRow && !(entry.flags & kIsRemoved))
+            rows[i] = insert(parent, other.nameAt(static_cast<quint32>(i)), entry.flags & kIsDir);
+    }
+}
+
+void FileNameTable::clear()
+{
+    entries.clear();
+    arena.clear();
+    children.clear();
+    removedCount = 0;
+
+    // the root directory has no name
+    entries.append({ kInvalidRow, 0, 0, kIsDir });
+}
+
+bool FileNameTable::needCompact() const
+{
+    return removedCount >= kMinCompactCount && removedCount * 8 > entries.count();
+}
+
+/*!
+ * \brief FileNameTable::compact Drop the removed rows and their children, the rows are renumbered
+ */
+void FileNameTable::compact()
+{
+    // a parent is always inserted before its children, so the state of the parent is known
+    QVector<bool> alive(entries.count(), false);
+    alive[kRootRow] = true;
+    for (int i = 1; i < entries.count(); ++i) {
+        const Entry &entry = entries.at(i);
+        alive[i] = !(entry.flags & kIsRemoved) && alive.at(static_cast<int>(entry.parent));
+    }
+
+    QVector<quint32> newRows(entries.count(), kInvalidRow);
+    QVector<Entry> newEntries;
+    QByteArray newArena;
+    newArena.reserve(arena.size());
+    for (int i = 0; i < entries.count(); ++i) {
+        if (!alive.at(i))
+            continue;
+
+        Entry entry = entries.at(i);
+        const QByteArray &name = nameAt(static_cast<quint32>(i));
+        newRows[i] = static_cast<quint32>(newEntries.count());
+        entry.nameOffset = static_cast<quint32>(newArena.size());
+        newArena.append(name);
+        newEntries.append(entry);
+    }
+
+    for (Entry &entry : newEntries) {
+        if (entry.parent != kInvalidRow)
+            entry.parent = newRows.at(static_cast<int>(entry.parent));
+    }
+
+    entries.swap(newEntries);
+    arena.swap(newArena);
+    removedCount = 0;
+    rebuildChildren();
+}
+
+bool FileNameTable::save(const QString &file) const
+{
+    FileHeader header;
+    memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.version = kFileVersion;
+    header.entryCount = static_cast<quint32>(entries.count());
+    header.arenaSize = static_cast<quint32>(arena.size());
+    header.reserved = 0;
+
+    // the old file is kept if writing fails
+    QSaveFile saveFile(file);
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "can not save the file name index:" << file << saveFile.errorString();
+        return false;
+    }
+
+    saveFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    saveFile.write(reinterpret_cast<const char *>(entries.constData()), static_cast<qint64>(entries.count() * sizeof(Entry)));
+    saveFile.write(arena);
+    // QSaveFile copies the permissions of the old file, the names must not be readable by the users
+    saveFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+    return saveFile.commit();
+}
+
+bool FileNameTable::load(const QString &file)
+{
+    QFile loadFile(file);
+    if (!loadFile.open(QIODevice::ReadOnly))
+        return false;
+
+    FileHeader header;
+    if (loadFile.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+        || memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0
+        || header.version != kFileVersion
+        || header.entryCount == 0
+        || static_cast<quint64>(loadFile.size()) != sizeof(header) + header.entryCount * static_cast<quint64>(sizeof(Entry)) + header.arenaSize) {
+        qWarning() << "the file name index is broken:" << file;
+        return false;
+    }
+
+    QVector<Entry> newEntries(static_cast<int>(header.entryCount));
+    const qint64 entriesSize = static_cast<qint64>(newEntries.count() * sizeof(Entry));
+    if (loadFile.read(reinterpret_cast<char *>(newEntries.data()), entriesSize) != entriesSize)
+        return false;
+    const QByteArray &newArena = loadFile.readAll();
+    if (newArena.size() != static_cast<int>(header.arenaSize))
+        return false;
+
+    int removed = 0;
+    for (int i = 0; i < newEntries.count(); ++i) {
+        const Entry &entry = newEntries.at(i);
+        const bool parentValid = i == kRootRow ? entry.parent == kInvalidRow : entry.parent < static_cast<quint32>(i);
+        if (!parentValid || static_cast<quint64>(entry.nameOffset) + entry.nameSize > header.arenaSize) {
+            qWarning() << "the file name index is broken:" << file;
+            return false;
+        }
+        if (entry.flags & kIsRemoved)
+            ++removed;
+    }
+
+    entries.swap(newEntries);
+    arena = newArena;
+    removedCount = removed;
+    rebuildChildren();
+    return true;
+}
+
+quint64 FileNameTable::childKey(quint32 parent, const QByteArray &name)
+{
+    return (static_cast<quint64>(parent) << 32) | qHash(name);
+}
+
+void FileNameTable::rebuildChildren()
+{
+    children.clear();
+    children.reserve(entries.count());
+    for (int i = 1; i < entries.count(); ++i) {
+        const Entry &entry = entries.at(i);
+        if (!(entry.flags & kIsRemoved))
+            children.insert(childKey(entry.parent, nameAt(static_cast<quint32>(i))), static_cast<quint32>(i));
+    }
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILENAMETABLE_H
+#define FILENAMETABLE_H
+
+#include "daemonplugin_anything_global.h"
+
+#include <QByteArray>
+#include <QVector>
+#include <QMultiHash>
+
+DAEMONPANYTHING_BEGIN_NAMESPACE
+
+/*!
+ * \class FileNameTable
+ * \brief A compact tree of file names.
+ * Every row only keeps the row of its parent directory and the offset of its name in one byte arena,
+ * so a path is rebuilt by walking up the parents. The rows and the arena are written to the disk as they are.
+ * A removed directory only marks its own row, its children are unreachable and dropped by the next compaction.
+ * The table is not thread safe.
+ */
+class FileNameTable
+{
+public:
+    static constexpr quint32 kRootRow { 0 };
+    static constexpr quint32 kInvalidRow { 0xFFFFFFFF };
+
+    FileNameTable();
+
+    int count() const;
+    int rowCount() const;
+    bool isDir(quint32 row) const;
+    bool isAlive(quint32 row) const;
+    QByteArray nameAt(quint32 row) const;
+    QByteArray pathAt(quint32 row) const;
+    bool isAncestor(quint32 ancestor, quint32 row) const;
+
+    quint32 find(const QByteArray &path) const;
+    quint32 child(quint32 parent, const QByteArray &name) const;
+    quint32 insert(quint32 parent, const QByteArray &name, bool isDir);
+    void remove(quint32 row);
+    void merge(quint32 row, const FileNameTable &other);
+    void clear();
+
+    bool needCompact() const;
+    void compact();
+
+    bool save(const QString &file) const;
+    bool load(const QString &file);
+
+private:
+    enum EntryFlag : quint16 {
+        kIsDir = 0x01,
+        kIsRemoved = 0x02,
+    };
+
+    struct Entry
+    {
+        quint32 parent;
+        quint32 nameOffset;
+        quint16 nameSize;
+        quint16 flags;
+    };
+
+    static quint64 childKey(quint32 parent, const QByteArray &name);
+    void rebuildChildren();
+
+    QVector<Entry> entries;
+    QByteArray arena;
+    QMultiHash<quint64, quint32> children;
+    int removedCount { 0 };
+};
+
+DAEMONPANYTHING_END_NAMESPACE
+
+#endif   // FILENAMETABLE_H
@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DAEMONPLUGIN_FULLTEXT_GLOBAL_H
+#define DAEMONPLUGIN_FULLTEXT_GLOBAL_H
+
+#define DAEMONPFULLTEXT_NAMESPACE daemonplugin_fulltext
+#define DAEMONPFULLTEXT_BEGIN_NAMESPACE namespace DAEMONPFULLTEXT_NAMESPACE {
+#define DAEMONPFULLTEXT_END_NAMESPACE }
+#define DAEMONPFULLTEXT_USE_NAMESPACE using namespace DAEMONPFULLTEXT_NAMESPACE;
+
+#endif   // DAEMONPLUGIN_FULLTEXT_GLOBAL_H
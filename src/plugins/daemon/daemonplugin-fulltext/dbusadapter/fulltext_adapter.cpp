@@ -0,0 +1,52 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./fulltextdbus.h -c FullTextAdapter -l FullTextDBus -a dbusadapter/fulltext_adapter fulltextdbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2017 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * Do not edit! All changes made to it will be lost.
+ */
+
+#include "dbusadapter/fulltext_adapter.h"
+#include <QtCore/QMetaObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+/*
+ * Implementation of adaptor class FullTextAdapter
+ */
+
+FullTextAdapter::FullTextAdapter(FullTextDBus *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    // constructor
+    setAutoRelaySignals(true);
+}
+
+FullTextAdapter::~FullTextAdapter()
+{
+    // destructor
+}
+
+bool FullTextAdapter::CreateIndex()
+{
+    // handle method call com.deepin.filemanager.daemon.FullTextIndex.CreateIndex
+    return parent()->CreateIndex();
+}
+
+QStringList FullTextAdapter::Search(const QString &path, const QString &keyword)
+{
+    // handle method call com.deepin.filemanager.daemon.FullTextIndex.Search
+    return parent()->Search(path, keyword);
+}
+
+void FullTextAdapter::StopIndex()
+{
+    // handle method call com.deepin.filemanager.daemon.FullTextIndex.StopIndex
+    parent()->StopIndex();
+}
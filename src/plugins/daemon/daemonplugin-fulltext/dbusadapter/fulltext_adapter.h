@@ -0,0 +1,66 @@
+/*
+ * This file was generated by qdbusxml2cpp version 0.8
+ * Command line was: qdbusxml2cpp -i ./fulltextdbus.h -c FullTextAdapter -l FullTextDBus -a dbusadapter/fulltext_adapter fulltextdbus.xml
+ *
+ * qdbusxml2cpp is Copyright (C) 2017 The Qt Company Ltd.
+ *
+ * This is an auto-generated file.
+ * This file may have been hand-edited. Look for HAND-EDIT comments
+ * before re-generating it.
+ */
+
+#ifndef FULLTEXT_ADAPTER_H
+#define FULLTEXT_ADAPTER_H
+
+#include <QtCore/QObject>
+#include <QtDBus/QtDBus>
+#include "../fulltextdbus.h"
+QT_BEGIN_NAMESPACE
+class QByteArray;
+template<class T>
+class QList;
+template<class Key, class Value>
+class QMap;
+class QString;
+class QStringList;
+class QVariant;
+QT_END_NAMESPACE
+
+/*
+ * Adaptor class for interface com.deepin.filemanager.daemon.FullTextIndex
+ */
+class FullTextAdapter : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.filemanager.daemon.FullTextIndex")
+    Q_CLASSINFO("D-Bus Introspection", ""
+                                       "  <interface name=\"com.deepin.filemanager.daemon.FullTextIndex\">\n"
+                                       "    <method name=\"CreateIndex\">\n"
+                                       "      <arg direction=\"out\" type=\"b\"/>\n"
+                                       "    </method>\n"
+                                       "    <method name=\"StopIndex\"/>\n"
+                                       "    <method name=\"Search\">\n"
+                                       "      <arg direction=\"out\" type=\"as\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"path\"/>\n"
+                                       "      <arg direction=\"in\" type=\"s\" name=\"keyword\"/>\n"
+                                       "    </method>\n"
+                                       "  </interface>\n"
+                                       "")
+public:
+    FullTextAdapter(FullTextDBus *parent);
+    virtual ~FullTextAdapter();
+
+    inline FullTextDBus *parent() const
+    {
+        return static_cast<FullTextDBus *>(QObject::parent());
+    }
+
+public:   // PROPERTIES
+public Q_SLOTS:   // METHODS
+    bool CreateIndex();
+    QStringList Search(const QString &path, const QString &keyword);
+    void StopIndex();
+Q_SIGNALS:   // SIGNALS
+};
+
+#endif
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fulltext.h"
+#include "fulltextdbus.h"
+
+DAEMONPFULLTEXT_USE_NAMESPACE
+
+void FullText::initialize()
+{
+}
+
+bool FullText::start()
+{
+    mng.reset(new FullTextDBus(this));
+    return true;
+}
+
+void FullText::stop()
+{
+    // stop the index threads before the plugin is unloaded
+    mng.reset();
+}
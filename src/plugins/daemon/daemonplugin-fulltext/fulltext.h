@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FULLTEXT_H
+#define FULLTEXT_H
+
+#include "daemonplugin_fulltext_global.h"
+
+#include <dfm-framework/dpf.h>
+
+class FullTextDBus;
+DAEMONPFULLTEXT_BEGIN_NAMESPACE
+
+class FullText : public DPF_NAMESPACE::Plugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.deepin.plugin.daemon" FILE "fulltext.json")
+
+public:
+    virtual void initialize() override;
+    virtual bool start() override;
+    virtual void stop() override;
+
+private:
+    QScopedPointer<FullTextDBus> mng;
+};
+
+DAEMONPFULLTEXT_END_NAMESPACE
+#endif   // FULLTEXT_H
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fulltextdbus.h"
+#include "fulltextindexer.h"
+#include "dbusadapter/fulltext_adapter.h"
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusObjectPath>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QtConcurrent>
+#include <QDebug>
+
+static constexpr char kFullTextObjPath[] { "/com/deepin/filemanager/daemon/FullTextIndex" };
+static constexpr char kLogin1Service[] { "org.freedesktop.login1" };
+static constexpr char kLogin1Path[] { "/org/freedesktop/login1" };
+static constexpr char kLogin1ManagerIface[] { "org.freedesktop.login1.Manager" };
+static constexpr uint kMinUserUid = 1000;   // UID_MIN of login.defs
+static constexpr uint kNobodyUid = 65534;
+static constexpr int kMaxIndexers = 8;   // every indexer holds the inotify watches of a user
+
+DAEMONPFULLTEXT_USE_NAMESPACE
+
+FullTextDBus::FullTextDBus(QObject *parent)
+    : QObject(parent), QDBusContext()
+{
+    QDBusConnection::systemBus().registerObject(kFullTextObjPath, this);
+    adapter = new FullTextAdapter(this);
+}
+
+FullTextDBus::~FullTextDBus()
+{
+    indexers.clear();
+    if (adapter)
+        delete adapter;
+    adapter = nullptr;
+}
+
+/*!
+ * \brief FullTextDBus::CreateIndex Start to index the files of the caller,
+ * the index is kept up to date until StopIndex is called or the daemon exits.
+ * Only the users logged in can be indexed.
+ * \return false if the caller is not allowed to be indexed
+ */
+bool FullTextDBus::CreateIndex()
+{
+    const uint uid = callerUid();
+    if (indexers.contains(uid))
+        return true;
+
+    if (!isIndexAllowed(uid))
+        return false;
+
+    QSharedPointer<FullTextIndexer> indexer(new FullTextIndexer(uid));
+    if (!indexer->isValid()) {
+        qWarning() << "can not index for unknown user:" << uid;
+        return false;
+    }
+
+    qInfo() << "start full-text index of user" << uid;
+    indexer->start();
+    indexers.insert(uid, indexer);
+    return true;
+}
+
+void FullTextDBus::StopIndex()
+{
+    const uint uid = callerUid();
+    if (indexers.remove(uid) > 0)
+        qInfo() << "full-text index of user" << uid << "is stopped";
+}
+
+/*!
+ * \brief FullTextDBus::Search Search the index that the caller created by CreateIndex,
+ * the reply is sent when the search finished so that the daemon keeps serving other calls.
+ * \param path the directory to search in
+ * \param keyword the keyword processed by the searcher
+ * \return the matched files, they may not exist if the index is not updated yet
+ */
+QStringList FullTextDBus::Search(const QString &path, const QString &keyword)
+{
+    // the index is only created by CreateIndex, the caller searches by itself without it
+    auto indexer = indexers.value(callerUid());
+    if (!indexer) {
+        sendErrorReply(QDBusError::Failed, "the full-text index of the caller is not created");
+        return {};
+    }
+
+    setDelayedReply(true);
+    const QDBusMessage msg = message();
+    QtConcurrent::run([indexer, msg, path, keyword]() {
+        const QStringList results = indexer->search(path, keyword);
+        QDBusConnection::systemBus().send(msg.createReply(results));
+    });
+
+    return {};
+}
+
+uint FullTextDBus::callerUid()
+{
+    return connection().interface()->serviceUid(message().service()).value();
+}
+
+bool FullTextDBus::isIndexAllowed(uint uid) const
+{
+    if (uid < kMinUserUid || uid == kNobodyUid) {
+        qWarning() << "full-text index is refused for the system user:" << uid;
+        return false;
+    }
+
+    if (indexers.size() >= kMaxIndexers) {
+        qWarning() << "full-text index is refused for user" << uid << ", too many indexers:" << indexers.size();
+        return false;
+    }
+
+    // logind knows the user only when it has sessions
+    QDBusInterface login1(kLogin1Service, kLogin1Path, kLogin1ManagerIface, QDBusConnection::systemBus());
+    QDBusReply<QDBusObjectPath> reply = login1.call("GetUser", uid);
+    if (!reply.isValid()) {
+        qWarning() << "full-text index is refused for user" << uid << ", not logged in:" << reply.error().message();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FULLTEXTDBUS_H
+#define FULLTEXTDBUS_H
+
+#include "daemonplugin_fulltext_global.h"
+
+#include <QObject>
+#include <QDBusContext>
+#include <QSharedPointer>
+#include <QHash>
+
+DAEMONPFULLTEXT_BEGIN_NAMESPACE
+class FullTextIndexer;
+DAEMONPFULLTEXT_END_NAMESPACE
+
+class FullTextAdapter;
+class FullTextDBus : public QObject, public QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.filemanager.daemon.FullTextIndex")
+
+public:
+    explicit FullTextDBus(QObject *parent = nullptr);
+    ~FullTextDBus();
+
+public slots:
+    bool CreateIndex();
+    void StopIndex();
+    QStringList Search(const QString &path, const QString &keyword);
+
+private:
+    uint callerUid();
+    bool isIndexAllowed(uint uid) const;
+
+private:
+    FullTextAdapter *adapter = nullptr;
+    QHash<uint, QSharedPointer<DAEMONPFULLTEXT_NAMESPACE::FullTextIndexer>> indexers;
+};
+
+#endif   // FULLTEXTDBUS_H
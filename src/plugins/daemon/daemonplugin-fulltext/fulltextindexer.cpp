@@ -0,0 +1,702 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fulltextindexer.h"
+#include "chineseanalyzer.h"
+
+#include "dfm-base/base/device/deviceutils.h"
+
+// Lucune++ headers
+#include <MapFieldSelector.h>
+#include <PrefixQuery.h>
+#include <QueryWrapperFilter.h>
+
+#include <QSocketNotifier>
+#include <QProcess>
+#include <QFile>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QVector>
+#include <QTimer>
+#include <QDir>
+#include <QDebug>
+
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <grp.h>
+#include <pwd.h>
+
+static constexpr char kFilterFolders[] = "^/(boot|dev|proc|sys|run|lib|usr).*$";
+static constexpr char kSupportFiles[] = "(rtf)|(odt)|(ods)|(odp)|(odg)|(docx)|(xlsx)|(pptx)|(ppsx)|(md)|"
+                                        "(xls)|(xlsb)|(doc)|(dot)|(wps)|(ppt)|(pps)|(txt)|(pdf)|(dps)";
+static constexpr int kMaxResultNum = 100000;   // 最大搜索结果数
+static constexpr int kCommitInterval = 3000;   // 合并文件事件的时间窗口(ms)
+static constexpr int kCommitBatch = 200;   // 扫描时每索引这么多文件提交一次，使搜索能看到进度
+static constexpr int kNiceValue = 19;
+static constexpr int kParseTimeout = 60000;   // 解析单个文件的最长时间(ms)
+static constexpr quint32 kMaxContentSize = 64 * 1024 * 1024;
+static constexpr char kDocParserTool[] { DFM_DOCPARSER_TOOL };
+static constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+        | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+// no glibc wrapper for ioprio_set
+static constexpr int kIoprioWhoProcess = 1;
+static constexpr int kIoprioClassIdle = 3;
+static constexpr int kIoprioClassShift = 13;
+
+using namespace Lucene;
+DFMBASE_USE_NAMESPACE
+DAEMONPFULLTEXT_USE_NAMESPACE
+
+namespace {
+bool isSkippedName(const char *name)
+{
+    if (!strcmp(name, ".") || !strcmp(name, ".."))
+        return true;
+    return name[0] == '.' && strncmp(name, ".local", strlen(".local"));
+}
+
+DocumentPtr fileDocument(const QString &file, const QString &modifyTime, const QString &contents)
+{
+    DocumentPtr doc = newLucene<Document>();
+    // file path
+    doc->add(newLucene<Field>(L"path", file.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+
+    // file last modified time
+    doc->add(newLucene<Field>(L"modified", modifyTime.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
+
+    // file contents
+    doc->add(newLucene<Field>(L"contents", contents.toStdWString(), Field::STORE_YES, Field::INDEX_ANALYZED));
+
+    return doc;
+}
+
+QString modifiedTime(const QString &file)
+{
+    return QFileInfo(file).lastModified().toString("yyyyMMddHHmmss");
+}
+}   // namespace
+
+FullTextIndexer::FullTextIndexer(uint uid)
+    : QObject(nullptr), uid(uid)
+{
+    struct passwd *pw = getpwuid(uid);
+    if (pw) {
+        gid = pw->pw_gid;
+        userName = pw->pw_name;
+        // apart from the index of the file manager, which writes its own when the daemon is not available
+        indexPath = QString(pw->pw_dir) + "/.config/deepin/dde-file-manager/daemon-index";
+    }
+
+    bindPathTable = DeviceUtils::fstabBindInfo();
+    moveToThread(&workerThread);
+}
+
+FullTextIndexer::~FullTextIndexer()
+{
+    stopped = true;
+    if (workerThread.isRunning()) {
+        QMetaObject::invokeMethod(this, "release", Qt::BlockingQueuedConnection);
+        workerThread.quit();
+        workerThread.wait();
+    }
+}
+
+bool FullTextIndexer::isValid() const
+{
+    return !indexPath.isEmpty();
+}
+
+void FullTextIndexer::start()
+{
+    workerThread.start();
+    QMetaObject::invokeMethod(this, "initIndex", Qt::QueuedConnection);
+}
+
+QStringList FullTextIndexer::search(const QString &path, const QString &keyword)
+{
+    IndexReaderPtr current;
+    {
+        QMutexLocker lk(&readerMutex);
+        current = reader;
+        if (current)
+            current->incRef();
+    }
+    if (!current)
+        return {};
+
+    QStringList results;
+    try {
+        SearcherPtr searcher = newLucene<IndexSearcher>(current);
+        QueryParserPtr parser = newLucene<QueryParser>(LuceneVersion::LUCENE_CURRENT, L"contents", newLucene<ChineseAnalyzer>());
+        //设定第一个* 可以匹配
+        parser->setAllowLeadingWildcard(true);
+        QueryPtr query = parser->parse(keyword.toStdWString());
+
+        // create query filter
+        String filterPath = path.endsWith("/") ? (path + "*").toStdWString() : (path + "/*").toStdWString();
+        FilterPtr filter = newLucene<QueryWrapperFilter>(newLucene<WildcardQuery>(newLucene<Term>(L"path", filterPath)));
+
+        TopDocsPtr topDocs = searcher->search(query, filter, kMaxResultNum);
+        // only load the path, the stored contents are big
+        FieldSelectorPtr selector = newLucene<MapFieldSelector>(newCollection<String>(L"path"));
+        for (auto scoreDoc : topDocs->scoreDocs) {
+            if (stopped)
+                break;
+
+            String resultPath = current->document(scoreDoc->doc, selector)->get(L"path");
+            if (!resultPath.empty())
+                results.append(QString::fromStdWString(resultPath));
+        }
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+    current->decRef();
+
+    // the directories are not watched, check the searched one for the next search
+    if (watchesExhausted) {
+        QMutexLocker lk(&pendingMutex);
+        pendingDirs.insert(path);
+        QMetaObject::invokeMethod(this, "schedule", Qt::QueuedConnection);
+    }
+
+    return results;
+}
+
+void FullTextIndexer::initIndex()
+{
+    if (!switchToUser() || !openIndex())
+        return;
+
+    loadIndexedFiles();
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        qWarning() << "inotify init failed, the index is updated when searching. errno:" << errno;
+        watchesExhausted = true;
+    } else {
+        notifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &FullTextIndexer::onInotifyEvent);
+    }
+
+    commitTimer = new QTimer(this);
+    commitTimer->setSingleShot(true);
+    commitTimer->setInterval(kCommitInterval);
+    connect(commitTimer, &QTimer::timeout, this, &FullTextIndexer::processPending);
+
+    // record spending
+    QElapsedTimer timer;
+    timer.start();
+    QSet<QString> visited;
+    scanDirectory("/", &visited);
+    if (stopped)
+        return;
+
+    removeStaleFiles("/", visited);
+    commit();
+    qInfo() << "full-text index of user" << uid << "is ready, files:" << indexedFiles.size()
+            << "watches:" << watchedDirs.size() << "spending:" << timer.elapsed();
+}
+
+void FullTextIndexer::onInotifyEvent()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+
+    Q_FOREVER {
+        const ssize_t len = read(inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
+
+        const struct inotify_event *event = nullptr;
+        for (char *ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + event->len) {
+            event = reinterpret_cast<const struct inotify_event *>(ptr);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events are lost, check all the files again
+                QMutexLocker lk(&pendingMutex);
+                pendingDirs.insert("/");
+                changed = true;
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                watchedDirs.remove(event->wd);
+                continue;
+            }
+
+            const QString dir = watchedDirs.value(event->wd);
+            if (dir.isEmpty() || event->len == 0 || isSkippedName(event->name))
+                continue;
+
+            const QString path = (dir == "/" ? dir : dir + "/") + QString::fromUtf8(event->name);
+            QMutexLocker lk(&pendingMutex);
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    pendingDirs.insert(path);
+                else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                    removedDirs.insert(path);
+            } else if (isSupportFile(path)) {
+                pendingFiles.insert(path);
+            }
+            changed = true;
+        }
+    }
+
+    if (changed)
+        schedule();
+}
+
+void FullTextIndexer::schedule()
+{
+    // do not restart the timer, a file written continuously still gets indexed
+    if (commitTimer && !commitTimer->isActive())
+        commitTimer->start();
+}
+
+void FullTextIndexer::processPending()
+{
+    QSet<QString> files;
+    QSet<QString> dirs;
+    QSet<QString> removed;
+    {
+        QMutexLocker lk(&pendingMutex);
+        files.swap(pendingFiles);
+        dirs.swap(pendingDirs);
+        removed.swap(removedDirs);
+    }
+
+    // the removed directories go first, a directory moved out and back is scanned again
+    for (const QString &dir : removed)
+        removeDirectory(dir);
+
+    for (const QString &dir : dirs) {
+        if (stopped)
+            return;
+
+        QSet<QString> visited;
+        scanDirectory(dir, &visited);
+        removeStaleFiles(dir, visited);
+    }
+
+    for (const QString &file : files) {
+        if (stopped)
+            return;
+
+        struct stat st;
+        if (lstat(file.toStdString().c_str(), &st) == 0 && !S_ISDIR(st.st_mode))
+            indexFile(file);
+        else
+            removeFile(file);
+    }
+
+    commit();
+}
+
+void FullTextIndexer::release()
+{
+    stopParser();
+    delete commitTimer;
+    commitTimer = nullptr;
+    delete notifier;
+    notifier = nullptr;
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+    inotifyFd = -1;
+
+    try {
+        if (writer)
+            writer->close();
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+    writer.reset();
+
+    QMutexLocker lk(&readerMutex);
+    if (reader)
+        reader->decRef();
+    reader.reset();
+}
+
+/*!
+ * \brief FullTextIndexer::switchToUser Drop the privileges of this thread to the user,
+ * the threads created by the index writer and the parser process inherit them.
+ * The raw syscalls only change the current thread, the glibc wrappers would change the whole daemon.
+ * \return false if the thread can not switch to the user
+ */
+bool FullTextIndexer::switchToUser()
+{
+    int count = 64;
+    QVector<gid_t> groups(count);
+    if (getgrouplist(userName.constData(), gid, groups.data(), &count) == -1) {
+        groups.resize(count);
+        getgrouplist(userName.constData(), gid, groups.data(), &count);
+    }
+    groups.resize(count);
+
+    if (syscall(SYS_setgroups, static_cast<size_t>(groups.size()), groups.constData()) != 0
+        || syscall(SYS_setresgid, gid, gid, gid) != 0
+        || syscall(SYS_setresuid, uid, uid, uid) != 0) {
+        qWarning() << "switch to user failed, user:" << uid << "errno:" << errno;
+        return false;
+    }
+
+    uid_t ruid = 0, euid = 0, suid = 0;
+    if (syscall(SYS_getresuid, &ruid, &euid, &suid) != 0 || ruid != uid || euid != uid || suid != uid) {
+        qWarning() << "switch to user failed, user:" << uid;
+        return false;
+    }
+
+    // indexing must not slow down the user's io and cpu
+    if (syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift) != 0)
+        qWarning() << "set idle io priority failed, errno:" << errno;
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), kNiceValue);
+
+    return true;
+}
+
+bool FullTextIndexer::openIndex()
+{
+    QDir dir;
+    if (!dir.exists(indexPath) && !dir.mkpath(indexPath)) {
+        qWarning() << "Unable to create directory: " << indexPath;
+        return false;
+    }
+
+    try {
+        FSDirectoryPtr directory = FSDirectory::open(indexPath.toStdWString());
+        const bool create = !IndexReader::indexExists(directory);
+        writer = newLucene<IndexWriter>(directory, newLucene<ChineseAnalyzer>(), create, IndexWriter::MaxFieldLengthLIMITED);
+        // a reader can not be opened before the first commit
+        writer->commit();
+
+        QMutexLocker lk(&readerMutex);
+        reader = IndexReader::open(directory, true);
+        return true;
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+
+    writer.reset();
+    return false;
+}
+
+/*!
+ * \brief FullTextIndexer::parseContents Parse the file by the parser process, which is started again
+ * after it crashed or timed out. The file is indexed without contents then, so it is not retried until changed.
+ */
+QString FullTextIndexer::parseContents(const QString &file)
+{
+    if (!parser) {
+        parser = new QProcess(this);
+        parser->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        parser->start(kDocParserTool, QStringList());
+        if (!parser->waitForStarted()) {
+            qWarning() << "start the document parser failed:" << parser->errorString();
+            stopParser();
+            return {};
+        }
+    }
+
+    QByteArray request = QFile::encodeName(file);
+    request.append('\0');
+    parser->write(request);
+
+    quint32 size = 0;
+    if (!readParser(reinterpret_cast<char *>(&size), sizeof(size)) || size > kMaxContentSize) {
+        qWarning() << "the document parser failed, file:" << file;
+        stopParser();
+        return {};
+    }
+
+    QByteArray contents(static_cast<int>(size), Qt::Uninitialized);
+    if (!readParser(contents.data(), size)) {
+        qWarning() << "the document parser failed, file:" << file;
+        stopParser();
+        return {};
+    }
+
+    return QString::fromUtf8(contents);
+}
+
+bool FullTextIndexer::readParser(char *data, qint64 size)
+{
+    while (size > 0) {
+        if (stopped || (parser->bytesAvailable() == 0 && !parser->waitForReadyRead(kParseTimeout)))
+            return false;
+
+        const qint64 len = parser->read(data, size);
+        if (len < 0)
+            return false;
+        data += len;
+        size -= len;
+    }
+    return true;
+}
+
+void FullTextIndexer::stopParser()
+{
+    if (!parser)
+        return;
+
+    parser->closeWriteChannel();
+    if (!parser->waitForFinished(1000)) {
+        parser->kill();
+        parser->waitForFinished(1000);
+    }
+    delete parser;
+    parser = nullptr;
+}
+
+void FullTextIndexer::loadIndexedFiles()
+{
+    IndexReaderPtr current;
+    {
+        QMutexLocker lk(&readerMutex);
+        current = reader;
+    }
+
+    try {
+        FieldSelectorPtr selector = newLucene<MapFieldSelector>(newCollection<String>(L"path", L"modified"));
+        const int32_t count = current->maxDoc();
+        for (int32_t i = 0; i < count; ++i) {
+            if (current->isDeleted(i))
+                continue;
+
+            DocumentPtr doc = current->document(i, selector);
+            indexedFiles.insert(QString::fromStdWString(doc->get(L"path")),
+                                QString::fromStdWString(doc->get(L"modified")));
+        }
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+}
+
+void FullTextIndexer::scanDirectory(const QString &path, QSet<QString> *visited)
+{
+    if (stopped || isFiltered(path))
+        return;
+
+    const std::string tmp = path.toStdString();
+    const char *filePath = tmp.c_str();
+    DIR *dir = nullptr;
+    if (!(dir = opendir(filePath)))
+        return;
+
+    addWatch(path);
+
+    struct dirent *dent = nullptr;
+    char fn[FILENAME_MAX] = { 0 };
+    strcpy(fn, filePath);
+    size_t len = strlen(filePath);
+    if (strcmp(filePath, "/"))
+        fn[len++] = '/';
+
+    // traverse
+    while ((dent = readdir(dir)) && !stopped) {
+        if (isSkippedName(dent->d_name))
+            continue;
+
+        struct stat st;
+        strncpy(fn + len, dent->d_name, FILENAME_MAX - len);
+        if (lstat(fn, &st) == -1)
+            continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            scanDirectory(fn, visited);
+        } else if (isSupportFile(fn)) {
+            if (visited)
+                visited->insert(fn);
+            indexFile(fn);
+        }
+    }
+
+    closedir(dir);
+}
+
+void FullTextIndexer::addWatch(const QString &dir)
+{
+    if (inotifyFd < 0 || watchesExhausted)
+        return;
+
+    const int wd = inotify_add_watch(inotifyFd, dir.toStdString().c_str(), kWatchMask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            qWarning() << "inotify watches are exhausted, the unwatched directories are updated when searching";
+            watchesExhausted = true;
+        }
+        return;
+    }
+
+    watchedDirs.insert(wd, dir);
+}
+
+void FullTextIndexer::removeWatches(const QString &dir)
+{
+    // a moved directory keeps its watch, but the path of it is out of date
+    const QString prefix = dir + "/";
+    for (auto it = watchedDirs.begin(); it != watchedDirs.end();) {
+        if (it.value() == dir || it.value().startsWith(prefix)) {
+            inotify_rm_watch(inotifyFd, it.key());
+            it = watchedDirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FullTextIndexer::indexFile(const QString &file)
+{
+    const QString modifyTime = modifiedTime(file);
+    auto it = indexedFiles.constFind(file);
+    const bool exists = it != indexedFiles.constEnd();
+    if (exists && it.value() == modifyTime)
+        return;
+
+    try {
+        if (exists) {
+            qDebug() << "Update file: [" << file << "]";
+            writer->updateDocument(newLucene<Term>(L"path", file.toStdWString()), fileDocument(file, modifyTime, parseContents(file)));
+        } else {
+            qDebug() << "Adding [" << file << "]";
+            writer->addDocument(fileDocument(file, modifyTime, parseContents(file)));
+        }
+        indexedFiles.insert(file, modifyTime);
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << " file: " << file;
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what()) << " file: " << file;
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__ << " file: " << file;
+    }
+
+    if (++uncommittedCount >= kCommitBatch)
+        commit();
+}
+
+void FullTextIndexer::removeFile(const QString &file)
+{
+    if (!indexedFiles.remove(file))
+        return;
+
+    try {
+        qDebug() << "Delete file: [" << file << "]";
+        writer->deleteDocuments(newLucene<Term>(L"path", file.toStdWString()));
+        ++uncommittedCount;
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << " file: " << file;
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__ << " file: " << file;
+    }
+}
+
+void FullTextIndexer::removeDirectory(const QString &dir)
+{
+    removeWatches(dir);
+
+    const QString prefix = dir + "/";
+    bool removed = false;
+    for (auto it = indexedFiles.begin(); it != indexedFiles.end();) {
+        if (it.key().startsWith(prefix)) {
+            it = indexedFiles.erase(it);
+            removed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (!removed)
+        return;
+
+    try {
+        qDebug() << "Delete directory: [" << dir << "]";
+        writer->deleteDocuments(newLucene<PrefixQuery>(newLucene<Term>(L"path", prefix.toStdWString())));
+        ++uncommittedCount;
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError()) << " dir: " << dir;
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__ << " dir: " << dir;
+    }
+}
+
+void FullTextIndexer::removeStaleFiles(const QString &dir, const QSet<QString> &visited)
+{
+    // the files not found by the scan are removed or not readable by the user any more
+    const QString prefix = dir.endsWith("/") ? dir : dir + "/";
+    QStringList staleFiles;
+    for (auto it = indexedFiles.constBegin(); it != indexedFiles.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && !visited.contains(it.key()))
+            staleFiles.append(it.key());
+    }
+
+    for (const QString &file : staleFiles)
+        removeFile(file);
+}
+
+void FullTextIndexer::commit()
+{
+    if (uncommittedCount == 0)
+        return;
+
+    try {
+        writer->commit();
+        uncommittedCount = 0;
+        refreshReader();
+    } catch (const LuceneException &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString::fromStdWString(e.getError());
+    } catch (const std::exception &e) {
+        qWarning() << "Error: " << __FUNCTION__ << QString(e.what());
+    } catch (...) {
+        qWarning() << "Error: " << __FUNCTION__;
+    }
+}
+
+void FullTextIndexer::refreshReader()
+{
+    QMutexLocker lk(&readerMutex);
+    IndexReaderPtr newReader = reader->reopen();
+    if (newReader == reader)
+        return;
+
+    // the searching threads hold a reference of the old reader, the last one closes it
+    reader->decRef();
+    reader = newReader;
+}
+
+bool FullTextIndexer::isFiltered(const QString &path) const
+{
+    // filter some folders
+    static const QRegularExpression reg(kFilterFolders);
+    if (bindPathTable.contains(path) || (reg.match(path).hasMatch() && !path.startsWith("/run/user")))
+        return true;
+
+    // limit file name length and level
+    return path.size() > FILENAME_MAX - 1 || path.count('/') > 20;
+}
+
+bool FullTextIndexer::isSupportFile(const QString &file)
+{
+    static const QRegularExpression suffixRegExp(QString("^(%1)$").arg(kSupportFiles));
+    return suffixRegExp.match(QFileInfo(file).suffix()).hasMatch();
+}
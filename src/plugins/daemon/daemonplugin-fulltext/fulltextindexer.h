@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FULLTEXTINDEXER_H
+#define FULLTEXTINDEXER_H
+
+#include "daemonplugin_fulltext_global.h"
+
+#include <lucene++/LuceneHeaders.h>
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QMap>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+class QProcess;
+class QTimer;
+QT_END_NAMESPACE
+
+DAEMONPFULLTEXT_BEGIN_NAMESPACE
+
+/*!
+ * \class FullTextIndexer
+ * \brief The full-text index of one user.
+ * The index lives in its own thread which drops the privileges to the user and runs with idle io priority,
+ * the documents are parsed by the dfm-docparser process started by that thread, never in the daemon.
+ * The index is kept apart from the one of the file manager, since the IndexWriter holds the write lock.
+ * The IndexWriter is kept open for the whole lifetime, the first scan only re-parses the files whose modified
+ * time differs from the index, and then the index is updated by the inotify events of the scanned directories.
+ * search() can be called from any thread, it runs on a shared reader which is reopened after every commit.
+ */
+class FullTextIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FullTextIndexer(uint uid);
+    ~FullTextIndexer();
+
+    bool isValid() const;
+    void start();
+    QStringList search(const QString &path, const QString &keyword);
+
+private slots:
+    void initIndex();
+    void onInotifyEvent();
+    void schedule();
+    void processPending();
+    void release();
+
+private:
+    bool switchToUser();
+    bool openIndex();
+    QString parseContents(const QString &file);
+    bool readParser(char *data, qint64 size);
+    void stopParser();
+    void loadIndexedFiles();
+    void scanDirectory(const QString &path, QSet<QString> *visited);
+    void addWatch(const QString &dir);
+    void removeWatches(const QString &dir);
+    void indexFile(const QString &file);
+    void removeFile(const QString &file);
+    void removeDirectory(const QString &dir);
+    void removeStaleFiles(const QString &dir, const QSet<QString> &visited);
+    void commit();
+    void refreshReader();
+    bool isFiltered(const QString &path) const;
+    static bool isSupportFile(const QString &file);
+
+private:
+    QThread workerThread;
+    const uint uid;
+    uint gid { 0 };
+    QByteArray userName;
+    QString indexPath;
+    QMap<QString, QString> bindPathTable;
+    std::atomic_bool stopped { false };
+    std::atomic_bool watchesExhausted { false };
+
+    // only touched in the worker thread
+    Lucene::IndexWriterPtr writer;
+    QHash<QString, QString> indexedFiles;   // path -> modified time
+    int uncommittedCount { 0 };
+    int inotifyFd { -1 };
+    QSocketNotifier *notifier { nullptr };
+    QProcess *parser { nullptr };
+    QTimer *commitTimer { nullptr };
+    QHash<int, QString> watchedDirs;
+
+    // filled by the inotify events and the searches
+    QMutex pendingMutex;
+    QSet<QString> pendingFiles;
+    QSet<QString> pendingDirs;
+    QSet<QString> removedDirs;
+
+    QMutex readerMutex;
+    Lucene::IndexReaderPtr reader;
+};
+
+DAEMONPFULLTEXT_END_NAMESPACE
+
+#endif   // FULLTEXTINDEXER_H
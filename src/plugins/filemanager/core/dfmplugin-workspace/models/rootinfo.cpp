@@ -13,12 +13,17 @@
 
 #include <QApplication>
 #include <QtConcurrent>
+#include <QTimer>
 
 using namespace dfmbase;
 using namespace dfmplugin_workspace;
 
+static constexpr int kWatcherEventInterval { 100 };   // 合并文件事件的时间窗口(ms)
+// 每个被删除的文件都会发送，使用类型化的事件句柄避免字符串查找
+static const DPF_NAMESPACE::SlotHandle<QUrl> kTabCloseSlot { "dfmplugin_workspace", "slot_Tab_Close" };
+
 RootInfo::RootInfo(const QUrl &u, const bool canCache, QObject *parent)
-    : QObject(parent), url(u), canCache(canCache)
+    : QObject(parent), url(u), childrenTable(u), canCache(canCache)
 {
     QString localFilePath = url.path();
     auto info = InfoFactory::create<AbstractFileInfo>(url);
@@ -26,6 +31,11 @@ RootInfo::RootInfo(const QUrl &u, const bool canCache, QObject *parent)
         localFilePath = info->pathOf(PathInfoType::kPath);
     hiddenFileUrl = QUrl::fromLocalFile(localFilePath + "/.hidden");
 
+    watcherEventTimer = new QTimer(this);
+    watcherEventTimer->setSingleShot(true);
+    watcherEventTimer->setInterval(kWatcherEventInterval);
+    connect(watcherEventTimer, &QTimer::timeout, this, &RootInfo::doThreadWatcherEvent);
+
     // create watcher
     watcher = WatcherFactory::create<AbstractFileWatcher>(url);
     if (watcher.isNull()) {
@@ -141,8 +151,7 @@ void RootInfo::reset()
 {
     {
         QWriteLocker lk(&childrenLock);
-        childrenUrlList.clear();
-        sourceDataList.clear();
+        childrenTable.clear();
     }
 
     traversalFinish = false;
@@ -151,7 +160,7 @@ void RootInfo::reset()
 void RootInfo::doFileDeleted(const QUrl &url)
 {
     enqueueEvent(QPair<QUrl, EventType>(url, kRmFile));
-    metaObject()->invokeMethod(this, QT_STRINGIFY(doThreadWatcherEvent), Qt::QueuedConnection);
+    scheduleWatcherEvent();
 }
 
 void RootInfo::dofileMoved(const QUrl &fromUrl, const QUrl &toUrl)
@@ -194,13 +203,13 @@ void RootInfo::dofileMoved(const QUrl &fromUrl, const QUrl &toUrl)
 void RootInfo::dofileCreated(const QUrl &url)
 {
     enqueueEvent(QPair<QUrl, EventType>(url, kAddFile));
-    metaObject()->invokeMethod(this, QT_STRINGIFY(doThreadWatcherEvent), Qt::QueuedConnection);
+    scheduleWatcherEvent();
 }
 
 void RootInfo::doFileUpdated(const QUrl &url)
 {
     enqueueEvent(QPair<QUrl, EventType>(url, kUpdateFile));
-    metaObject()->invokeMethod(this, QT_STRINGIFY(doThreadWatcherEvent), Qt::QueuedConnection);
+    scheduleWatcherEvent();
 }
 
 void RootInfo::doWatcherEvent()
@@ -210,39 +219,53 @@ void RootInfo::doWatcherEvent()
 
     processFileEventRuning = true;
     while (checkFileEventQueue()) {
-        QPair<QUrl, EventType> event;
+        QQueue<QPair<QUrl, EventType>> events;
         {
             QMutexLocker lk(&watcherEventMutex);
-            event = watcherEvent.dequeue();
+            events.swap(watcherEvent);
         }
-        const QUrl &fileUrl = event.first;
 
         if (cancelWatcherEvent)
             return;
 
-        if (!fileUrl.isValid())
-            continue;
-
-        if (UniversalUtils::urlEquals(fileUrl, url)) {
-            if (event.second == kAddFile)
+        QList<QUrl> addUrls;
+        QList<QUrl> updateUrls;
+        QList<QUrl> rmUrls;
+        bool rootRemoved = false;
+        for (const auto &event : coalesceEvents(events)) {
+            const QUrl &fileUrl = event.first;
+            if (UniversalUtils::urlEquals(fileUrl, url)) {
+                rootRemoved = event.second == kRmFile;
                 continue;
-            else if (event.second == kRmFile) {
-                dpfSlotChannel->push("dfmplugin_workspace", "slot_Tab_Close", fileUrl);
-                break;
             }
+
+            if (event.second == kAddFile)
+                addUrls.append(fileUrl);
+            else if (event.second == kUpdateFile)
+                updateUrls.append(fileUrl);
+            else
+                rmUrls.append(fileUrl);
+        }
+
+        if (rootRemoved) {
+            dpfSlotChannel->push(kTabCloseSlot, url);
+            break;
         }
 
         if (cancelWatcherEvent)
             return;
 
-        if (event.second == kAddFile) {
-            addChildren({ fileUrl });
-        } else if (event.second == kUpdateFile) {
-            updateChild(fileUrl);
-        } else {
-            removeChildren({ fileUrl });
-            dpfSlotChannel->push("dfmplugin_workspace", "slot_Tab_Close", fileUrl);
+        if (!rmUrls.isEmpty()) {
+            removeChildren(rmUrls);
+            for (const QUrl &fileUrl : rmUrls)
+                dpfSlotChannel->push(kTabCloseSlot, fileUrl);
         }
+
+        if (!addUrls.isEmpty())
+            addChildren(addUrls);
+
+        if (!updateUrls.isEmpty())
+            updateChildren(updateUrls);
     }
 
     Q_EMIT childrenUpdate(url);
@@ -261,11 +284,17 @@ void RootInfo::doThreadWatcherEvent()
     });
 }
 
-void RootInfo::handleTraversalResult(const AbstractFileInfoPointer &child)
+void RootInfo::handleTraversalResults(QList<AbstractFileInfoPointer> children)
 {
-    auto sortInfo = addChild(child);
-    if (sortInfo)
-        Q_EMIT iteratorAddFile(currentKey, sortInfo);
+    QList<SortInfoPointer> sortInfos;
+    for (const auto &child : children) {
+        auto sortInfo = addChild(child);
+        if (sortInfo)
+            sortInfos.append(sortInfo);
+    }
+
+    if (!sortInfos.isEmpty())
+        Q_EMIT iteratorAddFiles(currentKey, sortInfos);
 }
 
 void RootInfo::handleTraversalLocalResult(QList<SortInfoPointer> children,
@@ -289,14 +318,18 @@ void RootInfo::handleTraversalFinish()
 
 void RootInfo::handleGetSourceData(const QString &key)
 {
-    QList<SortInfoPointer> newDatas = sourceDataList;
+    QList<SortInfoPointer> newDatas;
+    {
+        QReadLocker lk(&childrenLock);
+        newDatas = childrenTable.sortInfos();
+    }
     emit sourceDatas(key, newDatas, originSortRole, originSortOrder, originMixSort, traversalFinish);
 }
 
 void RootInfo::initConnection(const TraversalThreadManagerPointer &traversalThread)
 {
-    connect(traversalThread.data(), &TraversalDirThreadManager::updateChildManager,
-            this, &RootInfo::handleTraversalResult, Qt::DirectConnection);
+    connect(traversalThread.data(), &TraversalDirThreadManager::updateChildrenManager,
+            this, &RootInfo::handleTraversalResults, Qt::DirectConnection);
     connect(traversalThread.data(), &TraversalDirThreadManager::updateLocalChildren,
             this, &RootInfo::handleTraversalLocalResult, Qt::DirectConnection);
     // 主线中执行
@@ -336,14 +369,9 @@ void RootInfo::addChildren(const QList<AbstractFileInfoPointer> &children)
 
 void RootInfo::addChildren(const QList<SortInfoPointer> &children)
 {
-    for (auto &file : children) {
-        if (!file)
-            continue;
-
-        QWriteLocker lk(&childrenLock);
-        childrenUrlList.append(file->url);
-        sourceDataList.append(file);
-    }
+    QWriteLocker lk(&childrenLock);
+    for (auto &file : children)
+        childrenTable.insert(file);
 }
 
 SortInfoPointer RootInfo::addChild(const AbstractFileInfoPointer &child)
@@ -357,17 +385,10 @@ SortInfoPointer RootInfo::addChild(const AbstractFileInfoPointer &child)
     SortInfoPointer sort = sortFileInfo(child);
     if (!sort)
         return nullptr;
+    sort->url = childUrl;
 
-    {
-        QWriteLocker lk(&childrenLock);
-        if (childrenUrlList.contains(childUrl)) {
-            sourceDataList.replace(childrenUrlList.indexOf(childUrl), sort);
-            return sort;
-        }
-        childrenUrlList.append(childUrl);
-        sourceDataList.append(sort);
-    }
-
+    QWriteLocker lk(&childrenLock);
+    childrenTable.insert(sort);
     return sort;
 }
 
@@ -390,7 +411,6 @@ SortInfoPointer RootInfo::sortFileInfo(const AbstractFileInfoPointer &info)
 void RootInfo::removeChildren(const QList<QUrl> &urlList)
 {
     QList<SortInfoPointer> removeChildren {};
-    int childIndex = -1;
     for (QUrl url : urlList) {
         url.setPath(url.path());
         auto child = fileInfo(url);
@@ -399,13 +419,8 @@ void RootInfo::removeChildren(const QList<QUrl> &urlList)
 
         auto realUrl = child->urlOf(UrlInfoType::kUrl);
         QWriteLocker lk(&childrenLock);
-        childIndex = childrenUrlList.indexOf(realUrl);
-        if (childIndex < 0 || childIndex >= childrenUrlList.length()) {
-            removeChildren.append(sortFileInfo(child));
-            continue;
-        }
-        childrenUrlList.removeAt(childIndex);
-        removeChildren.append(sourceDataList.takeAt(childIndex));
+        auto sort = childrenTable.take(realUrl);
+        removeChildren.append(sort ? sort : sortFileInfo(child));
     }
 
     if (removeChildren.count() > 0)
@@ -415,10 +430,23 @@ void RootInfo::removeChildren(const QList<QUrl> &urlList)
 bool RootInfo::containsChild(const QUrl &url)
 {
     QReadLocker lk(&childrenLock);
-    return childrenUrlList.contains(url);
+    return childrenTable.contains(url);
 }
 
-void RootInfo::updateChild(const QUrl &url)
+void RootInfo::updateChildren(const QList<QUrl> &urlList)
+{
+    QList<SortInfoPointer> updateChildren {};
+    for (const QUrl &url : urlList) {
+        auto sort = updateChild(url);
+        if (sort)
+            updateChildren.append(sort);
+    }
+
+    if (updateChildren.count() > 0)
+        emit watcherUpdateFiles(updateChildren);
+}
+
+SortInfoPointer RootInfo::updateChild(const QUrl &url)
 {
     SortInfoPointer sort { nullptr };
     auto tmpUrl(url);
@@ -426,26 +454,26 @@ void RootInfo::updateChild(const QUrl &url)
     {
         auto info = fileInfo(url);
         if (info.isNull())
-            return;
+            return nullptr;
 
         auto realUrl = info->urlOf(UrlInfoType::kUrl);
 
         QWriteLocker lk(&childrenLock);
-        if (!childrenUrlList.contains(realUrl))
-            return;
+        if (!childrenTable.contains(realUrl))
+            return nullptr;
         sort = sortFileInfo(info);
         if (sort.isNull())
-            return;
-        sourceDataList.replace(childrenUrlList.indexOf(tmpUrl), sort);
+            return nullptr;
+        sort->url = tmpUrl;
+        childrenTable.insert(sort);
     }
 
-    if (sort)
-        emit watcherUpdateFile(sort);
-
     // NOTE: GlobalEventType::kHideFiles event is watched in fileview, but this can be used to notify update view
     // when the file is modified in other way.
     if (UniversalUtils::urlEquals(hiddenFileUrl, url))
         Q_EMIT watcherUpdateHideFile(url);
+
+    return sort;
 }
 
 bool RootInfo::checkFileEventQueue()
@@ -466,6 +494,61 @@ QPair<QUrl, RootInfo::EventType> RootInfo::dequeueEvent()
     return watcherEvent.dequeue();
 }
 
+void RootInfo::scheduleWatcherEvent()
+{
+    // do not restart the timer, the events keep coming when many files are changed
+    if (!watcherEventTimer->isActive())
+        watcherEventTimer->start();
+}
+
+/*!
+ * \brief RootInfo::coalesceEvents Collapse the events of every url into one,
+ * a file created and deleted in the window (temp files of compilers, git and so on) is dropped,
+ * repeated updates become one, and an update never overrides an add or a remove.
+ * A child the model already has that is removed and created again (saved by unlink and create,
+ * git checkout, renamed over) becomes an update, the sort worker skips adds of existing rows.
+ * \param events the events of the window in order
+ * \return one event for every url, in the order the urls first appear
+ */
+QList<QPair<QUrl, RootInfo::EventType>> RootInfo::coalesceEvents(const QQueue<QPair<QUrl, EventType>> &events)
+{
+    QList<QPair<QUrl, EventType>> survivors;
+    QList<bool> addedInWindow;
+    QHash<QUrl, int> indexes;
+    for (auto event : events) {
+        if (!event.first.isValid())
+            continue;
+
+        event.first.setPath(event.first.path());
+        auto iter = indexes.constFind(event.first);
+        if (iter == indexes.constEnd()) {
+            indexes.insert(event.first, survivors.count());
+            survivors.append(event);
+            addedInWindow.append(event.second == kAddFile);
+            continue;
+        }
+
+        // add and remove override the earlier events, an update keeps them
+        if (event.second != kUpdateFile)
+            survivors[iter.value()].second = event.second;
+    }
+
+    QList<QPair<QUrl, EventType>> results;
+    for (int i = 0; i < survivors.count(); ++i) {
+        // created and deleted in the window, the model has never seen it
+        if (survivors.at(i).second == kRmFile && addedInWindow.at(i) && !containsChild(survivors.at(i).first))
+            continue;
+        // replaced in the window, the row has to be refreshed in place
+        if (survivors.at(i).second == kAddFile && containsChild(survivors.at(i).first)) {
+            results.append(qMakePair(survivors.at(i).first, kUpdateFile));
+            continue;
+        }
+        results.append(survivors.at(i));
+    }
+
+    return results;
+}
+
 // When monitoring the mtp directory, the monitor monitors that the scheme of the
 // url used for adding and deleting files is mtp (mtp://path).
 // Here, the monitor's url is used to re-complete the current url
@@ -7,6 +7,7 @@
 
 #include "dfmplugin_workspace_global.h"
 #include "utils/traversaldirthreadmanager.h"
+#include "utils/fileentrytable.h"
 
 #include "dfm-base/dfm_base_global.h"
 #include "dfm-base/utils/traversaldirthread.h"
@@ -16,6 +17,10 @@
 #include <QQueue>
 #include <QFuture>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace dfmplugin_workspace {
 
 class FileItemData;
@@ -59,7 +64,7 @@ Q_SIGNALS:
                             const dfmio::DEnumerator::SortRoleCompareFlag sortRole,
                             const Qt::SortOrder sortOrder,
                             const bool isMixDirAndFile);
-    void iteratorAddFile(const QString &key, const SortInfoPointer sortInfo);
+    void iteratorAddFiles(const QString &key, QList<SortInfoPointer> sortInfos);
     void watcherAddFiles(QList<SortInfoPointer> children);
     void watcherRemoveFiles(QList<SortInfoPointer> children);
     void traversalFinished(const QString &key);
@@ -69,7 +74,7 @@ Q_SIGNALS:
                      const Qt::SortOrder sortOrder,
                      const bool isMixDirAndFile,
                      const bool isFinished);
-    void watcherUpdateFile(const SortInfoPointer sortInfo);
+    void watcherUpdateFiles(QList<SortInfoPointer> children);
     void watcherUpdateHideFile(const QUrl &hidUrl);
 
 public Q_SLOTS:
@@ -80,7 +85,7 @@ public Q_SLOTS:
     void doWatcherEvent();
     void doThreadWatcherEvent();
 
-    void handleTraversalResult(const AbstractFileInfoPointer &child);
+    void handleTraversalResults(QList<AbstractFileInfoPointer> children);
     void handleTraversalLocalResult(QList<SortInfoPointer> children,
                                     dfmio::DEnumerator::SortRoleCompareFlag sortRole,
                                     Qt::SortOrder sortOrder,
@@ -98,12 +103,15 @@ private:
     SortInfoPointer sortFileInfo(const AbstractFileInfoPointer &info);
     void removeChildren(const QList<QUrl> &urlList);
     bool containsChild(const QUrl &url);
-    void updateChild(const QUrl &url);
+    void updateChildren(const QList<QUrl> &urlList);
+    SortInfoPointer updateChild(const QUrl &url);
 
     void startWatcher();
     bool checkFileEventQueue();
     void enqueueEvent(const QPair<QUrl, EventType> &e);
     QPair<QUrl, EventType> dequeueEvent();
+    void scheduleWatcherEvent();
+    QList<QPair<QUrl, EventType>> coalesceEvents(const QQueue<QPair<QUrl, EventType>> &events);
     AbstractFileInfoPointer fileInfo(const QUrl &url);
 
 public:
@@ -118,8 +126,7 @@ private:
     std::atomic_bool traversalFinish { false };
 
     QReadWriteLock childrenLock;
-    QList<QUrl> childrenUrlList {};
-    QList<SortInfoPointer> sourceDataList {};
+    FileEntryTable childrenTable;
     // origin data sort information
     dfmio::DEnumerator::SortRoleCompareFlag originSortRole { dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault };
     Qt::SortOrder originSortOrder { Qt::AscendingOrder };
@@ -131,6 +138,7 @@ private:
 
     QQueue<QPair<QUrl, EventType>> watcherEvent {};
     QMutex watcherEventMutex;
+    QTimer *watcherEventTimer { nullptr };
     QAtomicInteger<bool> processFileEventRuning = false;
 
     QList<TraversalThreadPointer> discardedThread {};
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fileentrytable.h"
+
+using namespace dfmbase;
+using namespace dfmplugin_workspace;
+
+static constexpr int kMinCompactCount { 1024 };
+
+FileEntryTable::FileEntryTable(const QUrl &dirUrl)
+    : prefix(dirUrl.toEncoded())
+{
+    if (!prefix.endsWith('/'))
+        prefix.append('/');
+}
+
+int FileEntryTable::count() const
+{
+    return offsets.count() - removedCount;
+}
+
+bool FileEntryTable::contains(const QUrl &url) const
+{
+    return find(entryKey(url)) >= 0;
+}
+
+/*!
+ * \brief FileEntryTable::insert Append the file, or replace the flags if it is in the table
+ */
+void FileEntryTable::insert(const SortInfoPointer &info)
+{
+    if (!info)
+        return;
+
+    const QByteArray &key = entryKey(info->url);
+    const int row = find(key);
+    if (row >= 0) {
+        flags[row] = flagsOf(info);
+        return;
+    }
+
+    rows.insert(qHash(key), offsets.count());
+    offsets.append(static_cast<quint32>(arena.size()));
+    flags.append(flagsOf(info));
+    arena.append(key);
+}
+
+SortInfoPointer FileEntryTable::take(const QUrl &url)
+{
+    const QByteArray &key = entryKey(url);
+    const int row = find(key);
+    if (row < 0)
+        return nullptr;
+
+    SortInfoPointer info = sortInfoAt(row);
+    rows.remove(qHash(key), row);
+    flags[row] |= kIsRemoved;
+    ++removedCount;
+
+    if (removedCount >= kMinCompactCount && removedCount * 2 > offsets.count())
+        compact();
+
+    return info;
+}
+
+void FileEntryTable::clear()
+{
+    arena.clear();
+    offsets.clear();
+    flags.clear();
+    rows.clear();
+    removedCount = 0;
+}
+
+QList<SortInfoPointer> FileEntryTable::sortInfos() const
+{
+    QList<SortInfoPointer> infos;
+    infos.reserve(count());
+    for (int row = 0; row < offsets.count(); ++row) {
+        if (!(flags.at(row) & kIsRemoved))
+            infos.append(sortInfoAt(row));
+    }
+
+    return infos;
+}
+
+// the name of a child, or the whole url if it is not a child of the directory
+QByteArray FileEntryTable::entryKey(const QUrl &url) const
+{
+    const QByteArray &encoded = url.toEncoded();
+    if (encoded.size() > prefix.size() && encoded.startsWith(prefix) && encoded.indexOf('/', prefix.size()) < 0)
+        return encoded.mid(prefix.size());
+
+    return encoded;
+}
+
+QByteArray FileEntryTable::keyAt(const int row) const
+{
+    const quint32 begin = offsets.at(row);
+    const quint32 end = row + 1 < offsets.count() ? offsets.at(row + 1) : static_cast<quint32>(arena.size());
+    return QByteArray::fromRawData(arena.constData() + begin, static_cast<int>(end - begin));
+}
+
+int FileEntryTable::find(const QByteArray &key) const
+{
+    const uint hash = qHash(key);
+    for (auto it = rows.constFind(hash); it != rows.constEnd() && it.key() == hash; ++it) {
+        if (keyAt(it.value()) == key)
+            return it.value();
+    }
+
+    return -1;
+}
+
+SortInfoPointer FileEntryTable::sortInfoAt(const int row) const
+{
+    const QByteArray &key = keyAt(row);
+    // a name never has '/', the key of a url out of the directory always has
+    const QUrl &url = QUrl::fromEncoded(key.contains('/') ? key : prefix + key);
+    const quint8 flag = flags.at(row);
+    return SortInfoPointer(new AbstractDirIterator::SortFileInfo(url,
+                                                                 flag & kIsFile,
+                                                                 flag & kIsDir,
+                                                                 flag & kIsSymLink,
+                                                                 flag & kIsHide,
+                                                                 flag & kIsReadable,
+                                                                 flag & kIsWriteable,
+                                                                 flag & kIsExecutable));
+}
+
+quint8 FileEntryTable::flagsOf(const SortInfoPointer &info)
+{
+    quint8 flag = 0;
+    if (info->isFile)
+        flag |= kIsFile;
+    if (info->isDir)
+        flag |= kIsDir;
+    if (info->isSymLink)
+        flag |= kIsSymLink;
+    if (info->isHide)
+        flag |= kIsHide;
+    if (info->isReadable)
+        flag |= kIsReadable;
+    if (info->isWriteable)
+        flag |= kIsWriteable;
+    if (info->isExecutable)
+        flag |= kIsExecutable;
+    return flag;
+}
+
+void FileEntryTable::compact()
+{
+    QByteArray newArena;
+    newArena.reserve(arena.size());
+    QVector<quint32> newOffsets;
+    newOffsets.reserve(count());
+    QVector<quint8> newFlags;
+    newFlags.reserve(count());
+    QMultiHash<uint, int> newRows;
+    newRows.reserve(count());
+
+    for (int row = 0; row < offsets.count(); ++row) {
+        if (flags.at(row) & kIsRemoved)
+            continue;
+
+        const QByteArray &key = keyAt(row);
+        newRows.insert(qHash(key), newOffsets.count());
+        newOffsets.append(static_cast<quint32>(newArena.size()));
+        newFlags.append(flags.at(row));
+        newArena.append(key);
+    }
+
+    arena.swap(newArena);
+    offsets.swap(newOffsets);
+    flags.swap(newFlags);
+    rows.swap(newRows);
+    removedCount = 0;
+}
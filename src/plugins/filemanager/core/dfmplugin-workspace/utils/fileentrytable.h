@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILEENTRYTABLE_H
+#define FILEENTRYTABLE_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include "dfm-base/interfaces/abstractdiriterator.h"
+
+#include <QByteArray>
+#include <QMultiHash>
+#include <QVector>
+#include <QUrl>
+
+namespace dfmplugin_workspace {
+
+/*!
+ * \class FileEntryTable
+ * \brief The children of a directory kept in columns instead of a QUrl and a SortFileInfo per file.
+ * The encoded names are packed back to back in one arena, the flags of a file take one byte, and a row
+ * is found by the hash of its name. The rows keep the order they are inserted, removed rows are
+ * only marked and the table is compacted when half of the rows are removed.
+ * The table is not thread safe.
+ */
+class FileEntryTable
+{
+public:
+    explicit FileEntryTable(const QUrl &dirUrl);
+
+    int count() const;
+    bool contains(const QUrl &url) const;
+    void insert(const SortInfoPointer &info);
+    SortInfoPointer take(const QUrl &url);
+    void clear();
+    QList<SortInfoPointer> sortInfos() const;
+
+private:
+    enum EntryFlag : quint8 {
+        kIsFile = 0x01,
+        kIsDir = 0x02,
+        kIsSymLink = 0x04,
+        kIsHide = 0x08,
+        kIsReadable = 0x10,
+        kIsWriteable = 0x20,
+        kIsExecutable = 0x40,
+        kIsRemoved = 0x80,
+    };
+
+    QByteArray entryKey(const QUrl &url) const;
+    QByteArray keyAt(const int row) const;
+    int find(const QByteArray &key) const;
+    SortInfoPointer sortInfoAt(const int row) const;
+    static quint8 flagsOf(const SortInfoPointer &info);
+    void compact();
+
+private:
+    QByteArray prefix;   // encoded url of the directory ending with '/'
+    QByteArray arena;   // keys of all the rows
+    QVector<quint32> offsets;   // start of the key in arena, it ends at the start of the next row
+    QVector<quint8> flags;
+    QMultiHash<uint, int> rows;   // hash of the key -> row
+    int removedCount { 0 };
+};
+
+}
+
+#endif   // FILEENTRYTABLE_H
@@ -11,11 +11,22 @@
 #include <dfm-io/dfmio_utils.h>
 
 #include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
 
 using namespace dfmplugin_workspace;
 using namespace dfmbase::Global;
 using namespace dfmio;
 
+namespace {
+// a thread sorts one chunk at least this large
+constexpr int kMinParallelSortCount { 4096 };
+// more inserted ranges than this are notified as one insertion of all rows
+constexpr int kMaxInsertRangeCount { 64 };
+}   // namespace
+
 FileSortWorker::FileSortWorker(const QUrl &url, const QString &key, FileViewFilterCallback callfun, const QStringList &nameFilters, const QDir::Filters filters, const QDirIterator::IteratorFlags flags, QObject *parent)
     : QObject(parent), current(url), nameFilters(nameFilters), filters(filters), flags(flags), filterCallback(callfun), currentKey(key)
 {
@@ -35,6 +46,7 @@ FileSortWorker::~FileSortWorker()
     childrenUrlList.clear();
     visibleChildren.clear();
     children.clear();
+    sortKeys.clear();
 }
 
 FileSortWorker::SortOpt FileSortWorker::setSortAgruments(const Qt::SortOrder order, const Global::ItemRoles sortRole, const bool isMixDirAndFile)
@@ -195,7 +207,7 @@ void FileSortWorker::handleSourceChildren(const QString &key,
     // 获取相对于已有的新增加的文件
     QList<QUrl> newChildren;
     for (const auto &sortInfo : children) {
-        if (this->childrenUrlList.contains(sortInfo->url))
+        if (childrenDataMap.contains(sortInfo->url))
             continue;
         this->children.append(sortInfo);
         this->childrenUrlList.append(sortInfo->url);
@@ -225,28 +237,16 @@ void FileSortWorker::handleSourceChildren(const QString &key,
         }
         return;
     }
-    bool onebyone = !visibleChildren.isEmpty();
-    // 排序
-    if (!onebyone)
-        Q_EMIT insertRows(0, newChildren.length());
-    for (const auto &url : newChildren) {
-        int showIndex = insertSortList(url, visibleChildren,
-                                       AbstractSortAndFiter::SortScenarios::kSortScenariosIteratorExistingFile);
+    // 排序后一次合并到显示列表中
+    if (!newChildren.isEmpty()) {
+        sortUrls(newChildren, AbstractSortAndFiter::SortScenarios::kSortScenariosIteratorExistingFile);
+        if (isCanceled)
+            return;
+        mergeSortedUrls(newChildren, AbstractSortAndFiter::SortScenarios::kSortScenariosIteratorExistingFile);
         if (isCanceled)
             return;
-        if (onebyone)
-            Q_EMIT insertRows(showIndex, 1);
-        {
-            QWriteLocker lk(&locker);
-            visibleChildren.insert(showIndex, url);
-        }
-        if (onebyone)
-            Q_EMIT insertFinish();
     }
 
-    if (!onebyone)
-        Q_EMIT insertFinish();
-
     if (isFinished) {
         Q_EMIT requestSetIdel();
     } else {
@@ -254,16 +254,21 @@ void FileSortWorker::handleSourceChildren(const QString &key,
     }
 }
 
-void FileSortWorker::handleIteratorChild(const QString &key, const SortInfoPointer child)
+void FileSortWorker::handleIteratorChildren(const QString &key, QList<SortInfoPointer> children)
 {
     if (isCanceled)
         return;
     if (currentKey != key)
         return;
-    if (!child)
-        return;
 
-    addChild(child, AbstractSortAndFiter::SortScenarios::kSortScenariosIteratorAddFile);
+    // the batches iterated in a burst are inserted together
+    const bool needFlush = pendingIteratorChildren.isEmpty();
+    for (const auto &child : children) {
+        if (child)
+            pendingIteratorChildren.append(child);
+    }
+    if (needFlush && !pendingIteratorChildren.isEmpty())
+        QMetaObject::invokeMethod(this, &FileSortWorker::flushIteratorChildren, Qt::QueuedConnection);
 }
 
 void FileSortWorker::handleModelGetSourceData()
@@ -290,6 +295,8 @@ void FileSortWorker::resetFilters(const QStringList &nameFilters, const QDir::Fi
     if (this->nameFilters == nameFilters && this->filters == filters)
         return;
 
+    flushIteratorChildren();
+
     this->nameFilters = nameFilters;
     this->filters = filters;
 
@@ -328,22 +335,18 @@ void FileSortWorker::onAppAttributeChanged(Application::ApplicationAttribute aa,
 
 void FileSortWorker::handleWatcherAddChildren(QList<SortInfoPointer> children)
 {
-    for (const auto &sortInfo : children) {
-        if (isCanceled)
-            return;
-        if (this->childrenUrlList.contains(sortInfo->url))
-            continue;
-        addChild(sortInfo, AbstractSortAndFiter::SortScenarios::kSortScenariosWatcherAddFile);
-    }
+    flushIteratorChildren();
+    addChildren(children, AbstractSortAndFiter::SortScenarios::kSortScenariosWatcherAddFile);
 }
 
 void FileSortWorker::handleWatcherRemoveChildren(QList<SortInfoPointer> children)
 {
+    flushIteratorChildren();
     for (const auto &sortInfo : children) {
         if (isCanceled)
             return;
 
-        if (!sortInfo || !childrenUrlList.contains(sortInfo->url))
+        if (!sortInfo || !childrenDataMap.contains(sortInfo->url))
             continue;
 
         auto index = childrenUrlList.indexOf(sortInfo->url);
@@ -352,6 +355,7 @@ void FileSortWorker::handleWatcherRemoveChildren(QList<SortInfoPointer> children
             childrenDataMap.remove(childrenUrlList.takeAt(index));
         }
         this->children.removeAt(index);
+        sortKeys.remove(sortInfo->url);
 
         int showIndex = -1;
         {
@@ -377,6 +381,7 @@ void FileSortWorker::resort(const Qt::SortOrder order, const ItemRoles sortRole,
     if (isCanceled)
         return;
 
+    flushIteratorChildren();
     auto opt = setSortAgruments(order, sortRole, isMixDirAndFile);
     switch (opt) {
     case FileSortWorker::SortOpt::kSortOptOtherChanged:
@@ -392,18 +397,21 @@ void FileSortWorker::handleTraversalFinish(const QString &key)
 {
     if (currentKey != key)
         return;
+    flushIteratorChildren();
     Q_EMIT requestSetIdel();
 }
 
-void FileSortWorker::handleWatcherUpdateFile(const SortInfoPointer child)
+void FileSortWorker::handleWatcherUpdateFiles(QList<SortInfoPointer> children)
 {
-    if (isCanceled)
-        return;
+    for (const auto &child : children) {
+        if (isCanceled)
+            return;
 
-    if (!child)
-        return;
+        if (!child)
+            continue;
 
-    handleUpdateFile(child->url);
+        handleUpdateFile(child->url);
+    }
 }
 
 void FileSortWorker::handleWatcherUpdateHideFile(const QUrl &hidUrl)
@@ -436,7 +444,8 @@ void FileSortWorker::handleUpdateFile(const QUrl &url)
     if (isCanceled)
         return;
 
-    if (!url.isValid() || !childrenUrlList.contains(url))
+    flushIteratorChildren();
+    if (!url.isValid() || !childrenDataMap.contains(url))
         return;
 
     const auto &info = InfoFactory::create<AbstractFileInfo>(url);
@@ -454,6 +463,7 @@ void FileSortWorker::handleUpdateFile(const QUrl &url)
     sortInfo->isExecutable = info->isAttributes(OptInfoType::kIsExecutable);
     info->fileMimeType();
     children.replace(childrenUrlList.indexOf(url), sortInfo);
+    sortKeys.remove(url);
 
     QReadLocker lk(&locker);
     if (!visibleChildren.contains(url))
@@ -488,6 +498,7 @@ void FileSortWorker::handleFilterCallFunc(FileViewFilterCallback callback)
 
 void FileSortWorker::handleClean()
 {
+    pendingIteratorChildren.clear();
     bool empty { false };
     {
         QReadLocker lk(&locker);
@@ -502,6 +513,7 @@ void FileSortWorker::handleClean()
         visibleChildren.clear();
         children.clear();
     }
+    sortKeys.clear();
 
     {
         QWriteLocker lk(&childrenDataLocker);
@@ -672,12 +684,11 @@ void FileSortWorker::sortAllFiles()
     if (orgSortRole == Global::ItemRoles::kItemDisplayRole)
         return;
 
-    QList<QUrl> sortList;
-    for (const auto &url : visibleChildren) {
-        if (isCanceled)
-            return;
-        sortList.insert(insertSortList(url, sortList, AbstractSortAndFiter::SortScenarios::kSortScenariosNormal), url);
-    }
+    QList<QUrl> sortList = visibleChildren;
+    sortUrls(sortList, AbstractSortAndFiter::SortScenarios::kSortScenariosNormal);
+    if (isCanceled)
+        return;
+
     Q_EMIT insertRows(0, sortList.length());
     {
         QWriteLocker lk(&locker);
@@ -710,10 +721,10 @@ void FileSortWorker::sortOnlyOrderChange()
 
     QList<QUrl> dirList, fileList;
     for (const auto &url : visibleChildren) {
-        const auto &info = InfoFactory::create<AbstractFileInfo>(url);
-        if (!info)
+        const auto &key = sortKey(url);
+        if (!key)
             continue;
-        if (info->isAttributes(OptInfoType::kIsDir)) {
+        if (key->isDir) {
             dirList.push_front(url);
         } else {
             fileList.push_front(url);
@@ -729,104 +740,269 @@ void FileSortWorker::sortOnlyOrderChange()
     return;
 }
 
-void FileSortWorker::addChild(const SortInfoPointer &sortInfo,
-                              const AbstractSortAndFiter::SortScenarios sort)
+/*!
+ * \brief FileSortWorker::addChildren Add the children in batch, the shown ones are sorted
+ * together and merged into the shown list in one pass
+ */
+void FileSortWorker::addChildren(const QList<SortInfoPointer> &sortInfos,
+                                 const AbstractSortAndFiter::SortScenarios sort)
 {
-    if (isCanceled)
-        return;
+    QList<QUrl> newUrls;
+    for (const auto &sortInfo : sortInfos) {
+        if (isCanceled)
+            return;
 
-    if (!sortInfo)
-        return;
+        // the data map is only written in this thread, its keys are looked up without the lock
+        if (!sortInfo || childrenDataMap.contains(sortInfo->url))
+            continue;
 
-    if (childrenUrlList.contains(sortInfo->url))
-        return;
+        children.append(sortInfo);
+        childrenUrlList.append(sortInfo->url);
+        {
+            QWriteLocker lk(&childrenDataLocker);
+            childrenDataMap.insert(sortInfo->url, new FileItemData(sortInfo, rootdata));
+        }
 
-    children.append(sortInfo);
-    childrenUrlList.append(sortInfo->url);
-    {
-        QWriteLocker lk(&childrenDataLocker);
-        childrenDataMap.insert(sortInfo->url, new FileItemData(sortInfo, rootdata));
+        if (checkFilters(sortInfo, true))
+            newUrls.append(sortInfo->url);
     }
 
-    if (!checkFilters(sortInfo, true))
-        return;
-
-    if (isCanceled)
+    if (newUrls.isEmpty() || isCanceled)
         return;
 
-    int showIndex = visibleChildren.length();
     // kItemDisplayRole 是不进行排序的
-    if (orgSortRole != Global::ItemRoles::kItemDisplayRole)
-        showIndex = insertSortList(sortInfo->url, visibleChildren, sort);
+    if (orgSortRole == Global::ItemRoles::kItemDisplayRole) {
+        Q_EMIT insertRows(visibleChildren.length(), newUrls.length());
+        {
+            QWriteLocker lk(&locker);
+            visibleChildren.append(newUrls);
+        }
+        Q_EMIT insertFinish();
+    } else {
+        sortUrls(newUrls, sort);
+        if (isCanceled)
+            return;
+        mergeSortedUrls(newUrls, sort);
+        if (isCanceled)
+            return;
+    }
 
-    if (isCanceled)
+    if (sort == AbstractSortAndFiter::SortScenarios::kSortScenariosWatcherAddFile) {
+        for (const auto &url : newUrls)
+            Q_EMIT selectAndEditFile(url);
+    }
+}
+
+/*!
+ * \brief FileSortWorker::mergeSortedUrls Merge the sorted urls into the shown list,
+ * the inserted rows next to each other are notified as one range
+ */
+void FileSortWorker::mergeSortedUrls(const QList<QUrl> &sortedUrls, const AbstractSortAndFiter::SortScenarios sort)
+{
+    const bool ascending = sortOrder == Qt::AscendingOrder;
+    QList<QUrl> mergedUrls;
+    mergedUrls.reserve(visibleChildren.length() + sortedUrls.length());
+    QList<QPair<int, int>> insertRanges;   // first row and count
+
+    int visibleIndex = 0;
+    int newIndex = 0;
+    while (visibleIndex < visibleChildren.length() || newIndex < sortedUrls.length()) {
+        if (isCanceled)
+            return;
+
+        bool takeNew = false;
+        if (newIndex >= sortedUrls.length()) {
+            takeNew = false;
+        } else if (visibleIndex >= visibleChildren.length()) {
+            takeNew = true;
+        } else {
+            const QUrl &newUrl = sortedUrls.at(newIndex);
+            const QUrl &visibleUrl = visibleChildren.at(visibleIndex);
+            takeNew = ascending ? lessThan(newUrl, visibleUrl, sort) : lessThan(visibleUrl, newUrl, sort);
+        }
+
+        if (!takeNew) {
+            mergedUrls.append(visibleChildren.at(visibleIndex++));
+            continue;
+        }
+
+        if (!insertRanges.isEmpty() && insertRanges.last().first + insertRanges.last().second == mergedUrls.length())
+            ++insertRanges.last().second;
+        else
+            insertRanges.append({ mergedUrls.length(), 1 });
+        mergedUrls.append(sortedUrls.at(newIndex++));
+    }
+
+    if (insertRanges.length() > kMaxInsertRangeCount) {
+        Q_EMIT insertRows(0, mergedUrls.length());
+        {
+            QWriteLocker lk(&locker);
+            visibleChildren = mergedUrls;
+        }
+        Q_EMIT insertFinish();
         return;
+    }
 
-    Q_EMIT insertRows(showIndex, 1);
+    // the ranges are in ascending order, every first row is valid after the previous ranges inserted
     {
         QWriteLocker lk(&locker);
-        visibleChildren.insert(showIndex, sortInfo->url);
+        visibleChildren = mergedUrls;
     }
-    Q_EMIT insertFinish();
+    for (const auto &range : insertRanges) {
+        Q_EMIT insertRows(range.first, range.second);
+        Q_EMIT insertFinish();
+    }
+}
+
+void FileSortWorker::flushIteratorChildren()
+{
+    if (pendingIteratorChildren.isEmpty())
+        return;
 
-    if (sort == AbstractSortAndFiter::SortScenarios::kSortScenariosWatcherAddFile)
-        Q_EMIT selectAndEditFile(sortInfo->url);
+    const QList<SortInfoPointer> pendingChildren = pendingIteratorChildren;
+    pendingIteratorChildren.clear();
+    addChildren(pendingChildren, AbstractSortAndFiter::SortScenarios::kSortScenariosIteratorAddFile);
 }
+
+/*!
+ * \brief FileSortWorker::sortKey Get the values of the file compared by sorting,
+ * the file info is only looked up when the key is built or the sort role changed
+ */
+FileSortWorker::SortKeyPointer FileSortWorker::sortKey(const QUrl &url)
+{
+    SortKeyPointer key = sortKeys.value(url);
+    if (key && key->role == orgSortRole)
+        return key;
+
+    const AbstractFileInfoPointer &info = InfoFactory::create<AbstractFileInfo>(url);
+    if (!info)
+        return nullptr;
+
+    key.reset(new SortKey);
+    if (sortAndFilter)
+        key->info = info;
+    key->role = orgSortRole;
+    key->isDir = info->isAttributes(OptInfoType::kIsDir);
+    key->displayName = info->displayOf(DisPlayInfoType::kFileDisplayName);
+
+    const QVariant &customValue = info->customData(orgSortRole);
+    if (customValue.isValid()) {
+        key->text = customValue.toString();
+    } else if (orgSortRole == kItemFileLastModifiedRole) {
+        // the time is displayed in seconds, files modified in same second are sorted by name
+        const QDateTime &lastModified = info->timeOf(TimeInfoType::kLastModified).value<QDateTime>();
+        key->isNumber = true;
+        key->number = lastModified.isValid() ? lastModified.toSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    } else if (orgSortRole == kItemFileSizeRole) {
+        key->isNumber = true;
+        key->number = info->size();
+    } else {
+        key->text = data(info, orgSortRole).toString();
+    }
+
+    sortKeys.insert(url, key);
+    return key;
+}
+
 // 左边比右边小返回true，
 bool FileSortWorker::lessThan(const QUrl &left, const QUrl &right, AbstractSortAndFiter::SortScenarios sort)
 {
     if (isCanceled)
         return false;
 
-    const AbstractFileInfoPointer &leftInfo = InfoFactory::create<AbstractFileInfo>(left);
-    const AbstractFileInfoPointer &rightInfo = InfoFactory::create<AbstractFileInfo>(right);
+    const SortKeyPointer &leftKey = sortKey(left);
+    const SortKeyPointer &rightKey = sortKey(right);
 
-    if (!leftInfo)
+    if (!leftKey)
         return false;
-    if (!rightInfo)
+    if (!rightKey)
         return false;
 
+    return lessThan(*leftKey, *rightKey, sort);
+}
+
+bool FileSortWorker::lessThan(const SortKey &left, const SortKey &right, AbstractSortAndFiter::SortScenarios sort)
+{
     if (sortAndFilter) {
-        auto result = sortAndFilter->lessThan(leftInfo, rightInfo, isMixDirAndFile,
+        auto result = sortAndFilter->lessThan(left.info, right.info, isMixDirAndFile,
                                               orgSortRole, sort);
         if (result > 0)
             return result;
     }
 
-    bool isDirLeft = leftInfo->isAttributes(OptInfoType::kIsDir);
-    bool isDirRight = rightInfo->isAttributes(OptInfoType::kIsDir);
-
     // The folder is fixed in the front position
     if (!isMixDirAndFile)
-        if (isDirLeft ^ isDirRight)
-            return (sortOrder == Qt::DescendingOrder) ^ isDirLeft;
+        if (left.isDir ^ right.isDir)
+            return (sortOrder == Qt::DescendingOrder) ^ left.isDir;
 
-    if (isCanceled)
-        return false;
+    // When the selected sort attribute value is the same, sort by file name
+    const bool isSame = left.isNumber ? left.number == right.number : left.text == right.text;
+    if (isSame)
+        return FileUtils::compareByStringEx(left.displayName, right.displayName);
 
-    QVariant leftData = data(leftInfo, orgSortRole);
-    QVariant rightData = data(rightInfo, orgSortRole);
+    if (left.isNumber)
+        return left.number < right.number;
 
-    // When the selected sort attribute value is the same, sort by file name
-    if (leftData == rightData) {
-        QString leftName = leftInfo->displayOf(DisPlayInfoType::kFileDisplayName);
-        QString rightName = rightInfo->displayOf(DisPlayInfoType::kFileDisplayName);
-        return FileUtils::compareByStringEx(leftName, rightName);
-    }
+    return FileUtils::compareByStringEx(left.text, right.text);
+}
 
-    switch (orgSortRole) {
-    case kItemFileDisplayNameRole:
-    case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
-    case kItemFileSizeRole: {
-        qint64 sizel = leftInfo->size();
-        qint64 sizer = rightInfo->size();
-        return sizel < sizer;
+/*!
+ * \brief FileSortWorker::sortUrls Sort the urls by their sort keys, the chunks are sorted
+ * in parallel and merged. Files without info are put at the end.
+ */
+void FileSortWorker::sortUrls(QList<QUrl> &urls, AbstractSortAndFiter::SortScenarios sort)
+{
+    struct SortItem
+    {
+        const SortKey *key;
+        int index;
+    };
+
+    std::vector<SortItem> items;
+    items.reserve(static_cast<size_t>(urls.size()));
+    QList<QUrl> invalidUrls;
+    for (int i = 0; i < urls.size(); ++i) {
+        if (isCanceled)
+            return;
+        const SortKeyPointer &key = sortKey(urls.at(i));
+        if (key)
+            items.push_back({ key.data(), i });
+        else
+            invalidUrls.append(urls.at(i));
     }
-    default:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
+
+    const bool ascending = sortOrder == Qt::AscendingOrder;
+    auto compare = [this, ascending, sort](const SortItem &left, const SortItem &right) {
+        return ascending ? lessThan(*left.key, *right.key, sort) : lessThan(*right.key, *left.key, sort);
+    };
+
+    // the custom sort of scheme may be not thread safe
+    const int itemCount = static_cast<int>(items.size());
+    const int chunkCount = sortAndFilter ? 1 : qBound(1, itemCount / kMinParallelSortCount, QThread::idealThreadCount());
+    QVector<int> bounds;
+    for (int i = 0; i <= chunkCount; ++i)
+        bounds.append(static_cast<int>(static_cast<qint64>(itemCount) * i / chunkCount));
+
+    QVector<int> chunks;
+    for (int i = 0; i < chunkCount; ++i)
+        chunks.append(i);
+    QtConcurrent::blockingMap(chunks, [&items, &bounds, &compare](const int chunk) {
+        std::stable_sort(items.begin() + bounds.at(chunk), items.begin() + bounds.at(chunk + 1), compare);
+    });
+
+    for (int step = 1; step < chunkCount; step *= 2) {
+        for (int i = 0; i + step < chunkCount; i += step * 2) {
+            std::inplace_merge(items.begin() + bounds.at(i), items.begin() + bounds.at(i + step),
+                               items.begin() + bounds.at(qMin(i + step * 2, chunkCount)), compare);
+        }
     }
+
+    QList<QUrl> sortedUrls;
+    sortedUrls.reserve(urls.size());
+    for (const SortItem &item : items)
+        sortedUrls.append(urls.at(item.index));
+    sortedUrls.append(invalidUrls);
+    urls = sortedUrls;
 }
 
 QVariant FileSortWorker::data(const AbstractFileInfoPointer &info, ItemRoles role)
@@ -87,7 +87,7 @@ public slots:
                               const Qt::SortOrder sortOrder,
                               const bool isMixDirAndFile,
                               const bool isFinished);
-    void handleIteratorChild(const QString &key, const SortInfoPointer child);
+    void handleIteratorChildren(const QString &key, QList<SortInfoPointer> children);
     //Get data from the data area according to the url, filter and sort the data
     void handleModelGetSourceData();
     void setFilters(QDir::Filters filters);
@@ -102,7 +102,7 @@ public slots:
     void handleWatcherRemoveChildren(QList<SortInfoPointer> children);
     void resort(const Qt::SortOrder order, const Global::ItemRoles sortRole, const bool isMixDirAndFile);
     void handleTraversalFinish(const QString &key);
-    void handleWatcherUpdateFile(const SortInfoPointer child);
+    void handleWatcherUpdateFiles(QList<SortInfoPointer> children);
     void handleWatcherUpdateHideFile(const QUrl &hidUrl);
     void handleUpdateFile(const QUrl &url);
     void handleFilterData(const QVariant &data);
@@ -116,11 +116,29 @@ private:
     void sortAllFiles();
     // 有序的情况下只是点击升序还是降序特殊处理
     void sortOnlyOrderChange();
-    void addChild(const SortInfoPointer &sortInfo,
-                  const AbstractSortAndFiter::SortScenarios sort);
+    void addChildren(const QList<SortInfoPointer> &sortInfos,
+                     const AbstractSortAndFiter::SortScenarios sort);
+    void mergeSortedUrls(const QList<QUrl> &sortedUrls, const AbstractSortAndFiter::SortScenarios sort);
+    void flushIteratorChildren();
 
 private:
+    // The values compared by sorting, built once per file and sort role
+    struct SortKey
+    {
+        AbstractFileInfoPointer info { nullptr };   // only kept for the custom sort of scheme
+        Global::ItemRoles role { Global::ItemRoles::kItemDisplayRole };
+        QString displayName;   // compared when the values of sort role are same
+        QString text;   // value of sort role compared as string
+        qint64 number { 0 };   // value of sort role compared as number
+        bool isNumber { false };
+        bool isDir { false };
+    };
+    using SortKeyPointer = QSharedPointer<SortKey>;
+
+    SortKeyPointer sortKey(const QUrl &url);
     bool lessThan(const QUrl &left, const QUrl &right, AbstractSortAndFiter::SortScenarios sort);
+    bool lessThan(const SortKey &left, const SortKey &right, AbstractSortAndFiter::SortScenarios sort);
+    void sortUrls(QList<QUrl> &urls, AbstractSortAndFiter::SortScenarios sort);
     QVariant data(const AbstractFileInfoPointer &info, Global::ItemRoles role);
     int insertSortList(const QUrl &needNode, const QList<QUrl> &list,
                        AbstractSortAndFiter::SortScenarios sort);
@@ -133,8 +151,10 @@ private:
     QList<SortInfoPointer> children {};
     QList<QUrl> childrenUrlList {};
     QReadWriteLock childrenDataLocker;
-    QMap<QUrl, FileItemData *> childrenDataMap {};
+    QHash<QUrl, FileItemData *> childrenDataMap {};   // also the set of children urls
     QList<QUrl> visibleChildren {};
+    QHash<QUrl, SortKeyPointer> sortKeys {};   // only used in the sort thread
+    QList<SortInfoPointer> pendingIteratorChildren {};   // iterated children wait for being inserted in batch
     QReadWriteLock locker;
     AbstractSortAndFiterPointer sortAndFilter { nullptr };
     FileViewFilterCallback filterCallback { nullptr };
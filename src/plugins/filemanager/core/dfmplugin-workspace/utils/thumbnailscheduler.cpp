@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailscheduler.h"
+#include "views/fileview.h"
+#include "models/fileviewmodel.h"
+
+#include "dfm-base/utils/fileinfohelper.h"
+#include "dfm-base/utils/thumbnailprovider.h"
+
+#include <QDebug>
+
+DFMBASE_USE_NAMESPACE
+using namespace dfmplugin_workspace;
+
+ThumbnailScheduler::ThumbnailScheduler(FileView *parent)
+    : QObject(parent),
+      view(parent)
+{
+    connect(&FileInfoHelper::instance(), &FileInfoHelper::createThumbnailFinished, this, &ThumbnailScheduler::onThumbnailFinished);
+    connect(&FileInfoHelper::instance(), &FileInfoHelper::createThumbnailFailed, this, &ThumbnailScheduler::onThumbnailFailed);
+}
+
+/*!
+ * \brief ThumbnailScheduler::updateVisibleRange Called when the view stops scrolling.
+ * The visible rows have requested their thumbnails when painted, they are raised above the prefetched
+ * ones because the thumbnails run the last raised first.
+ */
+void ThumbnailScheduler::updateVisibleRange(int first, int last)
+{
+    if (first < 0 || last < first)
+        return;
+
+    const int rowCount = this->rowCount();
+    if (rowCount <= 0)
+        return;
+
+    const int length = last - first + 1;
+    const bool scrollUp = visibleFirst >= 0 && first < visibleFirst;
+    visibleFirst = first;
+    visibleLast = last;
+
+    for (auto it = ready.begin(); it != ready.end();) {
+        if (isVisible(it.value())) {
+            ++counts.shown;
+            it = ready.erase(it);
+        } else if (it.value() < first - length || it.value() > last + length) {
+            ++counts.wasted;
+            it = ready.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it.value() < first - length || it.value() > last + length) {
+            if (release(it.key()))
+                ++counts.canceled;
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QList<QUrl> urls;
+    // the next viewport in the scroll direction, the farthest first
+    const int prefetchFirst = scrollUp ? qMax(first - length, 0) : last + 1;
+    const int prefetchLast = scrollUp ? first - 1 : qMin(last + length, rowCount - 1);
+    for (int i = 0; i <= prefetchLast - prefetchFirst; ++i) {
+        const int row = scrollUp ? prefetchFirst + i : prefetchLast - i;
+        const QUrl &url = prefetchUrlOfRow(row);
+        if (!url.isValid() || ready.contains(url))
+            continue;
+
+        // only the request, the icon is built when the row is painted
+        if (!pending.contains(url))
+            FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge);
+        hold(url, row);
+        urls.append(url);
+    }
+
+    // the top row last, so it runs first
+    for (int row = last; row >= first; --row) {
+        const QUrl &url = urlOfRow(row);
+        if (!url.isValid() || ready.contains(url))
+            continue;
+
+        hold(url, row);
+        urls.append(url);
+    }
+
+    FileInfoHelper::instance().raiseThumbAsync(urls);
+}
+
+/*!
+ * \brief ThumbnailScheduler::leaveRows Called with the rows which left the view before updateVisibleRange.
+ * The rows painted while scrolling requested their thumbnails without the scheduler knowing,
+ * their requests are held here so that the far ones are dropped with the others.
+ */
+void ThumbnailScheduler::leaveRows(int first, int last)
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount() - 1);
+    for (int row = first; row <= last; ++row) {
+        const QUrl &url = urlOfRow(row);
+        if (!url.isValid() || pending.contains(url) || ready.contains(url))
+            continue;
+
+        // not requested, or already started
+        if (!hold(url, row))
+            pending.remove(url);
+    }
+}
+
+/*!
+ * \brief ThumbnailScheduler::reset Log the metrics of the directory and forget its rows,
+ * called before the view changes its root.
+ */
+void ThumbnailScheduler::reset()
+{
+    counts.wasted += ready.size();
+    if (counts.shown > 0 || counts.wasted > 0 || counts.canceled > 0)
+        qInfo() << "thumbnails of" << view->rootUrl() << "shown:" << counts.shown
+                << "wasted:" << counts.wasted << "canceled:" << counts.canceled;
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+        release(it.key());
+
+    pending.clear();
+    held.clear();
+    ready.clear();
+    counts = Metrics();
+    visibleFirst = visibleLast = -1;
+}
+
+ThumbnailScheduler::Metrics ThumbnailScheduler::metrics() const
+{
+    return counts;
+}
+
+void ThumbnailScheduler::onThumbnailFinished(const QUrl &url)
+{
+    auto it = pending.find(url);
+    if (it == pending.end())
+        return;
+
+    const int row = it.value();
+    pending.erase(it);
+    held.remove(url);
+    if (isVisible(row))
+        ++counts.shown;
+    else
+        ready.insert(url, row);
+}
+
+void ThumbnailScheduler::onThumbnailFailed(const QUrl &url)
+{
+    pending.remove(url);
+    held.remove(url);
+}
+
+int ThumbnailScheduler::rowCount() const
+{
+    return view->model() ? view->model()->rowCount(view->rootIndex()) : 0;
+}
+
+QUrl ThumbnailScheduler::urlOfRow(int row) const
+{
+    const QModelIndex &index = view->model()->index(row, 0, view->rootIndex());
+    const AbstractFileInfoPointer &info = view->model()->fileInfo(index);
+    return info ? info->urlOf(UrlInfoType::kUrl) : QUrl();
+}
+
+/*!
+ * \brief ThumbnailScheduler::prefetchUrlOfRow The url of the row if it surely has a thumbnail,
+ * known by its mime type without loading the icon
+ */
+QUrl ThumbnailScheduler::prefetchUrlOfRow(int row) const
+{
+    const QModelIndex &index = view->model()->index(row, 0, view->rootIndex());
+    const AbstractFileInfoPointer &info = view->model()->fileInfo(index);
+    if (!info || info->isAttributes(OptInfoType::kIsDir))
+        return QUrl();
+
+    if (ThumbnailProvider::instance()->hasThumbnailFast(info->nameOf(NameInfoType::kMimeTypeName)) != 1)
+        return QUrl();
+
+    return info->urlOf(UrlInfoType::kUrl);
+}
+
+bool ThumbnailScheduler::isVisible(int row) const
+{
+    return row >= visibleFirst && row <= visibleLast;
+}
+
+bool ThumbnailScheduler::hold(const QUrl &url, int row)
+{
+    pending.insert(url, row);
+    if (held.contains(url))
+        return true;
+    if (!FileInfoHelper::instance().holdThumbAsync(url))
+        return false;
+
+    held.insert(url);
+    return true;
+}
+
+/*!
+ * \brief ThumbnailScheduler::release Let go the request held by this view
+ * \return true if no view holds it and it is dropped
+ */
+bool ThumbnailScheduler::release(const QUrl &url)
+{
+    if (!held.remove(url))
+        return false;
+
+    return FileInfoHelper::instance().cancelThumbAsync(url);
+}
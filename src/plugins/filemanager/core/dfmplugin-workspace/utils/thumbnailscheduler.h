@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILSCHEDULER_H
+#define THUMBNAILSCHEDULER_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QUrl>
+
+namespace dfmplugin_workspace {
+class FileView;
+/*!
+ * \class ThumbnailScheduler
+ * \brief Order the thumbnails of a view by the rows it shows.
+ * The visible rows run first, the next viewport in the scroll direction is requested ahead,
+ * and the requests more than a viewport away from the visible rows are dropped, including the ones
+ * requested by painting the rows scrolled through.
+ * The views share the thumbnail requests of the same file, a view only holds and lets go the requests
+ * of its rows, so a request is canceled when no view holds it.
+ */
+class ThumbnailScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Metrics
+    {
+        int shown { 0 };   // finished in the view, or scrolled into the view after finished
+        int wasted { 0 };   // finished but never shown
+        int canceled { 0 };   // dropped before started
+    };
+
+    explicit ThumbnailScheduler(FileView *parent);
+
+    void updateVisibleRange(int first, int last);
+    void leaveRows(int first, int last);
+    void reset();
+    Metrics metrics() const;
+
+private Q_SLOTS:
+    void onThumbnailFinished(const QUrl &url);
+    void onThumbnailFailed(const QUrl &url);
+
+protected:
+    virtual int rowCount() const;
+    virtual QUrl urlOfRow(int row) const;
+    virtual QUrl prefetchUrlOfRow(int row) const;
+
+private:
+    bool isVisible(int row) const;
+    bool hold(const QUrl &url, int row);
+    bool release(const QUrl &url);
+
+private:
+    FileView *view { nullptr };
+    int visibleFirst { -1 };
+    int visibleLast { -1 };
+    QHash<QUrl, int> pending;   // url -> row, may be requested and not finished
+    QHash<QUrl, int> ready;   // url -> row, finished out of the view
+    QSet<QUrl> held;   // the requests held by this view
+    Metrics counts;
+};
+
+}
+
+#endif   // THUMBNAILSCHEDULER_H
@@ -12,6 +12,10 @@ using namespace dfmbase;
 using namespace dfmplugin_workspace;
 USING_IO_NAMESPACE
 
+static constexpr int kFirstBatchCount { 50 };   // 第一批尽快显示一屏
+static constexpr int kMaxBatchCount { 1000 };
+static constexpr qint64 kBatchInterval { 100 };   // ms
+
 TraversalDirThreadManager::TraversalDirThreadManager(const QUrl &url,
                                                      const QStringList &nameFilters,
                                                      QDir::Filters filters,
@@ -81,7 +85,13 @@ int TraversalDirThreadManager::iteratorOneByOne(const QElapsedTimer &timer)
         return 0;
     }
 
-    QList<AbstractFileInfoPointer> childrenList;   // 当前遍历出来的所有文件
+    // a queued event for every file floods the event loop of a big remote directory,
+    // so the files are delivered in batches, a batch is sent when it is full or too old
+    int count = 0;
+    int batchCount = kFirstBatchCount;
+    QList<AbstractFileInfoPointer> batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
     while (dirIterator->hasNext()) {
         if (stopFlag)
             break;
@@ -95,14 +105,22 @@ int TraversalDirThreadManager::iteratorOneByOne(const QElapsedTimer &timer)
         if (!fileInfo)
             continue;
 
-        emit updateChildManager(fileInfo);
-        childrenList.append(fileInfo);
+        batch.append(fileInfo);
+        ++count;
+        if (batch.count() >= batchCount || batchTimer.elapsed() >= kBatchInterval) {
+            emit updateChildrenManager(batch);
+            batch.clear();
+            batchCount = kMaxBatchCount;
+            batchTimer.restart();
+        }
     }
-    emit updateChildrenManager(childrenList);
+
+    if (!batch.isEmpty() && !stopFlag)
+        emit updateChildrenManager(batch);
 
     emit traversalFinished();
 
-    return childrenList.count();
+    return count;
 }
 
 int TraversalDirThreadManager::iteratorAll()
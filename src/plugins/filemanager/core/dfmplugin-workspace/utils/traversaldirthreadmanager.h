@@ -36,8 +36,8 @@ public:
     void setSortAgruments(const Qt::SortOrder order, const dfmbase::Global::ItemRoles sortRole, const bool isMixDirAndFile);
 
 Q_SIGNALS:
+    // the children are delivered in batches bounded by count and time
     void updateChildrenManager(QList<AbstractFileInfoPointer> children);
-    void updateChildManager(const AbstractFileInfoPointer child);
     // Special processing If it is a local file, directly read all the simple sorting lists of the file
     void updateLocalChildren(QList<SortInfoPointer> children,
                              dfmio::DEnumerator::SortRoleCompareFlag sortRole,
@@ -20,6 +20,7 @@
 #include "utils/shortcuthelper.h"
 #include "utils/fileviewmenuhelper.h"
 #include "utils/fileoperatorhelper.h"
+#include "utils/thumbnailscheduler.h"
 #include "events/workspaceeventsequence.h"
 
 #include "dfm-base/dfm_event_defines.h"
@@ -78,6 +79,7 @@ FileView::FileView(const QUrl &url, QWidget *parent)
 
 FileView::~FileView()
 {
+    d->thumbnailScheduler->reset();
     disconnect(model(), &FileViewModel::stateChanged, this, &FileView::onModelStateChanged);
     disconnect(selectionModel(), &QItemSelectionModel::selectionChanged, this, &FileView::onSelectionChanged);
 }
@@ -163,6 +165,7 @@ bool FileView::setRootUrl(const QUrl &url)
     setFocus();
 
     const QUrl &fileUrl = parseSelectedUrl(url);
+    d->thumbnailScheduler->reset();
     const QModelIndex &index = model()->setRootUrl(fileUrl);
 
     setRootIndex(index);
@@ -494,10 +497,16 @@ void FileView::updateModelActiveIndex()
         model()->setIndexActive(model()->index(i, 0, rootIndex()), false);
     }
 
+    // the rows scrolled through are painted and request their thumbnails
+    d->thumbnailScheduler->leaveRows(d->visibleIndexRande.first, rande.first - 1);
+    d->thumbnailScheduler->leaveRows(rande.second + 1, d->visibleIndexRande.second);
+
     d->visibleIndexRande = rande;
     for (int i = rande.first; i <= rande.second; ++i) {
         model()->setIndexActive(model()->index(i, 0, rootIndex()));
     }
+
+    d->thumbnailScheduler->updateVisibleRange(rande.first, rande.second);
 }
 
 FileView::RandeIndexList FileView::visibleIndexes(QRect rect) const
@@ -14,6 +14,7 @@
 #include "utils/shortcuthelper.h"
 #include "utils/fileoperatorhelper.h"
 #include "utils/fileviewmenuhelper.h"
+#include "utils/thumbnailscheduler.h"
 
 #include "dfm-base/base/application/application.h"
 #include "dfm-base/base/application/settings.h"
@@ -32,6 +33,7 @@ FileViewPrivate::FileViewPrivate(FileView *qq)
     selectHelper = new SelectHelper(qq);
     shortcutHelper = new ShortcutHelper(qq);
     viewMenuHelper = new FileViewMenuHelper(qq);
+    thumbnailScheduler = new ThumbnailScheduler(qq);
 
     enabledSelectionModes << FileView::NoSelection << FileView::SingleSelection
                           << FileView::MultiSelection << FileView::ExtendedSelection
@@ -28,6 +28,7 @@ class FileViewHelper;
 class FileViewStatusBar;
 class HeaderView;
 class BaseItemDelegate;
+class ThumbnailScheduler;
 class FileViewPrivate
 {
     friend class FileView;
@@ -50,6 +51,7 @@ class FileViewPrivate
     SelectHelper *selectHelper { nullptr };
     FileViewMenuHelper *viewMenuHelper { nullptr };
     FileViewHelper *fileViewHelper { nullptr };
+    ThumbnailScheduler *thumbnailScheduler { nullptr };
 
     QList<FileView::SelectionMode> enabledSelectionModes;
     DFMBASE_NAMESPACE::Global::ViewMode currentViewMode = DFMBASE_NAMESPACE::Global::ViewMode::kIconMode;
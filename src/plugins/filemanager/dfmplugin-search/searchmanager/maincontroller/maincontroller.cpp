@@ -96,10 +96,19 @@ void MainController::onFileChanged(const QString &path)
 
     Settings settings("deepin/dde-file-manager", Settings::kGenericConfig);
     bool value = settings.value("GenericAttribute", "IndexFullTextSearch", false).toBool();
-    if (value && !indexFuture.isRunning()) {
+    if (!value) {
+        FullTextSearcher::requestDaemonIndex(false);
+        return;
+    }
+
+    // 优先由后台服务建立并维护索引，服务不可用时在进程内建立
+    FullTextSearcher::requestDaemonIndex(true, [this](bool ok) {
+        if (ok || indexFuture.isRunning())
+            return;
+
         indexFuture = QtConcurrent::run([]() {
             FullTextSearcher searcher(QUrl(), "");
             searcher.createIndex("/");
         });
-    }
+    });
 }
@@ -15,18 +15,32 @@
 static int kEmitInterval = 50;   // 推送时间间隔（ms）
 static qint32 kMaxCount = 100;   // 最大搜索结果数量
 static qint64 kMaxTime = 500;   // 最大搜索时间（ms）
+static constexpr char kAnythingService[] { "com.deepin.anything" };
+static constexpr char kAnythingPath[] { "/com/deepin/anything" };
+static constexpr char kDaemonService[] { "com.deepin.filemanager.daemon" };
+static constexpr char kFileNameIndexPath[] { "/com/deepin/filemanager/daemon/FileNameIndex" };
 
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
 
+namespace {
+// deepin-anything 不可用时, 使用 dde-file-manager-daemon 内置的文件名索引, 两者的接口相同
+ComDeepinAnythingInterface *createAnythingInterface(QObject *parent = nullptr)
+{
+    auto interface = new ComDeepinAnythingInterface(kAnythingService, kAnythingPath, QDBusConnection::systemBus(), parent);
+    if (interface->isValid())
+        return interface;
+
+    delete interface;
+    return new ComDeepinAnythingInterface(kDaemonService, kFileNameIndexPath, QDBusConnection::systemBus(), parent);
+}
+}   // namespace
+
 AnythingSearcher::AnythingSearcher(const QUrl &url, const QString &keyword, bool isBindPath, QObject *parent)
     : AbstractSearcher(url, SearchHelper::instance()->checkWildcardAndToRegularExpression(keyword), parent),
       isBindPath(isBindPath)
 {
-    anythingInterface = new ComDeepinAnythingInterface("com.deepin.anything",
-                                                       "/com/deepin/anything",
-                                                       QDBusConnection::systemBus(),
-                                                       this);
+    anythingInterface = createAnythingInterface(this);
 }
 
 AnythingSearcher::~AnythingSearcher()
@@ -146,17 +160,15 @@ bool AnythingSearcher::isSupported(const QUrl &url, bool &isBindPath)
     if (!url.isValid() || UrlRoute::isVirtual(url))
         return false;
 
-    static ComDeepinAnythingInterface anything("com.deepin.anything",
-                                               "/com/deepin/anything",
-                                               QDBusConnection::systemBus());
-    if (!anything.isValid())
+    static QScopedPointer<ComDeepinAnythingInterface> anything(createAnythingInterface());
+    if (!anything->isValid())
         return false;
 
     auto path = UrlRoute::urlToPath(url);
-    if (!anything.hasLFT(path)) {
+    if (!anything->hasLFT(path)) {
         const auto &bindPath = FileUtils::bindPathTransform(path, true);
         if (bindPath != path) {
-            if (!anything.hasLFT(bindPath))
+            if (!anything->hasLFT(bindPath))
                 return false;
             isBindPath = true;
         } else {
@@ -18,6 +18,9 @@
 #include <FuzzyQuery.h>
 #include <QueryWrapperFilter.h>
 
+#include <QDBusInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusReply>
 #include <QRegExp>
 #include <QDebug>
 #include <QFileInfo>
@@ -36,6 +39,12 @@ static constexpr char kSupportFiles[] = "(rtf)|(odt)|(ods)|(odp)|(odg)|(docx)|(x
                                         "(xls)|(xlsb)|(doc)|(dot)|(wps)|(ppt)|(pps)|(txt)|(pdf)|(dps)";
 static int kMaxResultNum = 100000;   // 最大搜索结果数
 static int kEmitInterval = 50;   // 推送时间间隔
+static int kDaemonSearchTimeout = 60 * 1000;   // 后台服务搜索超时(ms)
+
+// 全文索引由dde-file-manager-daemon维护，服务不可用时在进程内建立索引
+static constexpr char kDaemonService[] { "com.deepin.filemanager.daemon" };
+static constexpr char kDaemonFullTextPath[] { "/com/deepin/filemanager/daemon/FullTextIndex" };
+static constexpr char kDaemonFullTextIface[] { "com.deepin.filemanager.daemon.FullTextIndex" };
 
 using namespace Lucene;
 DFMBASE_USE_NAMESPACE
@@ -387,6 +396,47 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
     return true;
 }
 
+bool FullTextSearcherPrivate::searchByDaemon(const QString &path, const QString &keyword)
+{
+    notifyTimer.start();
+
+    bool hasTransform = false;
+    QString searchPath = FileUtils::bindPathTransform(path, false);
+    if (searchPath != path)
+        hasTransform = true;
+
+    QDBusInterface iface(kDaemonService, kDaemonFullTextPath, kDaemonFullTextIface, QDBusConnection::systemBus());
+    iface.setTimeout(kDaemonSearchTimeout);
+    QDBusReply<QStringList> reply = iface.call("Search", searchPath, keyword);
+    if (!reply.isValid()) {
+        qWarning() << "full-text search by daemon failed, search locally:" << reply.error().message();
+        return false;
+    }
+
+    QHash<QString, QSet<QString>> hiddenFileHash;
+    for (QString resultPath : reply.value()) {
+        //中断
+        if (status.loadAcquire() != AbstractSearcher::kRuning)
+            return true;
+
+        // the daemon updates the index a few seconds after the file is changed
+        if (!QFileInfo::exists(resultPath))
+            continue;
+
+        if (!SearchHelper::instance()->isHiddenFile(resultPath, hiddenFileHash, searchPath)) {
+            if (hasTransform)
+                resultPath.replace(0, searchPath.length(), path);
+            QMutexLocker lk(&mutex);
+            allResults.append(QUrl::fromLocalFile(resultPath));
+        }
+
+        //推送
+        tryNotify();
+    }
+
+    return true;
+}
+
 QString FullTextSearcherPrivate::dealKeyword(const QString &keyword)
 {
     static QRegExp cnReg("^[\u4e00-\u9fa5]");
@@ -445,6 +495,28 @@ bool FullTextSearcher::createIndex(const QString &path)
     return res;
 }
 
+/*!
+ * \brief FullTextSearcher::requestDaemonIndex Ask the daemon to start or stop indexing the files of current user
+ * \param enable start or stop
+ * \param callback called with false if the daemon can not index, the index has to be created in process then
+ */
+void FullTextSearcher::requestDaemonIndex(bool enable, std::function<void(bool)> callback)
+{
+    QDBusInterface iface(kDaemonService, kDaemonFullTextPath, kDaemonFullTextIface, QDBusConnection::systemBus());
+    QDBusPendingCall call = iface.asyncCall(enable ? "CreateIndex" : "StopIndex");
+    if (!callback)
+        return;
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [callback](QDBusPendingCallWatcher *self) {
+        QDBusPendingReply<bool> reply = *self;
+        if (reply.isError())
+            qWarning() << "full-text index by daemon failed:" << reply.error().message();
+        callback(!reply.isError() && reply.value());
+        self->deleteLater();
+    });
+}
+
 bool FullTextSearcher::isSupport(const QUrl &url)
 {
     if (!url.isValid() || UrlRoute::isVirtual(url))
@@ -469,9 +541,11 @@ bool FullTextSearcher::search()
         return false;
     }
 
-    // 先更新索引再搜索
-    d->updateIndex(path);
-    d->doSearch(path, key);
+    // 后台服务维护索引时直接查询，否则先更新索引再搜索
+    if (!d->searchByDaemon(path, key)) {
+        d->updateIndex(path);
+        d->doSearch(path, key);
+    }
     //检查是否还有数据
     if (d->status.testAndSetRelease(kRuning, kCompleted)) {
         //发送数据
@@ -9,6 +9,8 @@
 
 #include <QObject>
 
+#include <functional>
+
 DPSEARCH_BEGIN_NAMESPACE
 
 class FullTextSearcherPrivate;
@@ -27,6 +29,7 @@ private:
     bool hasItem() const override;
     QList<QUrl> takeAll() override;
     static bool isSupport(const QUrl &url);
+    static void requestDaemonIndex(bool enable, std::function<void(bool)> callback = nullptr);
 
 private:
     FullTextSearcherPrivate *d = nullptr;
@@ -52,6 +52,7 @@ private:
     bool createIndex(const QString &path);
     bool updateIndex(const QString &path);
     bool doSearch(const QString &path, const QString &keyword);
+    bool searchByDaemon(const QString &path, const QString &keyword);
     inline static QString indexStorePath()
     {
         static QString path = QStandardPaths::standardLocations(QStandardPaths::ConfigLocation).first()
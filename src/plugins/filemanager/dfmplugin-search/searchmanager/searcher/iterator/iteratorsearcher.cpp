@@ -5,11 +5,17 @@
 #include "iteratorsearcher.h"
 #include "utils/searchhelper.h"
 
-#include "dfm-base/utils/fileutils.h"
 #include "dfm-base/base/schemefactory.h"
+#include "dfm-base/utils/direntwalker.h"
 
+#include <QFile>
 #include <QDebug>
 
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
 static int kEmitInterval = 50;   // 推送时间间隔（ms
 static constexpr char kFilterFolders[] = "^/(dev|proc|sys|run|tmpfs).*$";
 
@@ -20,6 +26,7 @@ IteratorSearcher::IteratorSearcher(const QUrl &url, const QString &key, QObject
     : AbstractSearcher(url, SearchHelper::instance()->checkWildcardAndToRegularExpression(key), parent)
 {
     searchPathList << url;
+    searchedPaths << url;
     regex = QRegularExpression(keyword, QRegularExpression::CaseInsensitiveOption);
 }
 
@@ -31,7 +38,10 @@ bool IteratorSearcher::search()
 
     notifyTimer.start();
     // 遍历搜索
-    doSearch();
+    if (searchUrl.isLocalFile())
+        doLocalSearch();
+    else
+        doSearch();
 
     //检查是否还有数据
     if (status.testAndSetRelease(kRuning, kCompleted)) {
@@ -62,34 +72,37 @@ QList<QUrl> IteratorSearcher::takeAll()
 
 void IteratorSearcher::tryNotify()
 {
-    int cur = notifyTimer.elapsed();
-    if (hasItem() && (cur - lastEmit) > kEmitInterval) {
-        lastEmit = cur;
+    const qint64 cur = notifyTimer.elapsed();
+    qint64 last = lastEmit.load();
+    // the local search notifies from several threads, only one of them emits
+    if (hasItem() && (cur - last) > kEmitInterval && lastEmit.compare_exchange_strong(last, cur)) {
         qDebug() << "IteratorSearcher unearthed, current spend:" << cur;
         emit unearthed(this);
     }
 }
 
+void IteratorSearcher::appendResults(const QList<QUrl> &results)
+{
+    {
+        QMutexLocker lk(&mutex);
+        allResults << results;
+    }
+
+    //推送
+    tryNotify();
+}
+
 void IteratorSearcher::doSearch()
 {
     forever {
         if (searchPathList.isEmpty() || status.loadAcquire() != kRuning)
             return;
 
-        const auto &url = searchPathList.takeAt(0);
+        const auto &url = searchPathList.takeFirst();
         auto iterator = DirIteratorFactory::create(url, QStringList(), QDir::NoDotAndDotDot | QDir::Dirs | QDir::Files);
         if (!iterator)
             continue;
 
-        // 仅在过滤目录下进行搜索时，过滤目录下的内容才能被检索
-        if (dfmbase::FileUtils::isLocalFile(url)) {
-            QRegExp reg(kFilterFolders);
-            const auto &searchRootPath = searchUrl.toLocalFile();
-            const auto &filePath = url.toLocalFile();
-            if (!reg.exactMatch(searchRootPath) && reg.exactMatch(filePath))
-                continue;
-        }
-
         while (iterator->hasNext()) {
             //中断
             if (status.loadAcquire() != kRuning)
@@ -103,23 +116,79 @@ void IteratorSearcher::doSearch()
             // 将目录添加到待搜索目录中
             if (info->isAttributes(OptInfoType::kIsDir) && !info->isAttributes(OptInfoType::kIsSymLink)) {
                 const auto &fileUrl = info->urlOf(UrlInfoType::kUrl);
-                if (!searchPathList.contains(fileUrl) || !fileUrl.path().startsWith("/sys/"))
+                if (!searchedPaths.contains(fileUrl)) {
+                    searchedPaths.insert(fileUrl);
                     searchPathList << fileUrl;
+                }
             }
 
             QRegularExpressionMatch match = regex.match(info->displayOf(DisPlayInfoType::kFileDisplayName));
-            if (match.hasMatch()) {
-                const auto &fileUrl = info->urlOf(UrlInfoType::kUrl);
-                {
-                    QMutexLocker lk(&mutex);
-                    allResults << fileUrl;
-                }
-
-                //推送
-                tryNotify();
-            }
+            if (match.hasMatch())
+                appendResults({ info->urlOf(UrlInfoType::kUrl) });
         }
 
         iterator.clear();
     }
 }
+
+/*!
+ * \brief IteratorSearcher::doLocalSearch Search the local files without the file infos,
+ * the results of every directory are pushed by unearthed as soon as the directory is read.
+ * The names are matched on the raw dirents, only the directories are stated to find the ones
+ * visited twice through bind mounts.
+ */
+void IteratorSearcher::doLocalSearch()
+{
+    const QByteArray &root = QFile::encodeName(searchUrl.toLocalFile());
+    struct stat rootStat;
+    if (stat(root.constData(), &rootStat) != 0 || !S_ISDIR(rootStat.st_mode))
+        return;
+
+    // 仅在过滤目录下进行搜索时，过滤目录下的内容才能被检索
+    const QRegularExpression filterFolders(kFilterFolders);
+    const bool skipFilterFolders = !filterFolders.match(QFile::decodeName(root)).hasMatch();
+
+    DirentWalker walker;
+    walker.markVisited(rootStat.st_dev, rootStat.st_ino);
+    // the matched files of the directory being read by every walking thread
+    std::vector<QList<QUrl>> threadResults(static_cast<size_t>(walker.threadCount()));
+    walker.setStateCheck([this]() { return status.loadAcquire() == kRuning; });
+    walker.setEntryFunc([&](int thread, const DirentWalker::Directory &, const QByteArray &prefix,
+                            const DirentWalker::Entry &entry, std::vector<DirentWalker::Directory> *subDirs) {
+        // the hidden files are not searched, same as the dir iterator without QDir::Hidden
+        if (entry.name[0] == '.')
+            return;
+
+        const bool isMatched = regex.match(QFile::decodeName(entry.name)).hasMatch();
+        unsigned char type = entry.type;
+        struct stat st;
+        if (type == DT_DIR || type == DT_UNKNOWN || (type == DT_LNK && isMatched)) {
+            // a matched link must not be broken
+            if (fstatat(entry.dirFd, entry.name, &st, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) != 0)
+                return;
+            if (type == DT_UNKNOWN)
+                type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+        }
+
+        const QByteArray &filePath = prefix + entry.name;
+        if (isMatched)
+            threadResults[static_cast<size_t>(thread)].append(QUrl::fromLocalFile(QFile::decodeName(filePath)));
+
+        if (type != DT_DIR || !walker.markVisited(st.st_dev, st.st_ino))
+            return;
+
+        // the filtered folders are all in the root directory
+        if (prefix == "/" && skipFilterFolders && filterFolders.match(QFile::decodeName(filePath)).hasMatch())
+            return;
+        subDirs->push_back(DirentWalker::Directory { filePath, static_cast<quint64>(st.st_dev), 0 });
+    });
+    walker.setDirectoryFunc([&](int thread, const DirentWalker::Directory &) {
+        QList<QUrl> &results = threadResults[static_cast<size_t>(thread)];
+        if (results.isEmpty())
+            return;
+        appendResults(results);
+        results.clear();
+    });
+
+    walker.walk({ DirentWalker::Directory { root, static_cast<quint64>(rootStat.st_dev), 0 } });
+}
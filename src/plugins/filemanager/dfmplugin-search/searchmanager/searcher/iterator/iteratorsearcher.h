@@ -7,10 +7,13 @@
 
 #include "searchmanager/searcher/abstractsearcher.h"
 
-#include <QTime>
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QSet>
 #include <QRegularExpression>
 
+#include <atomic>
+
 DPSEARCH_BEGIN_NAMESPACE
 
 class IteratorSearcher : public AbstractSearcher
@@ -28,17 +31,20 @@ private:
     QList<QUrl> takeAll() override;
     void tryNotify();
     void doSearch();
+    void doLocalSearch();
+    void appendResults(const QList<QUrl> &results);
 
 private:
     QAtomicInt status = kReady;
     QList<QUrl> allResults;
     mutable QMutex mutex;
     QList<QUrl> searchPathList;
+    QSet<QUrl> searchedPaths;
     QRegularExpression regex;
 
     //计时
-    QTime notifyTimer;
-    int lastEmit = 0;
+    QElapsedTimer notifyTimer;
+    std::atomic<qint64> lastEmit { 0 };
 };
 
 DPSEARCH_END_NAMESPACE
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// The document parser of the full-text index of dde-file-manager-daemon.
+// The daemon runs as root, the documents are parsed here as the user who owns the index,
+// so a bug of the parsers can not gain more than the user.
+//
+// request:  the path of a file, terminated by '\0'
+// response: the size of the contents in quint32 of the native byte order, followed by the contents in utf-8
+
+#include <docparser.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+
+namespace {
+bool readRequest(std::string *path)
+{
+    path->clear();
+    char buf[1];
+    while (true) {
+        const ssize_t size = read(STDIN_FILENO, buf, 1);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            return false;
+        if (buf[0] == '\0')
+            return true;
+        path->push_back(buf[0]);
+    }
+}
+
+bool writeAll(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+}   // namespace
+
+int main()
+{
+    if (getuid() == 0 || geteuid() == 0) {
+        fprintf(stderr, "dfm-docparser: refuse to parse documents as root\n");
+        return 1;
+    }
+    prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+
+    // the parsers may print to stdout, keep it for the responses only
+    const int out = dup(STDOUT_FILENO);
+    if (out < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+        return 1;
+
+    std::string path;
+    while (readRequest(&path)) {
+        std::string contents;
+        try {
+            contents = DocParser::convertFile(path);
+        } catch (...) {
+            fprintf(stderr, "dfm-docparser: failed to parse %s\n", path.c_str());
+        }
+
+        const uint32_t size = static_cast<uint32_t>(contents.size());
+        if (!writeAll(out, reinterpret_cast<const char *>(&size), sizeof(size))
+            || !writeAll(out, contents.data(), size))
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/base/device/mounttable.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+namespace {
+const QByteArray kMountInfo {
+    "22 1 8:2 / / rw,relatime shared:1 - ext4 /dev/sda2 rw\n"
+    "25 22 8:3 / /home rw,relatime shared:2 - ext4 /dev/sda3 rw\n"
+    "30 22 0:25 / /run/user/1000 rw,nosuid,nodev shared:3 - tmpfs tmpfs rw,size=815440k\n"
+    "31 30 0:26 / /run/user/1000/gvfs rw,nosuid,nodev shared:4 - fuse.gvfsd-fuse gvfsd-fuse rw,user_id=1000\n"
+    "40 25 0:30 / /home/user/nas rw,relatime shared:5 - cifs //192.168.1.2/share rw,vers=3.0\n"
+    "41 22 8:17 / /media/user/My\\040Disk rw,relatime shared:6 - vfat /dev/sdb1 rw\n"
+    "42 22 8:18 / /media/user/usb rw,relatime shared:7 - vfat /dev/sdc1 rw\n"
+    "43 22 8:19 / /media/user/usb rw,relatime shared:8 - exfat /dev/sdc2 rw\n"
+};
+}
+
+TEST(UT_MountTable, testFind)
+{
+    const MountTable::TablePointer &table = MountTable::Table::parse(kMountInfo);
+    ASSERT_EQ(8, table->count());
+
+    EXPECT_EQ(QString("/"), table->find("/usr/bin/ls")->mountPoint);
+    EXPECT_EQ(QString("/home"), table->find("/home")->mountPoint);
+    EXPECT_EQ(QString("/home"), table->find("/home/user/Documents/")->mountPoint);
+    EXPECT_EQ(QString("/"), table->find("/homework")->mountPoint);
+    EXPECT_EQ(QString("cifs"), table->find("/home/user/nas/a.txt")->fsType);
+    EXPECT_EQ(QString("/media/user/My Disk"), table->find("/media/user/My Disk/a.txt")->mountPoint);
+    EXPECT_EQ(nullptr, table->find("relative/path"));
+
+    // the later mount on the same path covers the earlier one
+    EXPECT_EQ(QString("/dev/sdc2"), table->find("/media/user/usb/a.txt")->source);
+}
+
+TEST(UT_MountTable, testClassify)
+{
+    const MountTable::TablePointer &table = MountTable::Table::parse(kMountInfo);
+
+    const MountTable::PathClass &smb = table->classify("/run/user/1000/gvfs/smb-share:server=host,share=dir/a.txt");
+    EXPECT_EQ(QString("smb-share"), smb.gvfsScheme);
+    EXPECT_EQ(MountTable::kLowSpeed, smb.speed);
+    EXPECT_TRUE(smb.isRemote);
+
+    const MountTable::PathClass &mtp = table->classify("/run/user/1000/gvfs/mtp:host=Phone");
+    EXPECT_EQ(QString("mtp"), mtp.gvfsScheme);
+    EXPECT_EQ(MountTable::kLowSpeed, mtp.speed);
+    EXPECT_FALSE(mtp.isRemote);
+
+    const MountTable::PathClass &gvfsRoot = table->classify("/run/user/1000/gvfs");
+    EXPECT_TRUE(gvfsRoot.gvfsScheme.isEmpty());
+    EXPECT_EQ(MountTable::kNormalSpeed, gvfsRoot.speed);
+
+    const MountTable::PathClass &cifs = table->classify("/home/user/nas/a.txt");
+    EXPECT_TRUE(cifs.isRemote);
+    EXPECT_EQ(MountTable::kNormalSpeed, cifs.speed);
+
+    EXPECT_FALSE(table->classify("/home/user/a.txt").isRemote);
+}
+
+TEST(UT_MountTable, testFindBySourceAndMountPoint)
+{
+    const MountTable::TablePointer &table = MountTable::Table::parse(kMountInfo);
+
+    EXPECT_EQ(QString("/home"), table->findBySource("/dev/sda3")->mountPoint);
+    EXPECT_EQ(QString("//192.168.1.2/share"), table->findByMountPoint("/home/user/nas")->source);
+    EXPECT_EQ(QString("/dev/sdc2"), table->findByMountPoint("/media/user/usb")->source);
+    EXPECT_EQ(nullptr, table->findBySource("/dev/sdz"));
+}
+
+TEST(UT_MountTable, testBrokenLines)
+{
+    const MountTable::TablePointer &table = MountTable::Table::parse("\nbroken line\n22 1 8:2 / / rw - ext4\n");
+    EXPECT_EQ(0, table->count());
+    EXPECT_EQ(nullptr, table->find("/home"));
+}
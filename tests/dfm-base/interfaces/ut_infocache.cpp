@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/interfaces/private/infocache_p.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_InfoCacheShard : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+    }
+
+    virtual void TearDown() override
+    {
+    }
+
+    InfoCacheShard shard;
+};
+
+TEST_F(UT_InfoCacheShard, testInsertAndTake)
+{
+    const QUrl url = QUrl::fromLocalFile("/tmp/a");
+    shard.insert(url, nullptr, 10, 0);
+    EXPECT_EQ(1, shard.count());
+    EXPECT_EQ(10, shard.cost());
+
+    // replace keeps one node
+    shard.insert(url, nullptr, 20, 1);
+    EXPECT_EQ(1, shard.count());
+    EXPECT_EQ(20, shard.cost());
+
+    shard.take(url);
+    EXPECT_EQ(0, shard.count());
+    EXPECT_EQ(0, shard.cost());
+}
+
+TEST_F(UT_InfoCacheShard, testTakeOverBudgetEvictsLeastRecentlyUsed)
+{
+    const QUrl a = QUrl::fromLocalFile("/tmp/a");
+    const QUrl b = QUrl::fromLocalFile("/tmp/b");
+    const QUrl c = QUrl::fromLocalFile("/tmp/c");
+    shard.insert(a, nullptr, 10, 0);
+    shard.insert(b, nullptr, 10, 1);
+    shard.insert(c, nullptr, 10, 2);
+    // a becomes the most recently used
+    shard.value(a, 3);
+
+    QMap<QUrl, AbstractFileInfoPointer> evicted;
+    shard.takeOverBudget(20, &evicted);
+    EXPECT_EQ(1, evicted.size());
+    EXPECT_TRUE(evicted.contains(b));
+    EXPECT_EQ(2, shard.count());
+}
+
+TEST_F(UT_InfoCacheShard, testSetCostGrowsOverBudget)
+{
+    const QUrl a = QUrl::fromLocalFile("/tmp/a");
+    const QUrl b = QUrl::fromLocalFile("/tmp/b");
+    shard.insert(a, nullptr, 10, 0);
+    shard.insert(b, nullptr, 10, 1);
+
+    // a loaded its thumbnail after cached
+    shard.setCost(a, nullptr, 100);
+    EXPECT_EQ(110, shard.cost());
+
+    QMap<QUrl, AbstractFileInfoPointer> evicted;
+    shard.takeOverBudget(50, &evicted);
+    EXPECT_EQ(1, evicted.size());
+    EXPECT_TRUE(evicted.contains(a));
+    EXPECT_EQ(10, shard.cost());
+}
+
+TEST_F(UT_InfoCacheShard, testTakeExpired)
+{
+    const QUrl a = QUrl::fromLocalFile("/tmp/a");
+    const QUrl b = QUrl::fromLocalFile("/tmp/b");
+    shard.insert(a, nullptr, 10, 100);
+    shard.insert(b, nullptr, 10, 200);
+
+    QMap<QUrl, AbstractFileInfoPointer> expired;
+    shard.takeExpired(150, &expired);
+    EXPECT_EQ(1, expired.size());
+    EXPECT_TRUE(expired.contains(a));
+    EXPECT_EQ(1, shard.count());
+}
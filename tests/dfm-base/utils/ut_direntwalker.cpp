@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/direntwalker.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include <dirent.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_DirentWalker : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        // root/a/b/c, every directory has 10 files
+        QString path = tempDir.path();
+        for (const QString &name : { "a", "b", "c" }) {
+            path += "/" + name;
+            QDir().mkpath(path);
+            for (int i = 0; i < 10; ++i) {
+                QFile file(path + QString("/%1.txt").arg(i));
+                file.open(QIODevice::WriteOnly);
+            }
+        }
+    }
+
+    std::vector<DirentWalker::Directory> roots() const
+    {
+        return { DirentWalker::Directory { QFile::encodeName(tempDir.path()), 0, 0 } };
+    }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_DirentWalker, testWalk)
+{
+    DirentWalker walker(4);
+    std::atomic_int files { 0 };
+    std::atomic_int directories { 0 };
+    walker.setEntryFunc([&](int, const DirentWalker::Directory &dir, const QByteArray &prefix,
+                            const DirentWalker::Entry &entry, std::vector<DirentWalker::Directory> *subDirs) {
+        if (entry.type == DT_DIR || QDir(QFile::decodeName(prefix + entry.name)).exists())
+            subDirs->push_back(DirentWalker::Directory { prefix + entry.name, dir.dev, dir.flags + 1 });
+        else
+            ++files;
+    });
+    walker.setDirectoryFunc([&](int thread, const DirentWalker::Directory &dir) {
+        EXPECT_LT(thread, walker.threadCount());
+        // the flags are given by the caller
+        EXPECT_EQ(dir.flags, QFile::decodeName(dir.path).count('/') - tempDir.path().count('/'));
+        ++directories;
+    });
+
+    EXPECT_TRUE(walker.walk(roots()));
+    EXPECT_EQ(30, files.load());
+    EXPECT_EQ(4, directories.load());
+}
+
+TEST_F(UT_DirentWalker, testStop)
+{
+    DirentWalker walker;
+    walker.setStateCheck([] { return false; });
+    EXPECT_FALSE(walker.walk(roots()));
+    EXPECT_TRUE(walker.isStopped());
+}
+
+TEST_F(UT_DirentWalker, testMarkVisited)
+{
+    DirentWalker walker;
+    EXPECT_TRUE(walker.markVisited(1, 2));
+    EXPECT_FALSE(walker.markVisited(1, 2));
+    EXPECT_TRUE(walker.markVisited(2, 2));
+}
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/elidetextlayout.h"
+
+#include <QTextOption>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+namespace {
+const QString kLongName { "一个很长很长的中文文件名字用来测试换行和省略的效果.txt" };
+
+ElideTextLayout *createLayout(const QString &name)
+{
+    ElideTextLayout *layout = new ElideTextLayout(name);
+    layout->setAttribute(ElideTextLayout::kWrapMode, (uint)QTextOption::WrapAtWordBoundaryOrAnywhere);
+    layout->setAttribute(ElideTextLayout::kLineHeight, 20);
+    layout->setAttribute(ElideTextLayout::kAlignment, Qt::AlignCenter);
+    return layout;
+}
+}
+
+TEST(UT_ElideTextLayout, testSameAsDocument)
+{
+    const QRectF rect(10, 10, 80, 60);
+    QScopedPointer<ElideTextLayout> cached(createLayout(kLongName));
+    QScopedPointer<ElideTextLayout> document(createLayout(kLongName));
+    document->documentHandle();
+
+    QStringList cachedLines;
+    QStringList documentLines;
+    const QList<QRectF> &cachedRects = cached->layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &cachedLines);
+    const QList<QRectF> &documentRects = document->layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &documentLines);
+
+    EXPECT_EQ(documentLines, cachedLines);
+    EXPECT_EQ(documentRects, cachedRects);
+}
+
+TEST(UT_ElideTextLayout, testCacheHit)
+{
+    QScopedPointer<ElideTextLayout> layout(createLayout(kLongName));
+    QStringList first;
+    const QList<QRectF> &firstRects = layout->layout(QRectF(0, 0, 80, 60), Qt::ElideRight, nullptr, Qt::NoBrush, &first);
+
+    // the same lines at another position
+    QStringList second;
+    const QList<QRectF> &secondRects = layout->layout(QRectF(100, 50, 80, 60), Qt::ElideRight, nullptr, Qt::NoBrush, &second);
+    EXPECT_EQ(first, second);
+    ASSERT_EQ(firstRects.size(), secondRects.size());
+    for (int i = 0; i < firstRects.size(); ++i)
+        EXPECT_EQ(firstRects.at(i).translated(100, 50), secondRects.at(i));
+}
+
+TEST(UT_ElideTextLayout, testRename)
+{
+    QScopedPointer<ElideTextLayout> layout(createLayout(kLongName));
+    layout->layout(QRectF(0, 0, 80, 60), Qt::ElideRight);
+
+    layout->setText("a.txt");
+    QStringList lines;
+    layout->layout(QRectF(0, 0, 80, 60), Qt::ElideRight, nullptr, Qt::NoBrush, &lines);
+    EXPECT_EQ(QStringList { "a.txt" }, lines);
+    EXPECT_EQ(QString("a.txt"), layout->text());
+}
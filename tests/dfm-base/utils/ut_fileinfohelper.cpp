@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/fileinfohelper.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+TEST(UT_FileInfoHelper, testThumbCanceledByLastHolder)
+{
+    // the request waits for its delay, so it is not started in the test
+    const QUrl url = QUrl::fromLocalFile("/tmp/ut_fileinfohelper/held.png");
+    auto data = FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge);
+    ASSERT_TRUE(data);
+    EXPECT_EQ(data, FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge));
+
+    EXPECT_TRUE(FileInfoHelper::instance().holdThumbAsync(url));
+    EXPECT_TRUE(FileInfoHelper::instance().holdThumbAsync(url));
+    EXPECT_FALSE(FileInfoHelper::instance().cancelThumbAsync(url));
+    EXPECT_FALSE(data->finish);
+
+    EXPECT_TRUE(FileInfoHelper::instance().cancelThumbAsync(url));
+    EXPECT_TRUE(data->finish);
+    EXPECT_TRUE(data->data.toString().isEmpty());
+    EXPECT_FALSE(FileInfoHelper::instance().cancelThumbAsync(url));
+}
+
+TEST(UT_FileInfoHelper, testThumbNotHeldIsKept)
+{
+    const QUrl url = QUrl::fromLocalFile("/tmp/ut_fileinfohelper/painted.png");
+    auto data = FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge);
+    ASSERT_TRUE(data);
+
+    EXPECT_FALSE(FileInfoHelper::instance().cancelThumbAsync(url));
+    EXPECT_FALSE(data->finish);
+    EXPECT_FALSE(FileInfoHelper::instance().holdThumbAsync(QUrl::fromLocalFile("/tmp/ut_fileinfohelper/none.png")));
+}
+
+TEST(UT_FileInfoHelper, testRunningTaskNotShared)
+{
+    const QUrl url = QUrl::fromLocalFile("/tmp/ut_fileinfohelper/running.png");
+    auto data = FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge);
+    ASSERT_TRUE(data);
+
+    // a started request may have read the file before it changed
+    const QString &key = QString("thumb:%1:%2").arg(ThumbnailProvider::kLarge).arg(url.toString());
+    {
+        QMutexLocker lk(&FileInfoHelper::instance().taskMutex);
+        ASSERT_TRUE(FileInfoHelper::instance().tasks.contains(key));
+        FileInfoHelper::instance().tasks[key].isRunning = true;
+    }
+
+    auto again = FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge);
+    ASSERT_TRUE(again);
+    EXPECT_NE(data, again);
+    EXPECT_EQ(again, FileInfoHelper::instance().fileThumbAsync(url, ThumbnailProvider::kLarge));
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/filesizewalker.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_FileSizeWalker : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        // root/a/b/c, every directory has 10 files of 100 bytes
+        QString path = tempDir.path();
+        for (const QString &name : { "a", "b", "c" }) {
+            path += "/" + name;
+            QDir().mkpath(path);
+            for (int i = 0; i < 10; ++i) {
+                QFile file(path + QString("/%1.txt").arg(i));
+                file.open(QIODevice::WriteOnly);
+                file.write(QByteArray(100, 'x'));
+            }
+        }
+    }
+
+    QUrl rootUrl() const { return QUrl::fromLocalFile(tempDir.path()); }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_FileSizeWalker, testCount)
+{
+    FileSizeWalker walker(FileSizeWalker::kNoFlag, 4);
+    EXPECT_TRUE(walker.walk({ rootUrl() }));
+
+    EXPECT_EQ(30, walker.filesCount());
+    EXPECT_EQ(4, walker.directoriesCount());
+    EXPECT_EQ(3000, walker.totalSize());
+    EXPECT_EQ(3000 + 4 * getpagesize(), walker.totalProgressSize());
+}
+
+TEST_F(UT_FileSizeWalker, testExcludeRoots)
+{
+    FileSizeWalker walker(FileSizeWalker::kExcludeRoots);
+    walker.walk({ rootUrl() });
+
+    EXPECT_EQ(30, walker.filesCount());
+    EXPECT_EQ(3, walker.directoriesCount());
+}
+
+TEST_F(UT_FileSizeWalker, testHardLinks)
+{
+    const QByteArray &file = QFile::encodeName(tempDir.path() + "/a/0.txt");
+    const QByteArray &link = QFile::encodeName(tempDir.path() + "/a/link.txt");
+    ASSERT_EQ(0, ::link(file.constData(), link.constData()));
+
+    FileSizeWalker walker;
+    walker.walk({ rootUrl() });
+    EXPECT_EQ(31, walker.filesCount());
+    EXPECT_EQ(3100, walker.totalSize());
+
+    FileSizeWalker dedupWalker(FileSizeWalker::kDeduplicateHardLinks);
+    dedupWalker.walk({ rootUrl() });
+    EXPECT_EQ(30, dedupWalker.filesCount());
+    EXPECT_EQ(3000, dedupWalker.totalSize());
+}
+
+TEST_F(UT_FileSizeWalker, testSymlinkLoop)
+{
+    ASSERT_TRUE(QFile::link(tempDir.path(), tempDir.path() + "/a/b/loop"));
+
+    FileSizeWalker walker(FileSizeWalker::kFollowSymlink);
+    EXPECT_TRUE(walker.walk({ rootUrl() }));
+    EXPECT_EQ(30, walker.filesCount());
+    EXPECT_EQ(4, walker.directoriesCount());
+
+    // the link itself when not followed
+    FileSizeWalker linkWalker;
+    linkWalker.walk({ rootUrl() });
+    EXPECT_EQ(31, linkWalker.filesCount());
+}
+
+TEST_F(UT_FileSizeWalker, testRecordUrlsOrder)
+{
+    FileSizeWalker walker(FileSizeWalker::kRecordUrls);
+    walker.walk({ rootUrl() });
+
+    const QList<QUrl> &urls = walker.recordedUrls();
+    ASSERT_EQ(34, urls.count());
+    EXPECT_EQ(rootUrl(), urls.first());
+    // a directory is always before its children
+    for (int i = 0; i < urls.count(); ++i) {
+        const QUrl &parent = QUrl::fromLocalFile(QFileInfo(urls.at(i).toLocalFile()).absolutePath());
+        if (parent != rootUrl() && urls.at(i) != rootUrl())
+            EXPECT_LT(urls.indexOf(parent), i);
+    }
+}
+
+TEST_F(UT_FileSizeWalker, testStop)
+{
+    FileSizeWalker walker;
+    walker.setStateCheck([] { return false; });
+    EXPECT_FALSE(walker.walk({ rootUrl() }));
+    EXPECT_TRUE(walker.isStopped());
+}
@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/thumbnailpack.h"
+
+#include <QFile>
+#include <QDateTime>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_ThumbnailPack : public testing::Test
+{
+public:
+    QString packFile() const { return tempDir.filePath("test.pack"); }
+
+    static QImage testImage(int width, int height, QRgb color)
+    {
+        QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+        image.fill(color);
+        return image;
+    }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_ThumbnailPack, testInsertAndRead)
+{
+    ThumbnailPack pack(packFile());
+    ASSERT_TRUE(pack.isValid());
+    EXPECT_TRUE(pack.image(1, 100).isNull());
+
+    EXPECT_TRUE(pack.insert(1, 100, testImage(64, 48, qRgb(255, 0, 0))));
+    const QImage &image = pack.image(1, 100);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(QSize(64, 48), image.size());
+    EXPECT_EQ(qRgb(255, 0, 0), image.pixel(10, 10));
+
+    // the file is modified after the thumbnail
+    EXPECT_TRUE(pack.image(1, 101).isNull());
+}
+
+TEST_F(UT_ThumbnailPack, testReplace)
+{
+    ThumbnailPack pack(packFile());
+    pack.insert(1, 100, testImage(16, 16, qRgb(255, 0, 0)));
+    pack.insert(1, 200, testImage(32, 32, qRgb(0, 255, 0)));
+
+    EXPECT_EQ(1, pack.count());
+    EXPECT_TRUE(pack.image(1, 100).isNull());
+    EXPECT_EQ(qRgb(0, 255, 0), pack.image(1, 200).pixel(0, 0));
+}
+
+TEST_F(UT_ThumbnailPack, testReopen)
+{
+    {
+        ThumbnailPack pack(packFile());
+        pack.insert(1, 100, testImage(16, 16, qRgb(255, 0, 0)));
+        pack.insert(2, 100, testImage(16, 16, qRgb(0, 0, 255)));
+    }
+
+    ThumbnailPack pack(packFile());
+    EXPECT_EQ(2, pack.count());
+    EXPECT_EQ(qRgb(0, 0, 255), pack.image(2, 100).pixel(5, 5));
+}
+
+TEST_F(UT_ThumbnailPack, testSharedFile)
+{
+    ThumbnailPack reader(packFile());
+    ThumbnailPack writer(packFile());
+    writer.insert(3, 100, testImage(16, 16, qRgb(0, 0, 255)));
+
+    // appended by the other one after opened
+    EXPECT_FALSE(reader.image(3, 100).isNull());
+}
+
+TEST_F(UT_ThumbnailPack, testLockedByOtherNotWaited)
+{
+    {
+        ThumbnailPack pack(packFile());
+        pack.insert(1, 100, testImage(16, 16, qRgb(255, 0, 0)));
+    }
+
+    // another process compacting the pack, the flocks of another open file conflict like theirs
+    const int fd = ::open(packFile().toLocal8Bit().constData(), O_RDWR | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(0, flock(fd, LOCK_EX));
+
+    ThumbnailPack pack(packFile());
+    EXPECT_FALSE(pack.isValid());
+    EXPECT_TRUE(pack.image(1, 100).isNull());
+
+    // opened again by the next read
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    EXPECT_EQ(qRgb(255, 0, 0), pack.image(1, 100).pixel(0, 0));
+    EXPECT_TRUE(pack.isValid());
+}
+
+TEST_F(UT_ThumbnailPack, testBrokenTail)
+{
+    {
+        ThumbnailPack pack(packFile());
+        pack.insert(1, 100, testImage(16, 16, qRgb(255, 0, 0)));
+    }
+    {
+        QFile file(packFile());
+        ASSERT_TRUE(file.open(QIODevice::Append));
+        file.write(QByteArray(10, 'x'));
+    }
+
+    ThumbnailPack pack(packFile());
+    EXPECT_EQ(1, pack.count());
+    EXPECT_TRUE(pack.insert(2, 100, testImage(16, 16, qRgb(0, 255, 0))));
+
+    ThumbnailPack reopened(packFile());
+    EXPECT_EQ(2, reopened.count());
+}
+
+TEST_F(UT_ThumbnailPack, testInvalidImage)
+{
+    ThumbnailPack pack(packFile());
+    EXPECT_FALSE(pack.insert(1, 100, QImage()));
+    EXPECT_FALSE(pack.insert(0, 100, testImage(16, 16, qRgb(255, 0, 0))));
+    EXPECT_EQ(0, pack.count());
+}
+
+TEST_F(UT_ThumbnailPack, testRemoveMissing)
+{
+    ThumbnailPack pack(packFile());
+    pack.insert(1, 100, testImage(16, 16, qRgb(255, 0, 0)));
+    pack.insert(2, 100, testImage(16, 16, qRgb(0, 255, 0)));
+
+    pack.removeMissing({ 2 });
+    EXPECT_EQ(1, pack.count());
+    EXPECT_TRUE(pack.image(1, 100).isNull());
+    EXPECT_FALSE(pack.image(2, 100).isNull());
+}
+
+TEST_F(UT_ThumbnailPack, testTrimPacks)
+{
+    const QDateTime &now = QDateTime::currentDateTime();
+    const QStringList names { "used.pack", "old.pack", "new.pack" };
+    for (int i = 0; i < names.size(); ++i) {
+        QFile file(tempDir.filePath(names.at(i)));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(1000, 'x'));
+        file.flush();
+        file.setFileTime(now.addSecs(i - 10), QFileDevice::FileModificationTime);
+    }
+
+    // the oldest ones are removed, except the ones in use
+    ThumbnailPack::trimPacks(tempDir.path(), 2000, { tempDir.filePath("used.pack") });
+    EXPECT_TRUE(QFile::exists(tempDir.filePath("used.pack")));
+    EXPECT_FALSE(QFile::exists(tempDir.filePath("old.pack")));
+    EXPECT_TRUE(QFile::exists(tempDir.filePath("new.pack")));
+}
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "testqobject.h"
+
+#include <dfm-framework/dpf.h>
+#include <dfm-framework/event/event.h>
+
+#include <QElapsedTimer>
+
+#include <gtest/gtest.h>
+
+DPF_USE_NAMESPACE
+
+static constexpr char kSpace[] { "ut_eventhandle" };
+static const SlotHandle<int> kTestSlot { kSpace, "slot_Test" };
+static const SlotHandle<qint64> kTestSlotOtherType { kSpace, "slot_Test" };
+static const SignalHandle<int *> kTestSignal { kSpace, "signal_Test" };
+static const HookHandle<int, int *> kTestHook { kSpace, "hook_Test" };
+
+class UT_EventHandle : public testing::Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        dpfEvent->registerEventType(EventStratege::kSlot, kSpace, "slot_Test");
+        dpfEvent->registerEventType(EventStratege::kSignal, kSpace, "signal_Test");
+        dpfEvent->registerEventType(EventStratege::kHook, kSpace, "hook_Test");
+    }
+};
+
+TEST_F(UT_EventHandle, test_topic_id)
+{
+    static_assert(eventTopicId("space", "topic") == eventTopicIdHash("space:topic"));
+    static_assert(eventTopicId("space", "topic") != eventTopicId("space", "topic2"));
+
+    EXPECT_EQ(kTestSlot.id(), eventTopicIdHash("ut_eventhandle:slot_Test"));
+    EXPECT_EQ(kTestSlot.type(), DPF_EVENT_TYPE(kSpace, "slot_Test"));
+    EXPECT_TRUE(isValidEventType(kTestSlot.type()));
+
+    static const SlotHandle<> unknown { kSpace, "slot_Unknown" };
+    EXPECT_FALSE(isValidEventType(unknown.type()));
+}
+
+TEST_F(UT_EventHandle, test_push)
+{
+    TestQObject b;
+    EXPECT_TRUE(dpfSlotChannel->connect(kSpace, "slot_Test", &b, &TestQObject::test1));
+    EXPECT_EQ(dpfSlotChannel->push(kTestSlot, 8).toInt(), 18);
+    // the receiver takes another type, the argument is converted by QVariant
+    EXPECT_EQ(dpfSlotChannel->push(kTestSlotOtherType, 8).toInt(), 18);
+    EXPECT_TRUE(dpfSlotChannel->disconnect(kSpace, "slot_Test"));
+    EXPECT_FALSE(dpfSlotChannel->push(kTestSlot, 8).isValid());
+}
+
+TEST_F(UT_EventHandle, test_publish)
+{
+    TestQObject b;
+    int v = 0;
+    EXPECT_TRUE(dpfSignalDispatcher->subscribe(kSpace, "signal_Test", &b, &TestQObject::add1));
+    EXPECT_TRUE(dpfSignalDispatcher->publish(kTestSignal, &v));
+    EXPECT_TRUE(dpfSignalDispatcher->publish(kSpace, "signal_Test", &v));
+    EXPECT_EQ(v, 2);
+    EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(kSpace, "signal_Test", &b, &TestQObject::add1));
+}
+
+TEST_F(UT_EventHandle, test_run)
+{
+    TestQObject b;
+    int called = 0;
+    EXPECT_TRUE(dpfHookSequence->follow(kSpace, "hook_Test", &b, &TestQObject::bigger15));
+    EXPECT_TRUE(dpfHookSequence->follow(kSpace, "hook_Test", &b, &TestQObject::bigger10));
+    EXPECT_TRUE(dpfHookSequence->run(kTestHook, 12, &called));
+    EXPECT_EQ(called, 10);
+    EXPECT_FALSE(dpfHookSequence->run(kTestHook, 5, &called));
+    EXPECT_TRUE(dpfHookSequence->unfollow(kSpace, "hook_Test", &b, &TestQObject::bigger15));
+    EXPECT_TRUE(dpfHookSequence->unfollow(kSpace, "hook_Test", &b, &TestQObject::bigger10));
+}
+
+// compare the string api with the typed handle, the result is printed and not checked
+TEST_F(UT_EventHandle, benchmark_push)
+{
+    static constexpr int kTimes { 100000 };
+    TestQObject b;
+    EXPECT_TRUE(dpfSlotChannel->connect(kSpace, "slot_Test", &b, &TestQObject::test1));
+
+    QElapsedTimer timer;
+    qint64 sum { 0 };
+    timer.start();
+    for (int i = 0; i < kTimes; ++i)
+        sum += dpfSlotChannel->push(kSpace, "slot_Test", i).toInt();
+    const qint64 stringCost { timer.nsecsElapsed() };
+
+    qint64 typedSum { 0 };
+    timer.restart();
+    for (int i = 0; i < kTimes; ++i)
+        typedSum += dpfSlotChannel->push(kTestSlot, i).toInt();
+    const qint64 typedCost { timer.nsecsElapsed() };
+
+    EXPECT_EQ(sum, typedSum);
+    qInfo() << "push" << kTimes << "times, string api:" << stringCost / kTimes << "ns/call,"
+            << "typed handle:" << typedCost / kTimes << "ns/call";
+
+    EXPECT_TRUE(dpfSlotChannel->disconnect(kSpace, "slot_Test"));
+}
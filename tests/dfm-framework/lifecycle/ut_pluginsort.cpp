@@ -78,3 +78,24 @@ TEST_F(UT_PluginSort, test_rhombus_complex)
     }
     EXPECT_TRUE(trueRet.contains(ret));
 }
+
+TEST_F(UT_PluginSort, test_depends_levels)
+{
+    auto dependOn = [](PluginMetaObjectPointer ptr, const QString &name) {
+        PluginDepend depend;
+        depend.pluginName = name;
+        ptr->d->depends.append(depend);
+    };
+    dependOn(B, "A");
+    dependOn(C, "A");
+    dependOn(D, "B");
+    dependOn(D, "C");
+    dependOn(E, "Unknown");
+
+    QQueue<PluginMetaObjectPointer> sorted { A, E, B, C, D };
+    const auto &levels = PluginManagerPrivate::dependsLevels(sorted);
+    ASSERT_EQ(levels.size(), 3);
+    EXPECT_EQ(levels.at(0), QList<PluginMetaObjectPointer>({ A, E }));
+    EXPECT_EQ(levels.at(1), QList<PluginMetaObjectPointer>({ B, C }));
+    EXPECT_EQ(levels.at(2), QList<PluginMetaObjectPointer>({ D }));
+}
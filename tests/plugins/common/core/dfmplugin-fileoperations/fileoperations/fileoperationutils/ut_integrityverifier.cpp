@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fileoperations/fileoperationutils/integrityverifier.h"
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+quint32 checksumOf(IntegrityVerifier::ChecksumType type, const QByteArray &data)
+{
+    return IntegrityVerifier::checksum(type, IntegrityVerifier::initialChecksum(type), data.constData(), data.size());
+}
+}   // namespace
+
+TEST(UT_IntegrityVerifier, testCrc32cKnownVectors)
+{
+    using Type = IntegrityVerifier::ChecksumType;
+    EXPECT_EQ(0u, checksumOf(Type::kCrc32c, QByteArray()));
+    EXPECT_EQ(0xE3069283u, checksumOf(Type::kCrc32c, "123456789"));
+
+    // the vectors of rfc 3720
+    EXPECT_EQ(0x8A9136AAu, checksumOf(Type::kCrc32c, QByteArray(32, '\x00')));
+    EXPECT_EQ(0x62A8AB43u, checksumOf(Type::kCrc32c, QByteArray(32, '\xff')));
+    QByteArray ascending;
+    for (int i = 0; i < 32; ++i)
+        ascending.append(static_cast<char>(i));
+    EXPECT_EQ(0x46DD794Eu, checksumOf(Type::kCrc32c, ascending));
+}
+
+TEST(UT_IntegrityVerifier, testAdler32KnownVectors)
+{
+    using Type = IntegrityVerifier::ChecksumType;
+    EXPECT_EQ(1u, checksumOf(Type::kAdler32, QByteArray()));
+    EXPECT_EQ(0x11E60398u, checksumOf(Type::kAdler32, "Wikipedia"));
+    EXPECT_EQ(0x091E01DEu, checksumOf(Type::kAdler32, "123456789"));
+}
+
+TEST(UT_IntegrityVerifier, testChecksumInBlocks)
+{
+    // the copy hashes block by block, the unaligned blocks take the byte by byte tail
+    QByteArray data;
+    for (int i = 0; i < 100003; ++i)
+        data.append(static_cast<char>(i * 31 + 7));
+
+    for (auto type : { IntegrityVerifier::ChecksumType::kAdler32, IntegrityVerifier::ChecksumType::kCrc32c }) {
+        quint32 sum = IntegrityVerifier::initialChecksum(type);
+        for (int pos = 0; pos < data.size(); pos += 4093)
+            sum = IntegrityVerifier::checksum(type, sum, data.constData() + pos, qMin(4093, data.size() - pos));
+        EXPECT_EQ(checksumOf(type, data), sum);
+    }
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fileoperations/fileoperationutils/uringcopyengine.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+class UT_UringCopyEngine : public testing::Test
+{
+public:
+    // more files than a wave holds, so the ring is used by several waves
+    QVector<UringCopyEngine::CopyTask> createTasks(int count)
+    {
+        QVector<UringCopyEngine::CopyTask> tasks;
+        for (int i = 0; i < count; ++i) {
+            const QString &fromPath = tempDir.filePath(QString("from-%1").arg(i));
+            QFile file(fromPath);
+            if (!file.open(QIODevice::WriteOnly))
+                return {};
+            file.write(QByteArray(i + 1, static_cast<char>('a' + i % 26)));
+            file.close();
+
+            UringCopyEngine::CopyTask task;
+            task.fromPath = fromPath.toStdString();
+            task.toPath = tempDir.filePath(QString("to-%1").arg(i)).toStdString();
+            task.size = static_cast<size_t>(i + 1);
+            tasks.append(task);
+        }
+        return tasks;
+    }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_UringCopyEngine, testCopyFiles)
+{
+    UringCopyEngine engine;
+    // io_uring is not built in or not allowed here
+    if (!engine.isValid())
+        return;
+
+    auto tasks = createTasks(100);
+    ASSERT_EQ(100, tasks.size());
+    qint64 copiedSize = 0;
+    engine.copy(tasks, [&copiedSize](qint64 size) { copiedSize += size; });
+    EXPECT_EQ(100 * 101 / 2, copiedSize);
+
+    for (int i = 0; i < tasks.size(); ++i) {
+        EXPECT_TRUE(tasks.at(i).finished);
+        QFile file(QString::fromStdString(tasks.at(i).toPath));
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+        EXPECT_EQ(QByteArray(i + 1, static_cast<char>('a' + i % 26)), file.readAll());
+    }
+
+    // a failed file is left to the caller, the ring keeps working for the next batch
+    auto again = createTasks(3);
+    again[1].fromPath = tempDir.filePath("missing").toStdString();
+    engine.copy(again, nullptr);
+    EXPECT_TRUE(again.at(0).finished);
+    EXPECT_FALSE(again.at(1).finished);
+    EXPECT_TRUE(again.at(2).finished);
+    EXPECT_TRUE(engine.isValid());
+}
+
+TEST_F(UT_UringCopyEngine, testStopBetweenWaves)
+{
+    UringCopyEngine engine;
+    if (!engine.isValid())
+        return;
+
+    auto tasks = createTasks(100);
+    ASSERT_EQ(100, tasks.size());
+    int waves = 0;
+    engine.copy(tasks, nullptr, [&waves]() { return waves++ == 0; });
+
+    // only the first wave is copied
+    EXPECT_TRUE(tasks.first().finished);
+    EXPECT_FALSE(tasks.last().finished);
+    EXPECT_FALSE(QFile::exists(QString::fromStdString(tasks.last().toPath)));
+}
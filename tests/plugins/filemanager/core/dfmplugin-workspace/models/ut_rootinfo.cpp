@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "models/rootinfo.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DPWORKSPACE_USE_NAMESPACE
+
+namespace {
+const QUrl kDirUrl = QUrl::fromLocalFile("/tmp/dir");
+
+QUrl childUrl(const QString &name)
+{
+    return QUrl::fromLocalFile("/tmp/dir/" + name);
+}
+}   // namespace
+
+class UT_RootInfo : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&RootInfo::startWatcher, []() {});
+        stub.set_lamda(static_cast<void (RootInfo::*)(const QList<QUrl> &)>(&RootInfo::addChildren),
+                       [this](RootInfo *, const QList<QUrl> &urls) { added.append(urls); });
+        stub.set_lamda(&RootInfo::updateChildren,
+                       [this](RootInfo *, const QList<QUrl> &urls) { updated.append(urls); });
+        stub.set_lamda(&RootInfo::removeChildren,
+                       [this](RootInfo *, const QList<QUrl> &urls) { removed.append(urls); });
+    }
+    void TearDown() override { stub.clear(); }
+
+    QList<QUrl> added;
+    QList<QUrl> updated;
+    QList<QUrl> removed;
+
+private:
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_RootInfo, testReplacedChildIsUpdated)
+{
+    RootInfo root(kDirUrl, false);
+    root.childrenTable.insert(SortInfoPointer(new AbstractDirIterator::SortFileInfo(
+            childUrl("a.txt"), true, false, false, false, true, true, false)));
+
+    // saved by unlink and create, the row is refreshed in place
+    root.doFileDeleted(childUrl("a.txt"));
+    root.dofileCreated(childUrl("a.txt"));
+    root.doWatcherEvent();
+
+    EXPECT_TRUE(added.isEmpty());
+    EXPECT_TRUE(removed.isEmpty());
+    ASSERT_EQ(1, updated.count());
+    EXPECT_EQ(childUrl("a.txt"), updated.first());
+}
+
+TEST_F(UT_RootInfo, testTempFileIsDropped)
+{
+    RootInfo root(kDirUrl, false);
+
+    // created and deleted in the window, never seen by the model
+    root.dofileCreated(childUrl("a.tmp"));
+    root.doFileDeleted(childUrl("a.tmp"));
+    root.dofileCreated(childUrl("b.txt"));
+    root.doWatcherEvent();
+
+    EXPECT_TRUE(updated.isEmpty());
+    EXPECT_TRUE(removed.isEmpty());
+    ASSERT_EQ(1, added.count());
+    EXPECT_EQ(childUrl("b.txt"), added.first());
+}
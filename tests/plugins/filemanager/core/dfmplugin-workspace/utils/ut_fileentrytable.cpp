@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "utils/fileentrytable.h"
+
+#include <gtest/gtest.h>
+
+using namespace dfmbase;
+using namespace dfmplugin_workspace;
+
+static SortInfoPointer sortInfo(const QUrl &url, bool isDir, bool isHide = false)
+{
+    return SortInfoPointer(new AbstractDirIterator::SortFileInfo(url, !isDir, isDir, false, isHide, true, true, false));
+}
+
+TEST(UT_FileEntryTable, testInsertKeepsOrderAndFlags)
+{
+    FileEntryTable table(QUrl::fromLocalFile("/tmp/dir"));
+    table.insert(sortInfo(QUrl::fromLocalFile("/tmp/dir/b"), false));
+    table.insert(sortInfo(QUrl::fromLocalFile("/tmp/dir/a"), true, true));
+    EXPECT_EQ(2, table.count());
+
+    const auto &infos = table.sortInfos();
+    ASSERT_EQ(2, infos.count());
+    EXPECT_EQ(QUrl::fromLocalFile("/tmp/dir/b"), infos.at(0)->url);
+    EXPECT_TRUE(infos.at(0)->isFile);
+    EXPECT_EQ(QUrl::fromLocalFile("/tmp/dir/a"), infos.at(1)->url);
+    EXPECT_TRUE(infos.at(1)->isDir);
+    EXPECT_TRUE(infos.at(1)->isHide);
+    EXPECT_TRUE(infos.at(1)->isReadable);
+    EXPECT_FALSE(infos.at(1)->isExecutable);
+}
+
+TEST(UT_FileEntryTable, testInsertReplacesSameUrl)
+{
+    FileEntryTable table(QUrl::fromLocalFile("/tmp/dir"));
+    const QUrl url = QUrl::fromLocalFile("/tmp/dir/a b#c");
+    table.insert(sortInfo(url, false));
+    table.insert(sortInfo(url, false, true));
+    EXPECT_EQ(1, table.count());
+    EXPECT_TRUE(table.contains(url));
+    EXPECT_TRUE(table.sortInfos().first()->isHide);
+}
+
+TEST(UT_FileEntryTable, testUrlOutOfDirectory)
+{
+    FileEntryTable table(QUrl::fromLocalFile("/tmp/dir"));
+    const QUrl url("mtp://device/storage/a");
+    table.insert(sortInfo(url, false));
+    EXPECT_TRUE(table.contains(url));
+    EXPECT_EQ(url, table.sortInfos().first()->url);
+}
+
+TEST(UT_FileEntryTable, testTakeAndCompact)
+{
+    FileEntryTable table(QUrl::fromLocalFile("/tmp/dir"));
+    const int total = 3000;
+    for (int i = 0; i < total; ++i)
+        table.insert(sortInfo(QUrl::fromLocalFile(QString("/tmp/dir/%1").arg(i)), false));
+
+    EXPECT_TRUE(table.take(QUrl::fromLocalFile("/tmp/dir/none")).isNull());
+    // removing more than half compacts the table
+    for (int i = 0; i < total; i += 3) {
+        table.take(QUrl::fromLocalFile(QString("/tmp/dir/%1").arg(i)));
+        table.take(QUrl::fromLocalFile(QString("/tmp/dir/%1").arg(i + 1)));
+    }
+
+    EXPECT_EQ(total / 3, table.count());
+    EXPECT_FALSE(table.contains(QUrl::fromLocalFile("/tmp/dir/0")));
+    EXPECT_TRUE(table.contains(QUrl::fromLocalFile("/tmp/dir/2")));
+    const auto &infos = table.sortInfos();
+    ASSERT_EQ(total / 3, infos.count());
+    EXPECT_EQ(QUrl::fromLocalFile("/tmp/dir/2"), infos.first()->url);
+    EXPECT_EQ(QUrl::fromLocalFile("/tmp/dir/2999"), infos.last()->url);
+
+    table.clear();
+    EXPECT_EQ(0, table.count());
+}
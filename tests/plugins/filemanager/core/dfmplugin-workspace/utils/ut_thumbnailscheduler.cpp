@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "utils/thumbnailscheduler.h"
+#include "views/fileview.h"
+#include "dfm-base/base/application/application.h"
+#include "dfm-base/utils/fileinfohelper.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DPWORKSPACE_USE_NAMESPACE
+
+namespace {
+QUrl rowUrl(int row)
+{
+    return QUrl::fromLocalFile(QString("/tmp/dir/%1.png").arg(row));
+}
+
+class TestScheduler : public ThumbnailScheduler
+{
+public:
+    using ThumbnailScheduler::ThumbnailScheduler;
+
+protected:
+    int rowCount() const override { return 100; }
+    QUrl urlOfRow(int row) const override { return rowUrl(row); }
+    QUrl prefetchUrlOfRow(int row) const override { return rowUrl(row); }
+};
+}   // namespace
+
+class UT_ThumbnailScheduler : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&Application::appAttribute, [](Application::ApplicationAttribute) -> QVariant {
+            return QVariant();
+        });
+        stub.set_lamda(&FileView::initializeModel, []() {});
+        stub.set_lamda(&FileView::updateModelActiveIndex, []() {});
+        stub.set_lamda(&FileView::rootUrl, []() { return QUrl::fromLocalFile("/tmp/dir"); });
+
+        stub.set_lamda(&FileInfoHelper::fileThumbAsync, [this](void *, const QUrl &url, ThumbnailProvider::Size) {
+            requested.append(url);
+            return QSharedPointer<FileInfoHelperUeserData>();
+        });
+        stub.set_lamda(&FileInfoHelper::holdThumbAsync, [this](void *, const QUrl &url) {
+            if (unrequested.contains(url))
+                return false;
+            ++holders[url];
+            return true;
+        });
+        stub.set_lamda(&FileInfoHelper::cancelThumbAsync, [this](void *, const QUrl &url) {
+            return --holders[url] == 0;
+        });
+        stub.set_lamda(&FileInfoHelper::raiseThumbAsync, [this](void *, const QList<QUrl> &urls) {
+            raised = urls;
+        });
+    }
+    void TearDown() override { stub.clear(); }
+
+    QList<QUrl> requested;
+    QList<QUrl> raised;
+    QHash<QUrl, int> holders;
+    QSet<QUrl> unrequested;
+
+private:
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_ThumbnailScheduler, testPrefetchNextViewport)
+{
+    FileView view(QUrl("~"));
+    TestScheduler scheduler(&view);
+    scheduler.updateVisibleRange(0, 9);
+
+    // only the prefetched rows are requested, the visible ones are requested by painting
+    ASSERT_EQ(10, requested.count());
+    EXPECT_EQ(rowUrl(19), requested.first());
+    EXPECT_EQ(rowUrl(10), requested.last());
+
+    // the visible top row is raised last, so it runs first
+    ASSERT_EQ(20, raised.count());
+    EXPECT_EQ(rowUrl(19), raised.first());
+    EXPECT_EQ(rowUrl(9), raised.at(10));
+    EXPECT_EQ(rowUrl(0), raised.last());
+    EXPECT_EQ(1, holders.value(rowUrl(15)));
+
+    // scrolled up, the viewport above is prefetched, the farthest first
+    scheduler.updateVisibleRange(60, 69);
+    requested.clear();
+    scheduler.updateVisibleRange(50, 59);
+    ASSERT_EQ(10, requested.count());
+    EXPECT_EQ(rowUrl(40), requested.first());
+    EXPECT_EQ(rowUrl(49), requested.last());
+}
+
+TEST_F(UT_ThumbnailScheduler, testCancelFarRows)
+{
+    FileView view(QUrl("~"));
+    TestScheduler scheduler(&view);
+    scheduler.updateVisibleRange(0, 9);
+    scheduler.updateVisibleRange(40, 49);
+
+    // the rows more than a viewport away are let go
+    EXPECT_EQ(20, scheduler.metrics().canceled);
+    EXPECT_EQ(0, holders.value(rowUrl(0)));
+    EXPECT_EQ(1, holders.value(rowUrl(45)));
+
+    // another view holds the same request, it is not dropped by this view
+    ++holders[rowUrl(55)];
+    scheduler.updateVisibleRange(90, 99);
+    EXPECT_EQ(1, holders.value(rowUrl(55)));
+    EXPECT_EQ(39, scheduler.metrics().canceled);
+}
+
+TEST_F(UT_ThumbnailScheduler, testCancelPaintedRows)
+{
+    FileView view(QUrl("~"));
+    TestScheduler scheduler(&view);
+    scheduler.updateVisibleRange(0, 9);
+
+    // flung down, the rows scrolled through were painted and requested by the items
+    unrequested.insert(rowUrl(25));
+    scheduler.leaveRows(0, 59);
+    EXPECT_EQ(1, holders.value(rowUrl(30)));
+    EXPECT_EQ(0, holders.value(rowUrl(25)));
+    EXPECT_EQ(1, holders.value(rowUrl(5)));
+
+    // the far ones are dropped, the previous viewport is kept
+    scheduler.updateVisibleRange(60, 69);
+    EXPECT_EQ(0, holders.value(rowUrl(30)));
+    EXPECT_EQ(0, holders.value(rowUrl(5)));
+    EXPECT_EQ(1, holders.value(rowUrl(55)));
+    EXPECT_EQ(49, scheduler.metrics().canceled);
+}
+
+TEST_F(UT_ThumbnailScheduler, testMetrics)
+{
+    FileView view(QUrl("~"));
+    TestScheduler scheduler(&view);
+    scheduler.updateVisibleRange(0, 9);
+
+    emit FileInfoHelper::instance().createThumbnailFinished(rowUrl(5), QString());
+    emit FileInfoHelper::instance().createThumbnailFinished(rowUrl(15), QString());
+    emit FileInfoHelper::instance().createThumbnailFinished(rowUrl(16), QString());
+    emit FileInfoHelper::instance().createThumbnailFailed(rowUrl(17));
+    EXPECT_EQ(1, scheduler.metrics().shown);
+
+    // finished out of the view, shown when scrolled into it
+    scheduler.updateVisibleRange(10, 15);
+    EXPECT_EQ(2, scheduler.metrics().shown);
+
+    // finished and scrolled far away without being shown
+    scheduler.updateVisibleRange(60, 69);
+    EXPECT_EQ(2, scheduler.metrics().shown);
+    EXPECT_EQ(1, scheduler.metrics().wasted);
+
+    scheduler.reset();
+    EXPECT_EQ(0, scheduler.metrics().shown);
+    EXPECT_EQ(0, scheduler.metrics().wasted);
+    EXPECT_EQ(0, scheduler.metrics().canceled);
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/iterator/iteratorsearcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DPSEARCH_USE_NAMESPACE
+
+class UT_IteratorSearcher : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        // root/a/b/c, every directory has match.txt, other.txt and .match.txt
+        QString path = tempDir.path();
+        for (const QString &name : { "a", "b", "c" }) {
+            path += "/" + name;
+            QDir().mkpath(path);
+            for (const QString &file : { "match.txt", "other.txt", ".match.txt" }) {
+                QFile f(path + "/" + file);
+                f.open(QIODevice::WriteOnly);
+            }
+        }
+    }
+
+    QUrl rootUrl() const { return QUrl::fromLocalFile(tempDir.path()); }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_IteratorSearcher, testLocalSearch)
+{
+    IteratorSearcher searcher(rootUrl(), "match");
+    EXPECT_TRUE(searcher.search());
+
+    const QList<QUrl> &results = searcher.takeAll();
+    EXPECT_EQ(3, results.count());
+    for (const QUrl &url : results)
+        EXPECT_EQ("match.txt", url.fileName());
+}
+
+TEST_F(UT_IteratorSearcher, testMatchDirectory)
+{
+    IteratorSearcher searcher(rootUrl(), "b");
+    searcher.search();
+
+    const QList<QUrl> &results = searcher.takeAll();
+    ASSERT_EQ(1, results.count());
+    EXPECT_EQ(QUrl::fromLocalFile(tempDir.path() + "/a/b"), results.first());
+}
+
+TEST_F(UT_IteratorSearcher, testSymlinkLoop)
+{
+    ASSERT_TRUE(QFile::link(tempDir.path(), tempDir.path() + "/a/b/loop"));
+
+    IteratorSearcher searcher(rootUrl(), "match");
+    searcher.search();
+    EXPECT_EQ(3, searcher.takeAll().count());
+}
+
+TEST_F(UT_IteratorSearcher, testStop)
+{
+    IteratorSearcher searcher(rootUrl(), "match");
+    searcher.stop();
+    EXPECT_FALSE(searcher.search());
+    EXPECT_FALSE(searcher.hasItem());
+}